@@ -21,6 +21,68 @@
 #include "EventProcessor.h"
 #include "Log.h" // Zerix: For MANGOS_ASSERT. No idea.
 
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Freed event storage by size, 16 bytes apart. Every thread has its own pool and takes
+    // the events it deletes, whichever thread allocated them, so nothing is shared. The pool
+    // is never destroyed, events can still be deleted while the thread ends.
+    size_t const EVENT_POOL_GRANULARITY = 16;
+    size_t const EVENT_POOL_CLASSES = 16;                   // bigger events use the global heap
+    uint32 const EVENT_POOL_MAX_FREE = 256;                 // per size
+
+    struct FreeEvent
+    {
+        FreeEvent* next;
+    };
+
+    struct EventPool
+    {
+        FreeEvent* free[EVENT_POOL_CLASSES];
+        uint32 count[EVENT_POOL_CLASSES];
+    };
+
+    thread_local EventPool t_eventPool = {};
+}
+
+void* BasicEvent::operator new(size_t size)
+{
+    size_t sizeClass = (size + EVENT_POOL_GRANULARITY - 1) / EVENT_POOL_GRANULARITY - 1;
+    if (sizeClass >= EVENT_POOL_CLASSES)
+        return ::operator new(size);
+
+    EventPool& pool = t_eventPool;
+    if (FreeEvent* block = pool.free[sizeClass])
+    {
+        pool.free[sizeClass] = block->next;
+        --pool.count[sizeClass];
+        return block;
+    }
+
+    return ::operator new((sizeClass + 1) * EVENT_POOL_GRANULARITY);
+}
+
+void BasicEvent::operator delete(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    size_t sizeClass = (size + EVENT_POOL_GRANULARITY - 1) / EVENT_POOL_GRANULARITY - 1;
+    EventPool& pool = t_eventPool;
+    if (sizeClass >= EVENT_POOL_CLASSES || pool.count[sizeClass] >= EVENT_POOL_MAX_FREE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeEvent* block = static_cast<FreeEvent*>(ptr);
+    block->next = pool.free[sizeClass];
+    pool.free[sizeClass] = block;
+    ++pool.count[sizeClass];
+}
+
 void BasicEvent::ScheduleAbort()
 {
     MANGOS_ASSERT(IsRunning()
@@ -35,6 +97,12 @@ void BasicEvent::SetAborted()
     m_abortState = AbortState::STATE_ABORTED;
 }
 
+EventProcessor::EventProcessor() : m_time(0), m_sequence(0), m_current(0), m_wheelCount(0)
+{
+    memset(m_wheel, 0, sizeof(m_wheel));
+    memset(m_usedSlots, 0, sizeof(m_usedSlots));
+}
+
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
@@ -44,14 +112,15 @@ void EventProcessor::Update(uint32 p_time)
 {
     // update time
     m_time += p_time;
+    Advance(m_time);
 
-    // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    // main event loop, including the due events added meanwhile
+    while (!m_ready.empty())
     {
         // get and remove event from queue
-        BasicEvent* event = i->second;
-        m_events.erase(i);
+        std::pop_heap(m_ready.begin(), m_ready.end(), IsAfter);
+        BasicEvent* event = m_ready.back();
+        m_ready.pop_back();
 
         if (event->IsRunning())
         {
@@ -84,33 +153,34 @@ void EventProcessor::Update(uint32 p_time)
 
 void EventProcessor::KillAllEvents(bool force)
 {
-    for (auto itr = m_events.begin(); itr != m_events.end();)
+    // taken out first, aborting an event can add others which are killed as well
+    std::vector<BasicEvent*> events;
+    std::vector<BasicEvent*> kept;
+    for (TakeEvents(events); !events.empty(); TakeEvents(events))
     {
-        // Abort events which weren't aborted already
-        if (!itr->second->IsAborted())
+        for (BasicEvent* event : events)
         {
-            itr->second->SetAborted();
-            itr->second->Abort(m_time);
-        }
-
-        // Skip non-deletable events when we are
-        // not forcing the event cancellation.
-        if (!force && !itr->second->IsDeletable())
-        {
-            ++itr;
-            continue;
-        }
+            // Abort events which weren't aborted already
+            if (!event->IsAborted())
+            {
+                event->SetAborted();
+                event->Abort(m_time);
+            }
 
-        delete itr->second;
+            // Skip non-deletable events when we are
+            // not forcing the event cancellation.
+            if (!force && !event->IsDeletable())
+            {
+                kept.push_back(event);
+                continue;
+            }
 
-        if (force)
-            ++itr; // Clear the whole container when forcing
-        else
-            itr = m_events.erase(itr);
+            delete event;
+        }
     }
 
-    if (force)
-        m_events.clear();
+    for (BasicEvent* event : kept)
+        Schedule(event);
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -118,10 +188,127 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
     if (set_addtime)
         Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_sequence = m_sequence++;
+    Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
 {
     return (m_time + t_offset);
-}
\ No newline at end of file
+}
+
+void EventProcessor::GetEvents(std::vector<BasicEvent*>& events) const
+{
+    events.assign(m_ready.begin(), m_ready.end());
+    for (auto const& level : m_wheel)
+        for (BasicEvent* event : level)
+            for (; event; event = event->m_next)
+                events.push_back(event);
+}
+
+void EventProcessor::Schedule(BasicEvent* event)
+{
+    // m_current is at most one past m_time, so the event is due
+    if (event->m_execTime < m_current)
+        PushReady(event);
+    else
+        Insert(event);
+}
+
+void EventProcessor::Insert(BasicEvent* event)
+{
+    uint64 const wheelSpan = uint64(1) << (WHEEL_BITS * WHEEL_LEVELS);
+
+    uint64 when = std::max(event->m_execTime, m_current);
+    uint64 delta = when - m_current;
+
+    uint32 level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (uint64(1) << (WHEEL_BITS * (level + 1))))
+        ++level;
+
+    if (delta >= wheelSpan)
+        when = m_current + wheelSpan - 1;
+
+    uint32 index = (when >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+    event->m_next = m_wheel[level][index];
+    m_wheel[level][index] = event;
+    m_usedSlots[level] |= 1 << index;
+    ++m_wheelCount;
+}
+
+void EventProcessor::Cascade(uint32 level)
+{
+    uint32 index = (m_current >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+    BasicEvent* event = m_wheel[level][index];
+    m_wheel[level][index] = nullptr;
+    m_usedSlots[level] &= ~(1 << index);
+
+    while (event)
+    {
+        BasicEvent* next = event->m_next;
+        --m_wheelCount;
+        Insert(event);
+        event = next;
+    }
+}
+
+void EventProcessor::Advance(uint64 time)
+{
+    while (m_wheelCount && m_current <= time)
+    {
+        // when a level wraps, the next slot of the level above is spread over the levels below
+        for (uint32 level = 1; level < WHEEL_LEVELS; ++level)
+        {
+            if ((m_current >> (WHEEL_BITS * (level - 1))) & (WHEEL_SLOTS - 1))
+                break;
+            Cascade(level);
+        }
+
+        uint32 index = m_current & (WHEEL_SLOTS - 1);
+        for (BasicEvent* event = m_wheel[0][index]; event;)
+        {
+            BasicEvent* next = event->m_next;
+            --m_wheelCount;
+            PushReady(event);
+            event = next;
+        }
+        m_wheel[0][index] = nullptr;
+        m_usedSlots[0] &= ~(1 << index);
+
+        // skip the empty slots up to the next used one, or to the start of the next round
+        uint32 later = m_usedSlots[0] >> index >> 1;
+        uint64 next = (m_current | (WHEEL_SLOTS - 1)) + 1;
+        if (later)
+        {
+            uint32 skip = 1;
+            while (!(later & 1))
+            {
+                later >>= 1;
+                ++skip;
+            }
+            next = m_current + skip;
+        }
+
+        m_current = std::min(next, time + 1);
+    }
+
+    // nothing left to expire in between
+    if (m_current <= time)
+        m_current = time + 1;
+}
+
+void EventProcessor::PushReady(BasicEvent* event)
+{
+    m_ready.push_back(event);
+    std::push_heap(m_ready.begin(), m_ready.end(), IsAfter);
+}
+
+void EventProcessor::TakeEvents(std::vector<BasicEvent*>& events)
+{
+    GetEvents(events);
+
+    m_ready.clear();
+    memset(m_wheel, 0, sizeof(m_wheel));
+    memset(m_usedSlots, 0, sizeof(m_usedSlots));
+    m_wheelCount = 0;
+}
@@ -22,7 +22,7 @@
 #define __EVENTPROCESSOR_H
 
 #include "Platform/Define.h"
-#include <map>
+#include <vector>
 
 class EventProcessor;
 
@@ -41,7 +41,7 @@ class BasicEvent
 
     public:
         BasicEvent()
-          : m_abortState(AbortState::STATE_RUNNING), m_addTime(0), m_execTime(0) { }
+          : m_abortState(AbortState::STATE_RUNNING), m_addTime(0), m_execTime(0), m_sequence(0), m_next(nullptr) { }
 
         virtual ~BasicEvent() { }                           // override destructor to perform some actions on event removal
 
@@ -57,6 +57,10 @@ class BasicEvent
         // Aborts the event at the next update tick
         void ScheduleAbort();
 
+        // events are short lived and many, they are recycled through a per thread pool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
     private:
         void SetAborted();
         bool IsRunning() const { return (m_abortState == AbortState::STATE_RUNNING); }
@@ -68,6 +72,9 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+        uint64 m_sequence;                                  // events due at the same time execute in the order they were added
+        BasicEvent* m_next;                                 // next event of the same wheel slot
 };
 
 template<typename T>
@@ -87,14 +94,18 @@ private:
     T _callback;
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
-
+// Events wait in a hierarchical timing wheel with millisecond slots, so adding one and
+// taking the due ones don't depend on how many are queued. Events further than the wheel
+// goes wait in its last slot and are put back in it when that slot is reached.
 class EventProcessor
 {
     public:
-        EventProcessor() : m_time(0) { }
+        EventProcessor();
         ~EventProcessor();
 
+        EventProcessor(EventProcessor const&) = delete;
+        EventProcessor& operator=(EventProcessor const&) = delete;
+
         void Update(uint32 p_time);
         void KillAllEvents(bool force);
         uint64 CalculateTime(uint64 t_offset) const;
@@ -108,12 +119,36 @@ class EventProcessor
         void AddLambdaEventAtOffset(T&& event, uint32 offset) { AddEventAtOffset(new LambdaBasicEvent<T>(std::move(event)), offset); }
 
         // Zerix: Nostalrius compatibility. Figure a better way to handle this.
-        bool HasScheduledEvent() const { return m_events.empty() ? false : true; }
-        EventList const& GetEvents() const { return m_events; }
+        bool HasScheduledEvent() const { return m_wheelCount || !m_ready.empty(); }
+        // copies the queued events, which can be added or removed while going through them
+        void GetEvents(std::vector<BasicEvent*>& events) const;
 
     protected:
+        static uint32 const WHEEL_BITS = 4;
+        static uint32 const WHEEL_SLOTS = 1 << WHEEL_BITS;
+        static uint32 const WHEEL_LEVELS = 4;
+
+        static bool IsAfter(BasicEvent const* a, BasicEvent const* b)
+        {
+            return a->m_execTime != b->m_execTime ? a->m_execTime > b->m_execTime : a->m_sequence > b->m_sequence;
+        }
+
+        void Schedule(BasicEvent* event);
+        void Insert(BasicEvent* event);
+        void Cascade(uint32 level);
+        void Advance(uint64 time);
+        void PushReady(BasicEvent* event);
+        // removes every queued event from the processor
+        void TakeEvents(std::vector<BasicEvent*>& events);
+
         uint64 m_time;
-        EventList m_events;
+        uint64 m_sequence;
+
+        BasicEvent* m_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+        uint16 m_usedSlots[WHEEL_LEVELS];                   // one bit per non empty slot
+        uint64 m_current;                                   // next millisecond to expire, the earlier events are in m_ready
+        uint32 m_wheelCount;
+        std::vector<BasicEvent*> m_ready;                   // heap of the due events
 };
 
 #endif
\ No newline at end of file
@@ -37,22 +37,146 @@
 #include "CreatureAI.h"
 #include "GuardMgr.h"
 
-bool CreatureEventAIHolder::UpdateRepeatTimer(Creature* creature, uint32 repeatMin, uint32 repeatMax)
+bool CreatureEventAI::UpdateRepeatTimer(CreatureEventAIHolder& holder, uint32 repeatMin, uint32 repeatMax)
 {
     if (repeatMin == repeatMax)
-        Time = repeatMin;
+        SetEventTimer(holder, repeatMin);
     else if (repeatMax > repeatMin)
-        Time = urand(repeatMin, repeatMax);
+        SetEventTimer(holder, urand(repeatMin, repeatMax));
     else
     {
-        sLog.outErrorDb("CreatureEventAI: Creature %u using Event %u (Type = %u) has RandomMax < RandomMin. Event repeating disabled.", creature->GetEntry(), Event.event_id, Event.event_type);
-        Enabled = false;
+        sLog.outErrorDb("CreatureEventAI: Creature %u using Event %u (Type = %u) has RandomMax < RandomMin. Event repeating disabled.", m_creature->GetEntry(), holder.Event.event_id, holder.Event.event_type);
+        holder.Enabled = false;
         return false;
     }
 
     return true;
 }
 
+void CreatureEventAI::SetEventTimer(CreatureEventAIHolder& holder, uint32 time)
+{
+    holder.Time = time;
+    ++holder.TimerId;
+    if (!time)
+        return;
+
+    uint32 index = &holder - &m_CreatureEventAIList[0];
+
+    //Timers do not run in the phases the event cannot trigger in
+    if (holder.Event.event_inverse_phase_mask & (1 << m_Phase))
+    {
+        holder.TimerEnd = 0;
+        if (!holder.Paused)
+        {
+            holder.Paused = true;
+            m_PausedTimers.push_back(index);
+        }
+        return;
+    }
+
+    holder.TimerEnd = m_EventClock + time;
+
+    // the entries of restarted timers stay until they end, drop them once they pile up
+    if (m_EventTimers.size() >= 2 * m_CreatureEventAIList.size() + 8)
+        RebuildEventTimers();
+    else
+    {
+        m_EventTimers.push_back({ holder.TimerEnd, index, holder.TimerId });
+        std::push_heap(m_EventTimers.begin(), m_EventTimers.end(), IsLaterTimer);
+    }
+}
+
+void CreatureEventAI::RebuildEventTimers()
+{
+    m_EventTimers.clear();
+    for (uint32 index = 0; index < m_CreatureEventAIList.size(); ++index)
+    {
+        CreatureEventAIHolder const& holder = m_CreatureEventAIList[index];
+        if (holder.Time && holder.TimerEnd)
+            m_EventTimers.push_back({ holder.TimerEnd, index, holder.TimerId });
+    }
+    std::make_heap(m_EventTimers.begin(), m_EventTimers.end(), IsLaterTimer);
+}
+
+void CreatureEventAI::UpdateEventTimers(uint32 diff)
+{
+    m_EventClock += diff;
+
+    // paused timers still end once less than an update is left
+    uint32 kept = 0;
+    for (uint32 index : m_PausedTimers)
+    {
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[index];
+        if (!holder.Time || holder.TimerEnd)
+            holder.Paused = false;                          // restarted or running again
+        else if (holder.Time <= diff)
+        {
+            holder.Time = 0;
+            holder.Paused = false;
+        }
+        else
+            m_PausedTimers[kept++] = index;
+    }
+    m_PausedTimers.resize(kept);
+
+    while (!m_EventTimers.empty() && m_EventTimers.front().end <= m_EventClock)
+    {
+        EventTimer timer = m_EventTimers.front();
+        std::pop_heap(m_EventTimers.begin(), m_EventTimers.end(), IsLaterTimer);
+        m_EventTimers.pop_back();
+
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[timer.holder];
+        if (holder.TimerId == timer.id && holder.Time && holder.TimerEnd)
+            holder.Time = 0;
+    }
+}
+
+void CreatureEventAI::SetPhase(uint8 phase)
+{
+    if (phase == m_Phase)
+        return;
+
+    m_Phase = phase;
+
+    // pause or resume the timers whose event the new phase masks or unmasks
+    for (auto& holder : m_CreatureEventAIList)
+    {
+        if (!holder.Time)
+            continue;
+
+        bool paused = holder.Event.event_inverse_phase_mask & (1 << m_Phase);
+        if (paused == !holder.TimerEnd)
+            continue;
+
+        SetEventTimer(holder, paused ? uint32(holder.TimerEnd - m_EventClock) : holder.Time);
+    }
+}
+
+bool CreatureEventAI::IsUpdatedEvent(EventAI_Type type)
+{
+    switch (type)
+    {
+        case EVENT_T_TIMER_OOC:
+        case EVENT_T_FRIENDLY_MISSING_BUFF:
+        case EVENT_T_TIMER_IN_COMBAT:
+        case EVENT_T_MANA:
+        case EVENT_T_HP:
+        case EVENT_T_TARGET_HP:
+        case EVENT_T_TARGET_CASTING:
+        case EVENT_T_FRIENDLY_HP:
+        case EVENT_T_FRIENDLY_IS_CC:
+        case EVENT_T_AURA:
+        case EVENT_T_TARGET_AURA:
+        case EVENT_T_MISSING_AURA:
+        case EVENT_T_TARGET_MISSING_AURA:
+        case EVENT_T_VICTIM_ROOTED:
+        case EVENT_T_RANGE:
+            return true;
+        default:
+            return false;
+    }
+}
+
 int CreatureEventAI::Permissible(const Creature *creature)
 {
     if (creature->GetAIName() == "EventAI")
@@ -65,28 +189,19 @@ void CreatureEventAI::GetAIInformation(ChatHandler& reader)
     reader.PSendSysMessage(LANG_NPC_EVENTAI_PHASE, (uint32)m_Phase);
 }
 
-CreatureEventAI::CreatureEventAI(Creature *c) : CreatureAI(c)
+CreatureEventAI::CreatureEventAI(Creature *c) : CreatureAI(c), m_EventClock(0)
 {
-    // Need make copy for filter unneeded steps and safe in case table reload
+    // Keep a reference on the events, safe in case table reload
     CreatureEventAI_Event_Map::const_iterator creatureEventsItr = sEventAIMgr.GetCreatureEventAIMap().find(m_creature->GetEntry());
     if (creatureEventsItr != sEventAIMgr.GetCreatureEventAIMap().end())
     {
-        CreatureEventAI_Event_Vec const& creatureEvent = creatureEventsItr->second;
-        m_CreatureEventAIList.reserve(creatureEvent.size());
-        for (const auto& i : creatureEvent)
-        {
-
-            //Debug check
-#ifndef _DEBUG
-            if (i.event_flags & EFLAG_DEBUG_ONLY)
-                continue;
-#endif
-
-            if (i.event_type == EVENT_T_OOC_LOS)
-                c->EnableMoveInLosEvent();
+        m_EntryEvents = creatureEventsItr->second;
+        m_CreatureEventAIList.reserve(m_EntryEvents->events.size());
+        for (const auto& i : m_EntryEvents->events)
+            m_CreatureEventAIList.emplace_back(i);
 
-            m_CreatureEventAIList.push_back(CreatureEventAIHolder(i));
-        }
+        if (!GetEventsOfType(EVENT_T_OOC_LOS).empty())
+            c->EnableMoveInLosEvent();
     }
 
     m_bEmptyList = m_CreatureEventAIList.empty();
@@ -99,9 +214,8 @@ CreatureEventAI::CreatureEventAI(Creature *c) : CreatureAI(c)
     c->SetAI(this);
     if (!m_bEmptyList)
     {
-        for (auto& i : m_CreatureEventAIList)
-            if (i.Event.event_type == EVENT_T_SPAWNED)
-                ProcessEvent(i);
+        for (uint32 index : GetEventsOfType(EVENT_T_SPAWNED))
+            ProcessEvent(m_CreatureEventAIList[index]);
     }
     Reset();
 }
@@ -132,7 +246,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.timer.repeatMin, event.timer.repeatMax);
+            UpdateRepeatTimer(pHolder, event.timer.repeatMin, event.timer.repeatMax);
             break;
         }
         case EVENT_T_TIMER_OOC:
@@ -141,7 +255,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.timer.repeatMin, event.timer.repeatMax);
+            UpdateRepeatTimer(pHolder, event.timer.repeatMin, event.timer.repeatMax);
             break;
         }
         case EVENT_T_HP:
@@ -155,7 +269,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.percent_range.repeatMin, event.percent_range.repeatMax);
+            UpdateRepeatTimer(pHolder, event.percent_range.repeatMin, event.percent_range.repeatMax);
             break;
         }
         case EVENT_T_MANA:
@@ -169,7 +283,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.percent_range.repeatMin, event.percent_range.repeatMax);
+            UpdateRepeatTimer(pHolder, event.percent_range.repeatMin, event.percent_range.repeatMax);
             break;
         }
         case EVENT_T_AGGRO:
@@ -182,7 +296,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.kill.repeatMin, event.kill.repeatMax);
+            UpdateRepeatTimer(pHolder, event.kill.repeatMin, event.kill.repeatMax);
             break;
         }
         case EVENT_T_DEATH:
@@ -196,19 +310,19 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
             //Spell hit is special case, param1 and param2 handled within CreatureEventAI::SpellHit
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.hit_by_spell.repeatMin, event.hit_by_spell.repeatMax);
+            UpdateRepeatTimer(pHolder, event.hit_by_spell.repeatMin, event.hit_by_spell.repeatMax);
             break;
         }
         case EVENT_T_RANGE:
         {
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.range.repeatMin, event.range.repeatMax);
+            UpdateRepeatTimer(pHolder, event.range.repeatMin, event.range.repeatMax);
             break;
         }
         case EVENT_T_OOC_LOS:
         {
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.ooc_los.repeatMin, event.ooc_los.repeatMax);
+            UpdateRepeatTimer(pHolder, event.ooc_los.repeatMin, event.ooc_los.repeatMax);
             break;
         }
         case EVENT_T_SPAWNED:
@@ -226,7 +340,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.percent_range.repeatMin, event.percent_range.repeatMax);
+            UpdateRepeatTimer(pHolder, event.percent_range.repeatMin, event.percent_range.repeatMax);
             break;
         }
         case EVENT_T_TARGET_CASTING:
@@ -235,7 +349,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.target_casting.repeatMin, event.target_casting.repeatMax);
+            UpdateRepeatTimer(pHolder, event.target_casting.repeatMin, event.target_casting.repeatMax);
             break;
         }
         case EVENT_T_FRIENDLY_HP:
@@ -251,7 +365,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
             pActionInvoker = pUnit;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.friendly_hp.repeatMin, event.friendly_hp.repeatMax);
+            UpdateRepeatTimer(pHolder, event.friendly_hp.repeatMin, event.friendly_hp.repeatMax);
             break;
         }
         case EVENT_T_FRIENDLY_IS_CC:
@@ -267,7 +381,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
             pActionInvoker = pUnit;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.friendly_is_cc.repeatMin, event.friendly_is_cc.repeatMax);
+            UpdateRepeatTimer(pHolder, event.friendly_is_cc.repeatMin, event.friendly_is_cc.repeatMax);
             break;
         }
         case EVENT_T_FRIENDLY_MISSING_BUFF:
@@ -280,7 +394,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
             pActionInvoker = pUnit;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.friendly_buff.repeatMin, event.friendly_buff.repeatMax);
+            UpdateRepeatTimer(pHolder, event.friendly_buff.repeatMin, event.friendly_buff.repeatMax);
             break;
         }
         case EVENT_T_SUMMONED_UNIT:
@@ -296,7 +410,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.summoned.repeatMin, event.summoned.repeatMax);
+            UpdateRepeatTimer(pHolder, event.summoned.repeatMin, event.summoned.repeatMax);
             break;
         }
         case EVENT_T_TARGET_MANA:
@@ -310,7 +424,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.percent_range.repeatMin, event.percent_range.repeatMax);
+            UpdateRepeatTimer(pHolder, event.percent_range.repeatMin, event.percent_range.repeatMax);
             break;
         }
         case EVENT_T_REACHED_HOME:
@@ -325,7 +439,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.buffed.repeatMin, event.buffed.repeatMax);
+            UpdateRepeatTimer(pHolder, event.buffed.repeatMin, event.buffed.repeatMax);
             break;
         }
         case EVENT_T_TARGET_AURA:
@@ -338,7 +452,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.buffed.repeatMin, event.buffed.repeatMax);
+            UpdateRepeatTimer(pHolder, event.buffed.repeatMin, event.buffed.repeatMax);
             break;
         }
         case EVENT_T_MISSING_AURA:
@@ -348,7 +462,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.buffed.repeatMin, event.buffed.repeatMax);
+            UpdateRepeatTimer(pHolder, event.buffed.repeatMin, event.buffed.repeatMax);
             break;
         }
         case EVENT_T_TARGET_MISSING_AURA:
@@ -361,13 +475,13 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
                 return false;
 
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.buffed.repeatMin, event.buffed.repeatMax);
+            UpdateRepeatTimer(pHolder, event.buffed.repeatMin, event.buffed.repeatMax);
             break;
         }
         case EVENT_T_MOVEMENT_INFORM:
         {
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.move_inform.repeatMin, event.move_inform.repeatMax);
+            UpdateRepeatTimer(pHolder, event.move_inform.repeatMin, event.move_inform.repeatMax);
             break;
         }
         case EVENT_T_SCRIPT:
@@ -380,19 +494,19 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
             if (!m_creature->GetVictim() || !m_creature->GetVictim()->HasUnitState(UNIT_STAT_ROOT))
                 return false;
 
-            pHolder.UpdateRepeatTimer(m_creature, event.victim_rooted.repeatMin, event.victim_rooted.repeatMax);
+            UpdateRepeatTimer(pHolder, event.victim_rooted.repeatMin, event.victim_rooted.repeatMax);
             break;
         }
         case EVENT_T_HIT_BY_AURA:
         {
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.hit_by_aura.repeatMin, event.hit_by_aura.repeatMax);
+            UpdateRepeatTimer(pHolder, event.hit_by_aura.repeatMin, event.hit_by_aura.repeatMax);
             break;
         }
         case EVENT_T_STEALTH_ALERT:
         {
             //Repeat Timers
-            pHolder.UpdateRepeatTimer(m_creature, event.stealth_alert.repeatMin, event.stealth_alert.repeatMax);
+            UpdateRepeatTimer(pHolder, event.stealth_alert.repeatMin, event.stealth_alert.repeatMax);
             break;
         }
         default:
@@ -403,13 +517,13 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
     }
 
     // If command is flee and caster is casting
-    for (const auto& action : pHolder.Event.action) // scriptmap - multimap<uint32, ScriptInfo> 0-3 action
+    for (const auto& action : pHolder.Event.action) // scriptmap - vector<ScriptInfo> 0-3 action
     {
         if (action)
         {
             for (const auto& x : *action)
             {
-                if ((x.second.command == SCRIPT_COMMAND_FLEE) && (m_creature->IsNonMeleeSpellCasted(false, false, false)))
+                if ((x.command == SCRIPT_COMMAND_FLEE) && (m_creature->IsNonMeleeSpellCasted(false, false, false)))
                 {
                     return false;
                 }
@@ -470,7 +584,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject*
     if (scriptFailed && (pHolder.Event.event_flags & EFLAG_CHECK_RESULT))
     {
         pHolder.Enabled = true;
-        pHolder.UpdateRepeatTimer(m_creature, 0, 0);
+        UpdateRepeatTimer(pHolder, 0, 0);
         return false;
     }
 
@@ -487,7 +601,7 @@ bool CreatureEventAI::ProcessAction(ScriptMap* action, uint32 EventId, WorldObje
 
     for (auto const& x : *action)
     {
-        if (map->ScriptCommandStartDirect(x.second, m_creature, target))
+        if (map->ScriptCommandStartDirect(x, m_creature, target))
             return true;
     }
 
@@ -506,9 +620,8 @@ void CreatureEventAI::JustRespawned()
         return;
 
     //Handle Spawned Events
-    for (auto& i : m_CreatureEventAIList)
-        if (i.Event.event_type == EVENT_T_SPAWNED)
-            ProcessEvent(i);
+    for (uint32 index : GetEventsOfType(EVENT_T_SPAWNED))
+        ProcessEvent(m_CreatureEventAIList[index]);
 }
 
 void CreatureEventAI::Reset()
@@ -519,20 +632,12 @@ void CreatureEventAI::Reset()
     if (m_bEmptyList)
         return;
 
-    //Reset all events to enabled
-    for (auto& i : m_CreatureEventAIList)
+    //Reset all out of combat timers
+    for (uint32 index : GetEventsOfType(EVENT_T_TIMER_OOC))
     {
-        CreatureEventAI_Event const& event = i.Event;
-        switch (event.event_type)
-        {
-            //Reset all out of combat timers
-            case EVENT_T_TIMER_OOC:
-            {
-                if (i.UpdateRepeatTimer(m_creature, event.timer.initialMin, event.timer.initialMax))
-                    i.Enabled = true;
-                break;
-            }
-        }
+        CreatureEventAIHolder& i = m_CreatureEventAIList[index];
+        if (UpdateRepeatTimer(i, i.Event.timer.initialMin, i.Event.timer.initialMax))
+            i.Enabled = true;
     }
 }
 
@@ -540,11 +645,8 @@ void CreatureEventAI::JustReachedHome()
 {
     if (!m_bEmptyList)
     {
-        for (auto& i : m_CreatureEventAIList)
-        {
-            if (i.Event.event_type == EVENT_T_REACHED_HOME)
-                ProcessEvent(i);
-        }
+        for (uint32 index : GetEventsOfType(EVENT_T_REACHED_HOME))
+            ProcessEvent(m_CreatureEventAIList[index]);
     }
 
     Reset();
@@ -558,11 +660,8 @@ void CreatureEventAI::EnterEvadeMode()
         return;
 
     //Handle Evade events
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_EVADE)
-            ProcessEvent(i);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_EVADE))
+        ProcessEvent(m_CreatureEventAIList[index]);
 }
 
 void CreatureEventAI::OnCombatStop()
@@ -573,11 +672,8 @@ void CreatureEventAI::OnCombatStop()
         return;
 
     //Handle Combat Stop events
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_LEAVE_COMBAT)
-            ProcessEvent(i);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_LEAVE_COMBAT))
+        ProcessEvent(m_CreatureEventAIList[index]);
 }
 
 void CreatureEventAI::JustDied(Unit* killer)
@@ -588,14 +684,11 @@ void CreatureEventAI::JustDied(Unit* killer)
         return;
 
     //Handle Evade events
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_DEATH)
-            ProcessEvent(i, killer);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_DEATH))
+        ProcessEvent(m_CreatureEventAIList[index], killer);
 
     // reset phase after any death state events
-    m_Phase = 0;
+    SetPhase(0);
 }
 
 void CreatureEventAI::KilledUnit(Unit* victim)
@@ -603,11 +696,8 @@ void CreatureEventAI::KilledUnit(Unit* victim)
     if (m_bEmptyList || victim->GetTypeId() != TYPEID_PLAYER)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_KILL)
-            ProcessEvent(i, victim);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_KILL))
+        ProcessEvent(m_CreatureEventAIList[index], victim);
 }
 
 void CreatureEventAI::JustSummoned(Creature* pUnit)
@@ -615,11 +705,8 @@ void CreatureEventAI::JustSummoned(Creature* pUnit)
     if (m_bEmptyList || !pUnit)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_SUMMONED_UNIT)
-            ProcessEvent(i, pUnit);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_SUMMONED_UNIT))
+        ProcessEvent(m_CreatureEventAIList[index], pUnit);
 }
 
 void CreatureEventAI::SummonedCreatureJustDied(Creature* pUnit)
@@ -627,11 +714,8 @@ void CreatureEventAI::SummonedCreatureJustDied(Creature* pUnit)
     if (m_bEmptyList || !pUnit)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_SUMMONED_JUST_DIED)
-            ProcessEvent(i, pUnit);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_SUMMONED_JUST_DIED))
+        ProcessEvent(m_CreatureEventAIList[index], pUnit);
 }
 
 void CreatureEventAI::SummonedCreatureDespawn(Creature* pUnit)
@@ -639,11 +723,8 @@ void CreatureEventAI::SummonedCreatureDespawn(Creature* pUnit)
     if (m_bEmptyList || !pUnit)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
-    {
-        if (i.Event.event_type == EVENT_T_SUMMONED_JUST_DESPAWN)
-            ProcessEvent(i, pUnit);
-    }
+    for (uint32 index : GetEventsOfType(EVENT_T_SUMMONED_JUST_DESPAWN))
+        ProcessEvent(m_CreatureEventAIList[index], pUnit);
 }
 
 void CreatureEventAI::EnterCombat(Unit *enemy)
@@ -662,13 +743,13 @@ void CreatureEventAI::EnterCombat(Unit *enemy)
                     break;
                 //Reset all in combat timers
                 case EVENT_T_TIMER_IN_COMBAT:
-                    if (i.UpdateRepeatTimer(m_creature, event.timer.initialMin, event.timer.initialMax))
+                    if (UpdateRepeatTimer(i, event.timer.initialMin, event.timer.initialMax))
                         i.Enabled = true;
                     break;
                 //All normal events need to be re-enabled and their time set to 0
                 default:
                     i.Enabled = true;
-                    i.Time = 0;
+                    SetEventTimer(i, 0);
                     break;
             }
         }
@@ -749,22 +830,21 @@ void CreatureEventAI::MoveInLineOfSight(Unit *pWho)
 
 void CreatureEventAI::UpdateEventsOn_MoveInLineOfSight(Unit* pWho)
 {
-    for (auto& itr : m_CreatureEventAIList)
+    for (uint32 index : GetEventsOfType(EVENT_T_OOC_LOS))
     {
-        if (itr.Event.event_type == EVENT_T_OOC_LOS)
-        {
-            //can trigger if closer than fMaxAllowedRange
-            float fMaxAllowedRange = (float)itr.Event.ooc_los.maxRange;
+        CreatureEventAIHolder& itr = m_CreatureEventAIList[index];
 
-            //if range is ok and we are actually in LOS
-            if (m_creature->IsWithinDistInMap(pWho, fMaxAllowedRange))
-            {
-                if ((itr.Event.ooc_los.reaction == ULR_ANY) ||
-                    (itr.Event.ooc_los.reaction == ULR_NON_HOSTILE && !m_creature->IsHostileTo(pWho)) ||
-                    (itr.Event.ooc_los.reaction == ULR_HOSTILE && m_creature->IsHostileTo(pWho)))
-                    if (m_creature->IsWithinLOSInMap(pWho))
-                        ProcessEvent(itr, pWho);
-            }
+        //can trigger if closer than fMaxAllowedRange
+        float fMaxAllowedRange = (float)itr.Event.ooc_los.maxRange;
+
+        //if range is ok and we are actually in LOS
+        if (m_creature->IsWithinDistInMap(pWho, fMaxAllowedRange))
+        {
+            if ((itr.Event.ooc_los.reaction == ULR_ANY) ||
+                (itr.Event.ooc_los.reaction == ULR_NON_HOSTILE && !m_creature->IsHostileTo(pWho)) ||
+                (itr.Event.ooc_los.reaction == ULR_HOSTILE && m_creature->IsHostileTo(pWho)))
+                if (m_creature->IsWithinLOSInMap(pWho))
+                    ProcessEvent(itr, pWho);
         }
     }
 }
@@ -774,8 +854,12 @@ void CreatureEventAI::SpellHit(WorldObject* pUnit, const SpellEntry* pSpell)
     if (m_bEmptyList)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
+    // both kinds of events, in list order
+    CreatureEventAI_Index_Vec const& spellEvents = GetEventsOfType(EVENT_T_HIT_BY_SPELL);
+    CreatureEventAI_Index_Vec const& auraEvents = GetEventsOfType(EVENT_T_HIT_BY_AURA);
+    for (auto spellItr = spellEvents.begin(), auraItr = auraEvents.begin(); spellItr != spellEvents.end() || auraItr != auraEvents.end();)
     {
+        CreatureEventAIHolder& i = m_CreatureEventAIList[auraItr == auraEvents.end() || (spellItr != spellEvents.end() && *spellItr < *auraItr) ? *spellItr++ : *auraItr++];
         switch (i.Event.event_type)
         {
             case EVENT_T_HIT_BY_SPELL:
@@ -801,10 +885,12 @@ void CreatureEventAI::MovementInform(uint32 type, uint32 id)
     if (m_bEmptyList)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
-        if (i.Event.event_type == EVENT_T_MOVEMENT_INFORM)
-            if (i.Event.move_inform.motionType == type && i.Event.move_inform.pointId == id)
-                ProcessEvent(i);
+    for (uint32 index : GetEventsOfType(EVENT_T_MOVEMENT_INFORM))
+    {
+        CreatureEventAIHolder& i = m_CreatureEventAIList[index];
+        if (i.Event.move_inform.motionType == type && i.Event.move_inform.pointId == id)
+            ProcessEvent(i);
+    }
 }
 
 void CreatureEventAI::UpdateAI(const uint32 diff)
@@ -836,25 +922,19 @@ void CreatureEventAI::UpdateEventsOn_UpdateAI(const uint32 diff, bool Combat)
     {
         m_EventDiff += diff;
 
+        //Decrement Timers
+        UpdateEventTimers(m_EventDiff);
+
         //Check for time based events
-        for (auto& i : m_CreatureEventAIList)
+        for (uint32 index : m_EntryEvents->updated)
         {
-            //Decrement Timers
-            if (i.Time)
-            {
-                if (i.Time > m_EventDiff)
-                {
-                    //Do not decrement timers if event cannot trigger in this phase
-                    if (!(i.Event.event_inverse_phase_mask & (1 << m_Phase)))
-                        i.Time -= m_EventDiff;
+            CreatureEventAIHolder& i = m_CreatureEventAIList[index];
 
-                    //Skip processing of events that have time remaining
-                    continue;
-                }
-                else i.Time = 0;
-            }
+            //Skip processing of events that have time remaining
+            if (i.Time)
+                continue;
 
-            //Events that are updated every EVENT_UPDATE_TIME
+            //Events that are updated every EVENT_UPDATE_TIME, IsUpdatedEvent() lists them
             switch (i.Event.event_type)
             {
                 case EVENT_T_TIMER_OOC:
@@ -905,15 +985,13 @@ void CreatureEventAI::ReceiveEmote(Player* pPlayer, uint32 text_emote)
     if (m_bEmptyList)
         return;
 
-    for (auto& itr : m_CreatureEventAIList)
+    for (uint32 index : GetEventsOfType(EVENT_T_RECEIVE_EMOTE))
     {
-        if (itr.Event.event_type == EVENT_T_RECEIVE_EMOTE)
-        {
-            if (itr.Event.receive_emote.emoteId != text_emote)
-                continue;
+        CreatureEventAIHolder& itr = m_CreatureEventAIList[index];
+        if (itr.Event.receive_emote.emoteId != text_emote)
+            continue;
 
-            ProcessEvent(itr, pPlayer);
-        }
+        ProcessEvent(itr, pPlayer);
     }
 }
 
@@ -922,11 +1000,11 @@ void CreatureEventAI::OnScriptEventHappened(uint32 uiEvent, uint32 uiData, World
     if (m_bEmptyList)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
+    for (uint32 index : GetEventsOfType(EVENT_T_SCRIPT))
     {
-        if (i.Event.event_type == EVENT_T_SCRIPT)
-            if ((i.Event.map_event.eventId == uiEvent) && (i.Event.map_event.data == uiData))
-                ProcessEvent(i, ToUnit(pInvoker));
+        CreatureEventAIHolder& i = m_CreatureEventAIList[index];
+        if ((i.Event.map_event.eventId == uiEvent) && (i.Event.map_event.data == uiData))
+            ProcessEvent(i, ToUnit(pInvoker));
     }
 }
 
@@ -935,16 +1013,14 @@ void CreatureEventAI::GroupMemberJustDied(Creature* pUnit, bool isLeader)
     if (m_bEmptyList)
         return;
 
-    for (auto& i : m_CreatureEventAIList)
+    for (uint32 index : GetEventsOfType(EVENT_T_GROUP_MEMBER_DIED))
     {
-        if (i.Event.event_type == EVENT_T_GROUP_MEMBER_DIED)
-        {
-            if (i.Event.group_member_died.creatureId && (i.Event.group_member_died.creatureId != pUnit->GetEntry()))
-                continue;
+        CreatureEventAIHolder& i = m_CreatureEventAIList[index];
+        if (i.Event.group_member_died.creatureId && (i.Event.group_member_died.creatureId != pUnit->GetEntry()))
+            continue;
 
-            if (((bool)i.Event.group_member_died.isLeader) == isLeader)
-                ProcessEvent(i, pUnit);
-        } 
+        if (((bool)i.Event.group_member_died.isLeader) == isLeader)
+            ProcessEvent(i, pUnit);
     }
 }
 
@@ -957,8 +1033,7 @@ void CreatureEventAI::OnMoveInStealth(Unit* who)
 
     if (!m_bEmptyList)
     {
-        for (auto& i : m_CreatureEventAIList)
-            if (i.Event.event_type == EVENT_T_STEALTH_ALERT)
-                ProcessEvent(i, who);
+        for (uint32 index : GetEventsOfType(EVENT_T_STEALTH_ALERT))
+            ProcessEvent(m_CreatureEventAIList[index], who);
     }
 }
@@ -25,6 +25,8 @@
 #include "Common.h"
 #include "CreatureAI.h"
 
+#include <memory>
+
 class Unit;
 class Creature;
 class Player;
@@ -276,18 +278,31 @@ struct CreatureEventAI_Event
 
 //Event_Map
 typedef turtle_vector<CreatureEventAI_Event, Category_EventAI> CreatureEventAI_Event_Vec;
-typedef turtle_unordered_map<uint32, CreatureEventAI_Event_Vec, Category_EventAI > CreatureEventAI_Event_Map;
+typedef turtle_vector<uint32, Category_EventAI> CreatureEventAI_Index_Vec;
+
+// Events of a creature entry, with the positions of the events of each type, built once at
+// load and shared by all the creatures of the entry. They keep it alive across a table reload.
+struct CreatureEventAI_EntryEvents
+{
+    CreatureEventAI_Event_Vec events;
+    CreatureEventAI_Index_Vec byType[EVENT_T_END];
+    CreatureEventAI_Index_Vec updated;                      // checked every EVENT_UPDATE_TIME, in list order
+};
+
+typedef std::shared_ptr<CreatureEventAI_EntryEvents const> CreatureEventAI_EntryEventsPtr;
+typedef turtle_unordered_map<uint32, CreatureEventAI_EntryEventsPtr, Category_EventAI > CreatureEventAI_Event_Map;
 
 struct CreatureEventAIHolder
 {
-    explicit CreatureEventAIHolder(CreatureEventAI_Event p) : Event(p), Time(0), Enabled(true) {}
+    explicit CreatureEventAIHolder(CreatureEventAI_Event const& p) : Event(p), Time(0), Enabled(true), TimerEnd(0), TimerId(0), Paused(false) {}
 
-    CreatureEventAI_Event Event;
-    uint32 Time;
+    CreatureEventAI_Event const& Event;
+    uint32 Time;                                            // non zero while the timer runs, time left when paused
     bool Enabled;
 
-    // helper
-    bool UpdateRepeatTimer(Creature* creature, uint32 repeatMin, uint32 repeatMax);
+    uint64 TimerEnd;                                        // event clock at which the timer ends, 0 when paused
+    uint32 TimerId;                                         // changes when the timer is set, outdates its heap entries
+    bool Paused;                                            // in the paused timers list
 };
 
 class CreatureEventAI : public CreatureAI
@@ -323,11 +338,15 @@ class CreatureEventAI : public CreatureAI
         void OnMoveInStealth(Unit* who) override;
 
         static int Permissible(const Creature *);
+        // whether the event type is checked every EVENT_UPDATE_TIME
+        static bool IsUpdatedEvent(EventAI_Type type);
 
         bool ProcessEvent(CreatureEventAIHolder& pHolder, WorldObject* pActionInvoker = nullptr);
         bool ProcessAction(ScriptMap* action, uint32 EventId, WorldObject* pActionInvoker);
 
-        uint8  m_Phase;                                     // Current phase, max 32 phases
+        void SetPhase(uint8 phase);
+
+        uint8  m_Phase;                                     // Current phase, max 32 phases, set with SetPhase()
 
     protected:
         uint32 m_EventUpdateTime;                           //Time between event updates
@@ -336,11 +355,32 @@ class CreatureEventAI : public CreatureAI
 
         //Variables used by Events themselves
         typedef std::vector<CreatureEventAIHolder> CreatureEventAIList;
+        CreatureEventAI_EntryEventsPtr m_EntryEvents;
         CreatureEventAIList m_CreatureEventAIList;          //Holder for events (stores enabled, time, and eventid)
         float  m_AttackDistance;                            // Distance to attack from
         float  m_AttackAngle;                               // Angle of attack
         bool m_bCanSummonGuards;
 
+        // Running timers wait in a min heap on the event clock, which moves by the time between
+        // event updates. Timers paused by the phase are kept aside.
+        struct EventTimer
+        {
+            uint64 end;
+            uint32 holder;
+            uint32 id;
+        };
+        static bool IsLaterTimer(EventTimer const& a, EventTimer const& b) { return a.end > b.end; }
+
+        uint64 m_EventClock;
+        std::vector<EventTimer> m_EventTimers;
+        std::vector<uint32> m_PausedTimers;
+
+        bool UpdateRepeatTimer(CreatureEventAIHolder& holder, uint32 repeatMin, uint32 repeatMax);
+        void SetEventTimer(CreatureEventAIHolder& holder, uint32 time);
+        void RebuildEventTimers();
+        void UpdateEventTimers(uint32 diff);
+        CreatureEventAI_Index_Vec const& GetEventsOfType(EventAI_Type type) const { return m_EntryEvents->byType[type]; }
+
         void UpdateEventsOn_UpdateAI(const uint32 diff, bool Combat);
         void UpdateEventsOn_MoveInLineOfSight(Unit* pWho);
 };
@@ -31,6 +31,8 @@
 #include "Conditions.h"
 #include "ScriptMgr.h"
 
+#include <unordered_map>
+
 CreatureEventAIMgr sEventAIMgr;
 
 // -------------------
@@ -44,6 +46,8 @@ void CreatureEventAIMgr::LoadCreatureEventAI_Events()
                           "event_param1, event_param2, event_param3, event_param4, "
                           "action1_script, action2_script, action3_script "
                           "FROM creature_ai_events");
+    std::unordered_map<uint32, std::shared_ptr<CreatureEventAI_EntryEvents>> entries;
+
     if (result)
     {
         do
@@ -337,11 +341,35 @@ void CreatureEventAIMgr::LoadCreatureEventAI_Events()
                 }
             }
 
+            //Debug events are only kept in debug builds
+#ifndef _DEBUG
+            if (temp.event_flags & EFLAG_DEBUG_ONLY)
+                continue;
+#endif
+
             //Add to list
-            m_CreatureEventAI_Event_Map[creature_id].push_back(temp);
+            std::shared_ptr<CreatureEventAI_EntryEvents>& entry = entries[creature_id];
+            if (!entry)
+                entry = std::make_shared<CreatureEventAI_EntryEvents>();
+            entry->events.push_back(temp);
         }
         while (result->NextRow());
 
         delete result;
     }
+
+    // index the events of every creature by type, the hooks only go through the events they trigger
+    for (auto& itr : entries)
+    {
+        CreatureEventAI_EntryEvents& entry = *itr.second;
+        for (uint32 index = 0; index < entry.events.size(); ++index)
+        {
+            EventAI_Type type = entry.events[index].event_type;
+            entry.byType[type].push_back(index);
+            if (CreatureEventAI::IsUpdatedEvent(type))
+                entry.updated.push_back(index);
+        }
+
+        m_CreatureEventAI_Event_Map[itr.first] = std::move(itr.second);
+    }
 }
@@ -1,6 +1,7 @@
 #include <regex>
 #include <string>
 #include <algorithm>
+#include <bitset>
 
 #include "Database/DatabaseEnv.h"
 #include "Util.h"
@@ -44,8 +45,11 @@ Antispam::Antispam()
 
 void Antispam::LoadFromDB()
 {
+    std::lock_guard<std::mutex> guard(m_matcherLock);
+
     sLog.outString("Loading table 'antispam_blacklist'");
     m_blackList.clear();
+    m_regexBlacklist.clear();
 
     QueryResult* result = LoginDatabase.Query("SELECT * FROM antispam_blacklist");
     if (result)
@@ -54,7 +58,7 @@ void Antispam::LoadFromDB()
         {
             auto fields = result->Fetch();
             if (fields[1].GetBool())
-                m_regexBlacklist.emplace_back(std::make_unique<re2::RE2>(fields[0].GetString())); // immediately create the regex pattern for precompiled matching
+                m_regexBlacklist.emplace_back(fields[0].GetCppString());
             else
                 m_blackList.insert(fields[0].GetCppString());
         }
@@ -131,6 +135,36 @@ void Antispam::LoadFromDB()
 
     sLog.outString(">> %u unicode symbols loaded", m_unicode.size());
     sLog.outString();
+
+    RebuildMatcher();
+}
+
+void Antispam::RebuildMatcher()
+{
+    auto matcher = std::make_shared<AntispamMatcher>();
+
+    for (auto const& word : m_blackList)
+        matcher->AddBlacklistWord(word);
+
+    for (auto const& word : m_scores[MSG_TYPE_NORMALIZED])
+        matcher->AddScoreWord(word.first, AntispamMatcher::TEXT_NORMALIZED, word.second);
+
+    for (auto const& word : m_scores[MSG_TYPE_ORIGINAL])
+        matcher->AddScoreWord(word.first, AntispamMatcher::TEXT_ORIGINAL, word.second);
+
+    for (auto const& pattern : m_regexBlacklist)
+        matcher->AddRegex(pattern);
+
+    matcher->Compile();
+
+    // the worker keeps using the previous matcher for the message it is filtering
+    m_matcher = std::move(matcher);
+}
+
+AntispamMatcherPtr Antispam::GetMatcher()
+{
+    std::lock_guard<std::mutex> guard(m_matcherLock);
+    return m_matcher;
 }
 
 void Antispam::LoadConfig()
@@ -206,14 +240,54 @@ bool Antispam::AddMessage(std::string const& msg, uint32 language, uint32 type,
     return false;
 }
 
-struct FindMsg
+uint32 MessageRepeatHistory::Add(uint64 fingerprint)
 {
-    FindMsg(const std::string& m) : msg(m) {}
-    bool operator()(const std::string& s) { return s == msg; }
+    for (uint8 i = 0; i < size; ++i)
+    {
+        if (std::bitset<64>(groups[i].fingerprint ^ fingerprint).count() <= MAX_DISTANCE)
+            return ++groups[i].count;
+    }
+
+    Group& group = groups[size < MAX_GROUPS ? size++ : next];
+    if (size == MAX_GROUPS)
+        next = (next + 1) % MAX_GROUPS;
 
-    private:
-        const std::string& msg;
-};
+    group.fingerprint = fingerprint;
+    group.count = 1;
+    return 1;
+}
+
+uint64 Antispam::GetMessageFingerprint(std::string const& msg)
+{
+    // letters and digits only, so that spacing, punctuation and case do not matter
+    std::string text;
+    text.reserve(msg.size());
+    for (char c : msg)
+        if (isalnum(uint8(c)) || uint8(c) >= 0x80)
+            text.push_back(toupper(uint8(c)));
+
+    // SimHash over the 4 characters shingles: every bit is the majority vote of the shingle hashes
+    uint32 const shingleSize = 4;
+    uint32 const shingles = text.size() > shingleSize ? text.size() - shingleSize + 1 : 1;
+    int32 votes[64] = {};
+    for (uint32 i = 0; i < shingles; ++i)
+    {
+        // 64 bits FNV-1a
+        uint64 hash = 14695981039346656037ULL;
+        for (uint32 j = i; j < i + shingleSize && j < text.size(); ++j)
+            hash = (hash ^ uint8(text[j])) * 1099511628211ULL;
+
+        for (uint32 bit = 0; bit < 64; ++bit)
+            votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+    }
+
+    uint64 fingerprint = 0;
+    for (uint32 bit = 0; bit < 64; ++bit)
+        if (votes[bit] > 0)
+            fingerprint |= uint64(1) << bit;
+
+    return fingerprint;
+}
 
 void Antispam::ProcessMessages(uint32 diff)
 {
@@ -279,7 +353,7 @@ void Antispam::ProcessMessages(uint32 diff)
 
             LowGuidPair lowGuidPair(guidFrom, guidTo);
 
-            m_messageRepeats[type][guidFrom].push_back(messageBlock.msg);
+            uint32 repeats = m_messageRepeats[type][guidFrom].Add(GetMessageFingerprint(messageBlock.msg));
 
             auto counter = m_messageCounters[type].find(guidFrom);
             auto hasCounter = counter != m_messageCounters[type].end();
@@ -302,7 +376,6 @@ void Antispam::ProcessMessages(uint32 diff)
 
             if (hasCounter)
             {
-                auto repeats = std::count_if(m_messageRepeats[type][guidFrom].begin(), m_messageRepeats[type][guidFrom].end(), FindMsg(messageBlock.msg));
                 if (repeats > m_messageRepeatCount)
                 {
                     ApplySanction(messageBlock, DETECT_FLOOD, repeats);
@@ -498,43 +571,29 @@ bool Antispam::FilterMessage(MessageBlock const& msgBlock)
     auto normMsg = NormalizeMessage(msgBlock.msg);
     auto origMsg = NormalizeMessage(msgBlock.msg, m_originalNormalizeMask);
 
+    AntispamMatcherPtr matcher = GetMatcher();
+    if (!matcher)
+        return false;
+
+    // a single pass over each text for all the words and all the regexes
+    AntispamMatcher::Result result = matcher->Match(normMsg, origMsg);
+
     bool block = false;
-    uint32 score = 0;
 
-    for (auto& word : m_blackList)
+    if (result.blacklistedWord)
     {
-        if (origMsg.find(word) != std::string::npos ||
-            normMsg.find(word) != std::string::npos)
-        {
-            block = true;
-            sLog.outSpam("[Acc %u][Char %u] Blocked because of blacklisted word \'%s\'.", msgBlock.fromAccount, msgBlock.fromGuid.GetCounter(), word.c_str());
-            break;
-        }
+        block = true;
+        sLog.outSpam("[Acc %u][Char %u] Blocked because of blacklisted word \'%s\'.", msgBlock.fromAccount, msgBlock.fromGuid.GetCounter(), result.blacklistedWord->c_str());
     }
 
-    for (const auto& pattern : m_regexBlacklist)
+    if (result.blacklistedRegex)
     {
-        if (re2::RE2::PartialMatch(origMsg, *pattern) || re2::RE2::PartialMatch(normMsg, *pattern))
-        {
-            block = true;
-            sLog.outSpam("[Acc %u][Char %u] Blocked because of blacklisted regex \'%s\'.", msgBlock.fromAccount, msgBlock.fromGuid.GetCounter(), pattern->pattern().c_str());
-            break;
-        }
+        block = true;
+        sLog.outSpam("[Acc %u][Char %u] Blocked because of blacklisted regex \'%s\'.", msgBlock.fromAccount, msgBlock.fromGuid.GetCounter(), result.blacklistedRegex->c_str());
     }
 
-    if (!block)
-    {
-        for (auto& word : m_scores[MSG_TYPE_NORMALIZED])
-            if (normMsg.find(word.first) != std::string::npos)
-                score += word.second;
-
-        for (auto& word : m_scores[MSG_TYPE_ORIGINAL])
-            if (origMsg.find(word.first) != std::string::npos)
-                score += word.second;
-
-        if (score > m_threshold)
-            block = true;
-    }
+    if (!block && uint32(result.score) > m_threshold)
+        block = true;
 
     return block;
 }
@@ -625,7 +684,11 @@ void Antispam::ShowMuted(WorldSession* session)
 
 void Antispam::BlacklistWord(std::string word)
 {
-    m_blackList.insert(word);
+    {
+        std::lock_guard<std::mutex> guard(m_matcherLock);
+        if (m_blackList.insert(word).second)
+            RebuildMatcher();
+    }
 
     LoginDatabase.escape_string(word);
     LoginDatabase.PExecute("REPLACE INTO `antispam_blacklist` (`word`) VALUES ('%s')", word.c_str());
@@ -633,7 +696,11 @@ void Antispam::BlacklistWord(std::string word)
 
 void Antispam::WhitelistWord(std::string word)
 {
-    m_blackList.erase(word);
+    {
+        std::lock_guard<std::mutex> guard(m_matcherLock);
+        if (m_blackList.erase(word))
+            RebuildMatcher();
+    }
 
     LoginDatabase.escape_string(word);
     LoginDatabase.PExecute("DELETE FROM `antispam_blacklist` WHERE `word` = '%s'", word.c_str());
@@ -641,7 +708,12 @@ void Antispam::WhitelistWord(std::string word)
 
 void Antispam::AddRegexBlacklist(std::string pattern)
 {
-    m_regexBlacklist.push_back(std::make_unique<re2::RE2>(std::move(pattern)));
+    {
+        std::lock_guard<std::mutex> guard(m_matcherLock);
+        m_regexBlacklist.push_back(pattern);
+        RebuildMatcher();
+    }
+
     LoginDatabase.escape_string(pattern);
     LoginDatabase.PExecute("REPLACE INTO `antispam_blacklist` (`word`, `regex`) VALUES ('%s', 1)", pattern.c_str());
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "GuildMgr.h"
 #include "ChannelMgr.h"
 #include "Anticheat.h"
+#include "AntispamMatcher.h"
 #include "re2/re2.h"
 
 typedef std::chrono::high_resolution_clock Clock;
@@ -92,7 +93,31 @@ struct pair_hash {
 typedef std::pair<uint32, uint32> LowGuidPair;
 typedef std::unordered_map<LowGuidPair, MessageBlock, pair_hash> MessageBlocks;
 typedef std::unordered_map<uint32, MessageCounter> MessageCounters;
-typedef std::unordered_map<uint32, std::list<std::string>> MessageRepeats;
+
+// Messages recently sent by a player, grouped by their SimHash fingerprint: a message whose
+// fingerprint is within a few bits of a group's counts as a repeat of it, which also catches
+// the repeats altered by a character or two. The number of groups is fixed, so that a check
+// costs the same however much a player has written.
+struct MessageRepeatHistory
+{
+    struct Group
+    {
+        uint64 fingerprint;
+        uint32 count;
+    };
+
+    static uint32 const MAX_GROUPS = 8;
+    static uint32 const MAX_DISTANCE = 6;                   // differing bits out of 64
+
+    // adds the message and returns how many times it was sent, itself included
+    uint32 Add(uint64 fingerprint);
+
+    Group groups[MAX_GROUPS];
+    uint8 size = 0;
+    uint8 next = 0;                                         // the oldest group once full
+};
+
+typedef std::unordered_map<uint32, MessageRepeatHistory> MessageRepeats;
 
 class Antispam : public AntispamInterface
 {
@@ -125,6 +150,8 @@ class Antispam : public AntispamInterface
         void WhitelistWord(std::string word) override;
         void AddRegexBlacklist(std::string pattern) override;
 
+        static uint64 GetMessageFingerprint(std::string const& msg);
+
         StringSet const* GetMutedMessagesForAccount(uint32 accountId) override
         {
             auto itr = m_mutedMessages.find(accountId);
@@ -153,6 +180,10 @@ class Antispam : public AntispamInterface
         }
 
     private:
+        // rebuilds the matcher from the lists, m_matcherLock must be held
+        void RebuildMatcher();
+        AntispamMatcherPtr GetMatcher();
+
         bool m_enabled;
         uint8 m_restrictionLevel;
         uint16 m_originalNormalizeMask;
@@ -170,7 +201,7 @@ class Antispam : public AntispamInterface
         bool m_banEnabled;
         bool m_mergeAllWhispers;
 
-        turtle_vector<std::unique_ptr<re2::RE2>, Category_Anticheat> m_regexBlacklist;
+        turtle_vector<std::string, Category_Anticheat> m_regexBlacklist;
         StringSet m_blackList;
         StringMap m_replacement;
         ScoreMap m_scores[MSG_TYPE_MAX];
@@ -185,6 +216,9 @@ class Antispam : public AntispamInterface
         MessageCounters m_messageCounters[A_CHAT_TYPE_MAX];
         MessageRepeats m_messageRepeats[A_CHAT_TYPE_MAX];
 
+        AntispamMatcherPtr m_matcher;
+        std::mutex m_matcherLock;
+
         std::thread m_worker;
         std::mutex m_messageMutex;
 };
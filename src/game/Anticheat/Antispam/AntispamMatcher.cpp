@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <queue>
+
+#include "AntispamMatcher.h"
+#include "Log.h"
+
+static uint32 const NO_NODE = uint32(-1);
+
+AntispamMatcher::AntispamMatcher() : m_compiled(false)
+{
+    m_nodes.emplace_back();                                 // root
+}
+
+uint32 AntispamMatcher::GetWordIndex(std::string const& word)
+{
+    uint32 node = 0;
+    for (char ch : word)
+    {
+        uint8 c = uint8(ch);
+        auto& next = m_nodes[node].next;
+        auto itr = std::lower_bound(next.begin(), next.end(), std::make_pair(c, uint32(0)));
+        if (itr != next.end() && itr->first == c)
+        {
+            node = itr->second;
+            continue;
+        }
+
+        uint32 child = m_nodes.size();
+        next.emplace(itr, c, child);
+        m_nodes.emplace_back();
+        node = child;
+    }
+
+    if (m_nodes[node].word < 0)
+    {
+        m_nodes[node].word = m_words.size();
+        m_words.emplace_back();
+        m_words.back().word = word;
+    }
+
+    return m_nodes[node].word;
+}
+
+void AntispamMatcher::AddBlacklistWord(std::string const& word)
+{
+    MANGOS_ASSERT(!m_compiled);
+    if (!word.empty())
+        m_words[GetWordIndex(word)].blacklisted = true;
+}
+
+void AntispamMatcher::AddScoreWord(std::string const& word, Text text, int32 score)
+{
+    MANGOS_ASSERT(!m_compiled);
+    if (!word.empty())
+        m_words[GetWordIndex(word)].scores[text] = score;
+}
+
+void AntispamMatcher::AddRegex(std::string const& pattern)
+{
+    MANGOS_ASSERT(!m_compiled);
+    if (!m_regexSet)
+        m_regexSet = std::make_unique<re2::RE2::Set>(re2::RE2::DefaultOptions, re2::RE2::UNANCHORED);
+
+    std::string error;
+    if (m_regexSet->Add(pattern, &error) < 0)
+    {
+        sLog.outError("Antispam: invalid blacklist regex '%s': %s", pattern.c_str(), error.c_str());
+        return;
+    }
+
+    // RE2::Set numbers the patterns in the order they were added
+    m_regexes.push_back(pattern);
+}
+
+void AntispamMatcher::Compile()
+{
+    MANGOS_ASSERT(!m_compiled);
+    m_compiled = true;
+
+    // breadth first, so the fail node of a node is always done before it
+    std::queue<uint32> queue;
+    for (auto const& edge : m_nodes[0].next)
+        queue.push(edge.second);
+
+    while (!queue.empty())
+    {
+        uint32 node = queue.front();
+        queue.pop();
+
+        for (auto const& edge : m_nodes[node].next)
+        {
+            uint32 child = edge.second;
+            Node& childNode = m_nodes[child];
+            childNode.fail = Step(m_nodes[node].fail, edge.first);
+            if (childNode.fail == child)
+                childNode.fail = 0;
+
+            Node const& failNode = m_nodes[childNode.fail];
+            childNode.output = failNode.word >= 0 ? childNode.fail : failNode.output;
+            queue.push(child);
+        }
+    }
+
+    if (m_regexSet && !m_regexSet->Compile())
+    {
+        sLog.outError("Antispam: blacklist regexes could not be compiled, they are ignored.");
+        m_regexSet.reset();
+        m_regexes.clear();
+    }
+    else if (m_regexes.empty())
+        m_regexSet.reset();
+}
+
+uint32 AntispamMatcher::FindNext(uint32 node, uint8 c) const
+{
+    auto const& next = m_nodes[node].next;
+    auto itr = std::lower_bound(next.begin(), next.end(), std::make_pair(c, uint32(0)));
+    return itr != next.end() && itr->first == c ? itr->second : NO_NODE;
+}
+
+uint32 AntispamMatcher::Step(uint32 node, uint8 c) const
+{
+    while (true)
+    {
+        uint32 next = FindNext(node, c);
+        if (next != NO_NODE)
+            return next;
+        if (!node)
+            return 0;
+        node = m_nodes[node].fail;
+    }
+}
+
+void AntispamMatcher::CollectWords(std::string const& text, std::vector<uint32>& words) const
+{
+    words.clear();
+
+    uint32 node = 0;
+    for (char ch : text)
+    {
+        node = Step(node, uint8(ch));
+        for (uint32 hit = m_nodes[node].word >= 0 ? node : m_nodes[node].output; hit; hit = m_nodes[hit].output)
+            words.push_back(m_nodes[hit].word);
+    }
+
+    // a word found several times only counts once, as with std::string::find
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
+AntispamMatcher::Result AntispamMatcher::Match(std::string const& normalized, std::string const& original) const
+{
+    Result result;
+
+    if (m_words.size())
+    {
+        std::vector<uint32> words;
+        std::string const* texts[TEXT_MAX] = { &normalized, &original };
+        for (uint32 text = 0; text < TEXT_MAX; ++text)
+        {
+            CollectWords(*texts[text], words);
+            for (uint32 index : words)
+            {
+                Word const& word = m_words[index];
+                if (word.blacklisted && !result.blacklistedWord)
+                    result.blacklistedWord = &word.word;
+                result.score += word.scores[text];
+            }
+        }
+    }
+
+    if (m_regexSet)
+    {
+        std::vector<int> matches;
+        if (m_regexSet->Match(original, &matches) || m_regexSet->Match(normalized, &matches))
+            result.blacklistedRegex = &m_regexes[*std::min_element(matches.begin(), matches.end())];
+    }
+
+    return result;
+}
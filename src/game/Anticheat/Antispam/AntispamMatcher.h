@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "re2/set.h"
+
+/// Every blacklisted word, scored word and blacklisted regex of the antispam, compiled so that
+/// a message is scanned once whatever the size of the lists: the literal words share one
+/// Aho-Corasick automaton and the regexes one RE2::Set. Immutable once built, a new matcher
+/// is built and swapped in whenever the lists change.
+class AntispamMatcher
+{
+    public:
+        enum Text
+        {
+            TEXT_NORMALIZED,
+            TEXT_ORIGINAL,
+            TEXT_MAX
+        };
+
+        struct Result
+        {
+            std::string const* blacklistedWord = nullptr;
+            std::string const* blacklistedRegex = nullptr;
+            int32 score = 0;
+        };
+
+        AntispamMatcher();
+
+        // must all be added before Compile()
+        void AddBlacklistWord(std::string const& word);
+        void AddScoreWord(std::string const& word, Text text, int32 score);
+        void AddRegex(std::string const& pattern);
+        void Compile();
+
+        // first blacklisted word and regex found in either text, plus the sum of the word scores
+        Result Match(std::string const& normalized, std::string const& original) const;
+
+        uint32 GetWordsCount() const { return m_words.size(); }
+        uint32 GetRegexCount() const { return m_regexes.size(); }
+
+    private:
+        struct Word
+        {
+            std::string word;
+            bool blacklisted = false;
+            int32 scores[TEXT_MAX] = {};
+        };
+
+        struct Node
+        {
+            std::vector<std::pair<uint8, uint32>> next;     // sorted by byte
+            uint32 fail = 0;
+            int32 word = -1;
+            uint32 output = 0;                              // nearest node on the fail chain ending a word, 0 if none
+        };
+
+        uint32 GetWordIndex(std::string const& word);
+        uint32 FindNext(uint32 node, uint8 c) const;
+        uint32 Step(uint32 node, uint8 c) const;
+        void CollectWords(std::string const& text, std::vector<uint32>& words) const;
+
+        std::vector<Word> m_words;
+        std::vector<Node> m_nodes;
+        std::vector<std::string> m_regexes;
+        std::unique_ptr<re2::RE2::Set> m_regexSet;
+        bool m_compiled;
+};
+
+typedef std::shared_ptr<AntispamMatcher const> AntispamMatcherPtr;
@@ -73,6 +73,9 @@ bool AuctionHouseObject::RemoveAuction(AuctionEntry* entry)
         }
     }
 
+    UnindexAuction(entry);
+    ++ModificationCounter;
+
     if (AuctionsMap.erase(entry->Id) > 0)
     {
         sObjectMgr.FreeAuctionID(entry->Id);
@@ -107,6 +110,168 @@ void AuctionHouseObject::AddAuction(AuctionEntry *ah)
     AuctionsMap[ah->Id] = ah;
     OrderedAuctionMap.emplace(std::pair<uint32, AuctionEntry*>(ah->buyout, ah));
     AccountAuctionMap.emplace(std::pair<uint32, AuctionEntry*>(ah->ownerAccount, ah));
+    IndexAuction(ah);
+    ++ModificationCounter;
+
+    ah->CacheAuctionInfo();
+}
+
+void AuctionHouseObject::UpdateAuction(AuctionEntry* entry)
+{
+    // bids do not change which listings the auction is part of, only its info
+    entry->CacheAuctionInfo();
+}
+
+void AuctionHouseObject::IndexAuction(AuctionEntry* entry)
+{
+    if (ItemPrototype const* proto = sObjectMgr.GetItemPrototype(entry->itemTemplate))
+    {
+        CategoryIndex[GetCategoryKey(proto->Class, proto->SubClass, proto->InventoryType)].insert(entry);
+        QualityIndex[proto->Quality].insert(entry);
+        LevelIndex[proto->RequiredLevel].insert(entry);
+    }
+
+    for (const auto& itr : NameIndexes)
+        AddToNameIndex(*itr.second, entry, itr.first.first, itr.first.second);
+}
+
+void AuctionHouseObject::UnindexAuction(AuctionEntry* entry)
+{
+    // the item may already be gone, everything is found again from the template
+    if (ItemPrototype const* proto = sObjectMgr.GetItemPrototype(entry->itemTemplate))
+    {
+        auto removeFrom = [entry](AuctionIndex& index, uint32 key)
+        {
+            auto itr = index.find(key);
+            if (itr == index.end())
+                return;
+
+            itr->second.erase(entry);
+            if (itr->second.empty())
+                index.erase(itr);
+        };
+
+        removeFrom(CategoryIndex, GetCategoryKey(proto->Class, proto->SubClass, proto->InventoryType));
+        removeFrom(QualityIndex, proto->Quality);
+        removeFrom(LevelIndex, proto->RequiredLevel);
+    }
+
+    for (const auto& itr : NameIndexes)
+        RemoveFromNameIndex(*itr.second, entry);
+}
+
+bool AuctionHouseObject::BuildSearchName(std::wstring& wname, AuctionEntry const* entry, int locIdx, LocaleConstant dbcLoc)
+{
+    ItemPrototype const* proto = sObjectMgr.GetItemPrototype(entry->itemTemplate);
+    if (!proto || proto->Name1.empty())
+        return false;
+
+    std::string name = proto->Name1;
+
+    const ItemRandomPropertiesEntry* randomProperty = nullptr;
+    if (Item* item = sAuctionMgr.GetAItem(entry->itemGuidLow))
+    {
+        int32 propertyId = item->GetItemRandomPropertyId();
+        if (propertyId > 0)
+            randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(propertyId));
+    }
+
+    Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, locIdx, dbcLoc);
+
+    if (!Utf8toWStr(name, wname))
+        return false;
+
+    wstrToLower(wname);
+    return true;
+}
+
+void AuctionHouseObject::AddToNameIndex(AuctionNameIndex& index, AuctionEntry* entry, int locIdx, LocaleConstant dbcLoc)
+{
+    std::wstring name;
+    if (!BuildSearchName(name, entry, locIdx, dbcLoc))
+        return;
+
+    auto result = index.names.emplace(std::move(name), AuctionSet());
+    AuctionNameIndex::NameEntry* nameEntry = &*result.first;
+
+    // a new name, index its fragments
+    if (result.second)
+        for (size_t i = 0; i + 3 <= nameEntry->first.size(); ++i)
+            index.trigrams[GetTrigram(nameEntry->first, i)].insert(nameEntry);
+
+    nameEntry->second.insert(entry);
+    index.auctionNames[entry->Id] = nameEntry;
+}
+
+void AuctionHouseObject::RemoveFromNameIndex(AuctionNameIndex& index, AuctionEntry* entry)
+{
+    auto itr = index.auctionNames.find(entry->Id);
+    if (itr == index.auctionNames.end())
+        return;
+
+    AuctionNameIndex::NameEntry* nameEntry = itr->second;
+    index.auctionNames.erase(itr);
+
+    nameEntry->second.erase(entry);
+    if (!nameEntry->second.empty())
+        return;
+
+    // last auction with this name
+    for (size_t i = 0; i + 3 <= nameEntry->first.size(); ++i)
+    {
+        auto trigram = index.trigrams.find(GetTrigram(nameEntry->first, i));
+        if (trigram == index.trigrams.end())
+            continue;
+
+        trigram->second.erase(nameEntry);
+        if (trigram->second.empty())
+            index.trigrams.erase(trigram);
+    }
+
+    index.names.erase(index.names.find(nameEntry->first));
+}
+
+AuctionHouseObject::AuctionNameIndex const& AuctionHouseObject::GetNameIndex(int locIdx, LocaleConstant dbcLoc)
+{
+    std::lock_guard<std::mutex> guard(NameIndexesLock);
+
+    std::unique_ptr<AuctionNameIndex>& index = NameIndexes[std::make_pair(locIdx, dbcLoc)];
+    if (!index)
+    {
+        index.reset(new AuctionNameIndex);
+        for (const auto& itr : AuctionsMap)
+            AddToNameIndex(*index, itr.second, locIdx, dbcLoc);
+    }
+
+    return *index;
+}
+
+void AuctionHouseObject::FindNames(AuctionNameIndex const& index, std::wstring const& search, AuctionSetList& sets)
+{
+    // too short for a trigram, still only the distinct names are checked
+    if (search.size() < 3)
+    {
+        for (const auto& itr : index.names)
+            if (itr.first.find(search) != std::wstring::npos)
+                sets.push_back(&itr.second);
+        return;
+    }
+
+    // the rarest fragment of the search leaves the fewest names to check
+    std::unordered_set<AuctionNameIndex::NameEntry*> const* candidates = nullptr;
+    for (size_t i = 0; i + 3 <= search.size(); ++i)
+    {
+        auto itr = index.trigrams.find(GetTrigram(search, i));
+        if (itr == index.trigrams.end())
+            return;
+
+        if (!candidates || itr->second.size() < candidates->size())
+            candidates = &itr->second;
+    }
+
+    for (const auto nameEntry : *candidates)
+        if (nameEntry->first.find(search) != std::wstring::npos)
+            sets.push_back(&nameEntry->second);
 }
 
 AuctionHouseMgr::AuctionHouseMgr()
@@ -792,79 +957,234 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
     int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
     LocaleConstant dbc_loc = player->GetSession()->GetSessionDbcLocale();
 
-    // Micro opt on name/suffix initialization
-    std::string name;
-    name.reserve(140);
+    std::shared_ptr<AuctionList const> auctions = GetMatchingAuctions(query, loc_idx, dbc_loc);
 
-    for (const auto& itr : OrderedAuctionMap)
+    // the per player filters are left for this pass
+    for (const auto auctionEntry : *auctions)
     {
-        AuctionEntry* auctionEntry = itr.second;
-        Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
-        if (!item)
+        if (query.usable != 0x00)
+        {
+            Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
+            if (!item || player->CanUseItem(item) != EQUIP_ERR_OK)
+                continue;
+
+            ItemPrototype const *proto = item->GetProto();
+            if (proto->Class == ITEM_CLASS_RECIPE)
+                if (SpellEntry const* spell = sSpellMgr.GetSpellEntry(proto->Spells[0].SpellId))
+                    if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
+                        continue;
+        }
+
+        // IP locked auction
+        if (!auctionEntry->IsAvailableFor(player))
             continue;
 
+        if (count < 50 && totalcount >= query.listfrom)
         {
-            ItemPrototype const *proto = item->GetProto();
+            ++count;
+            auctionEntry->BuildAuctionInfo(data);
+        }
 
-            if (query.auctionMainCategory != 0xffffffff && proto->Class != query.auctionMainCategory)
-                continue;
+        ++totalcount;
+    }
+}
 
-            if (query.auctionSubCategory != 0xffffffff && proto->SubClass != query.auctionSubCategory)
-                continue;
+std::shared_ptr<AuctionHouseObject::AuctionList const> AuctionHouseObject::GetMatchingAuctions(AuctionHouseClientQuery const& query, int locIdx, LocaleConstant dbcLoc)
+{
+    // usable is left out, it depends on the player
+    AuctionListKey key;
+    key.mainCategory = query.auctionMainCategory;
+    key.subCategory = query.auctionSubCategory;
+    key.slot = query.auctionSlotID;
+    key.quality = query.quality;
+    key.levelMin = query.levelmin;
+    key.levelMax = query.levelmin != 0x00 ? query.levelmax : 0x00;
+    key.locIdx = query.wsearchedname.empty() ? 0 : locIdx;
+    key.dbcLoc = query.wsearchedname.empty() ? LOCALE_enUS : dbcLoc;
+    key.name = query.wsearchedname;
 
-            if (query.auctionSlotID != 0xffffffff && proto->InventoryType != query.auctionSlotID &&
-                    (query.auctionSlotID != INVTYPE_CHEST || (query.auctionSlotID == INVTYPE_CHEST && proto->InventoryType != INVTYPE_ROBE)))
-                continue;
+    {
+        std::lock_guard<std::mutex> guard(ListCacheLock);
+        auto itr = ListCache.find(key);
+        if (itr != ListCache.end() && itr->second.version == ModificationCounter)
+            return itr->second.auctions;
+    }
 
-            if (query.quality != 0xffffffff && proto->Quality < query.quality)
-                continue;
+    std::shared_ptr<AuctionList> auctions = std::make_shared<AuctionList>();
+    FindAuctions(query, locIdx, dbcLoc, *auctions);
 
-            if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
+    std::lock_guard<std::mutex> guard(ListCacheLock);
+    if (ListCache.size() >= AUCTION_LIST_CACHE_SIZE)
+    {
+        for (auto itr = ListCache.begin(); itr != ListCache.end();)
+        {
+            if (itr->second.version != ModificationCounter)
+                itr = ListCache.erase(itr);
+            else
+                ++itr;
+        }
+
+        if (ListCache.size() >= AUCTION_LIST_CACHE_SIZE)
+            ListCache.clear();
+    }
+
+    AuctionListCacheEntry& entry = ListCache[key];
+    entry.version = ModificationCounter;
+    entry.auctions = auctions;
+    return auctions;
+}
+
+void AuctionHouseObject::FindAuctions(AuctionHouseClientQuery const& query, int locIdx, LocaleConstant dbcLoc, AuctionList& auctions)
+{
+    AuctionNameIndex const* nameIndex = query.wsearchedname.empty() ? nullptr : &GetNameIndex(locIdx, dbcLoc);
+
+    // Only the index buckets of the most selective filter are scanned, the other filters are checked per auction
+    AuctionSetList bestSets;
+    size_t bestCount = 0;
+    bool indexed = false;
+    auto consider = [&](AuctionSetList& sets)
+    {
+        size_t count = 0;
+        for (const auto set : sets)
+            count += set->size();
+
+        if (!indexed || count < bestCount)
+        {
+            bestSets.swap(sets);
+            bestCount = count;
+            indexed = true;
+        }
+    };
+
+    AuctionSetList sets;
+    if (query.auctionMainCategory != 0xffffffff || query.auctionSubCategory != 0xffffffff || query.auctionSlotID != 0xffffffff)
+    {
+        auto itr = CategoryIndex.begin();
+        auto end = CategoryIndex.end();
+        if (query.auctionMainCategory != 0xffffffff)
+        {
+            if (query.auctionMainCategory <= 0xFF)
+            {
+                itr = CategoryIndex.lower_bound(GetCategoryKey(query.auctionMainCategory, 0, 0));
+                end = CategoryIndex.lower_bound(GetCategoryKey(query.auctionMainCategory + 1, 0, 0));
+            }
+            else
+                itr = end;                                  // no such item class
+        }
+
+        for (; itr != end; ++itr)
+        {
+            uint32 subClass = (itr->first >> 8) & 0xFF;
+            uint32 inventoryType = itr->first & 0xFF;
+
+            if (query.auctionSubCategory != 0xffffffff && subClass != query.auctionSubCategory)
                 continue;
 
-            if (query.usable != 0x00 && player->CanUseItem(item) != EQUIP_ERR_OK)
+            if (query.auctionSlotID != 0xffffffff && inventoryType != query.auctionSlotID &&
+                    (query.auctionSlotID != INVTYPE_CHEST || inventoryType != INVTYPE_ROBE))
                 continue;
 
-            if (query.usable != 0x00 && proto->Class == ITEM_CLASS_RECIPE)
-                if (SpellEntry const* spell = sSpellMgr.GetSpellEntry(proto->Spells[0].SpellId))
-                    if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
-                        continue;
+            sets.push_back(&itr->second);
+        }
+        consider(sets);
+    }
 
-            // IP locked auction
-            if (!auctionEntry->IsAvailableFor(player))
-                continue;
+    if (query.quality != 0xffffffff)
+    {
+        sets.clear();
+        for (auto itr = QualityIndex.lower_bound(query.quality); itr != QualityIndex.end(); ++itr)
+            sets.push_back(&itr->second);
+        consider(sets);
+    }
 
-            if (!query.wsearchedname.empty())
-            {
-                name = proto->Name1;
-                if (name.empty())
-                    continue;
+    if (query.levelmin != 0x00)
+    {
+        sets.clear();
+        auto end = query.levelmax != 0x00 ? LevelIndex.upper_bound(query.levelmax) : LevelIndex.end();
+        for (auto itr = LevelIndex.lower_bound(query.levelmin); itr != end; ++itr)
+            sets.push_back(&itr->second);
+        consider(sets);
+    }
+
+    if (nameIndex)
+    {
+        sets.clear();
+        FindNames(*nameIndex, query.wsearchedname, sets);
+        consider(sets);
+    }
 
-                int32 propertyId = item->GetItemRandomPropertyId();
-                const ItemRandomPropertiesEntry* randomProperty = nullptr;
-                if (propertyId > 0)
-                     randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(propertyId));
+    auto matchAuction = [&](AuctionEntry* auctionEntry)
+    {
+        Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
+        if (!item)
+            return;
 
-                Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, loc_idx, dbc_loc);
+        ItemPrototype const *proto = item->GetProto();
 
-                if (!Utf8FitTo(name, query.wsearchedname))
-                    continue;
-            }
+        if (query.auctionMainCategory != 0xffffffff && proto->Class != query.auctionMainCategory)
+            return;
 
-            if (count < 50 && totalcount >= query.listfrom)
-            {
-                ++count;
-                auctionEntry->BuildAuctionInfo(data);
-            }
+        if (query.auctionSubCategory != 0xffffffff && proto->SubClass != query.auctionSubCategory)
+            return;
+
+        if (query.auctionSlotID != 0xffffffff && proto->InventoryType != query.auctionSlotID &&
+                (query.auctionSlotID != INVTYPE_CHEST || (query.auctionSlotID == INVTYPE_CHEST && proto->InventoryType != INVTYPE_ROBE)))
+            return;
+
+        if (query.quality != 0xffffffff && proto->Quality < query.quality)
+            return;
+
+        if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
+            return;
+
+        // names are precomputed, lowercased and with their suffix, by the name index
+        if (nameIndex)
+        {
+            auto name = nameIndex->auctionNames.find(auctionEntry->Id);
+            if (name == nameIndex->auctionNames.end() || name->second->first.find(query.wsearchedname) == std::wstring::npos)
+                return;
         }
 
-        ++totalcount;
+        auctions.push_back(auctionEntry);
+    };
+
+    // only per player filters are set, nothing to narrow down with
+    if (!indexed)
+    {
+        for (const auto& itr : OrderedAuctionMap)
+            matchAuction(itr.second);
+        return;
+    }
+
+    if (bestSets.size() == 1)
+    {
+        for (const auto auctionEntry : *bestSets.front())
+            matchAuction(auctionEntry);
+        return;
     }
+
+    // several buckets, put them back in buyout order
+    std::vector<AuctionEntry*> candidates;
+    candidates.reserve(bestCount);
+    for (const auto set : bestSets)
+        candidates.insert(candidates.end(), set->begin(), set->end());
+    std::sort(candidates.begin(), candidates.end(), AuctionBuyoutOrder());
+
+    for (const auto auctionEntry : candidates)
+        matchAuction(auctionEntry);
 }
 
 // this function inserts to WorldPacket auction's data
 bool AuctionEntry::BuildAuctionInfo(WorldPacket & data) const
 {
+    if (!auctionInfo.empty())
+    {
+        size_t pos = data.wpos();
+        data.append(auctionInfo);
+        data.put<uint32>(pos + AUCTION_INFO_TIME_LEFT_OFFSET, uint32((expireTime - time(nullptr))*IN_MILLISECONDS));
+        return true;
+    }
+
     Item *pItem = sAuctionMgr.GetAItem(itemGuidLow);
     if (!pItem)
     {
@@ -896,6 +1216,15 @@ bool AuctionEntry::BuildAuctionInfo(WorldPacket & data) const
     return true;
 }
 
+void AuctionEntry::CacheAuctionInfo()
+{
+    auctionInfo.clear();
+
+    WorldPacket data;
+    if (BuildAuctionInfo(data))
+        auctionInfo.assign(data.contents(), data.contents() + data.wpos());
+}
+
 uint32 AuctionEntry::GetAuctionCut() const
 {
     return uint32(auctionHouseEntry->cutPercent * bid * sWorld.getConfig(CONFIG_FLOAT_RATE_AUCTION_CUT) / 100.0f);
@@ -24,6 +24,10 @@
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_set>
 
 #include "Common.h"
 #include "SharedDefines.h"
@@ -35,8 +39,11 @@ class Item;
 class Player;
 class Unit;
 class WorldPacket;
+struct ItemPrototype;
 
 #define MIN_AUCTION_TIME (2*HOUR)
+#define AUCTION_INFO_TIME_LEFT_OFFSET (7 * 4 + 8 + 3 * 4)   // in the BuildAuctionInfo bytes
+#define AUCTION_LIST_CACHE_SIZE 512                         // cached listings per auction house
 
 enum AuctionError
 {
@@ -81,6 +88,7 @@ struct AuctionEntry
     uint32 bidder;
     uint32 deposit;                                         // deposit can be calculated only when creating auction
     AuctionHouseEntry const* auctionHouseEntry;             // in AuctionHouse.dbc
+    std::vector<uint8> auctionInfo;                         // BuildAuctionInfo bytes, time left is filled in on use
 
     // helpers
     uint32 GetHouseId() const { return auctionHouseEntry->houseId; }
@@ -88,6 +96,7 @@ struct AuctionEntry
     uint32 GetAuctionCut() const;
     uint32 GetAuctionOutBid() const;
     bool BuildAuctionInfo(WorldPacket & data) const;
+    void CacheAuctionInfo();
     void DeleteFromDB() const;
     void SaveToDB() const;
     bool IsAvailableFor(Player* player);
@@ -109,7 +118,7 @@ struct AuctionHouseClientQuery
 class AuctionHouseObject
 {
     public:
-        AuctionHouseObject() {}
+        AuctionHouseObject() : ModificationCounter(0) {}
         ~AuctionHouseObject()
         {
             for (const auto& itr : AuctionsMap)
@@ -132,6 +141,8 @@ class AuctionHouseObject
         }
 
         bool RemoveAuction(AuctionEntry* entry);
+        // to be called when the bid of an auction changed
+        void UpdateAuction(AuctionEntry* entry);
 
         void RemoveAllAuctions(Player* player);
 
@@ -144,12 +155,94 @@ class AuctionHouseObject
             uint32& count, uint32& totalcount);
         uint32 GetAccountAuctionCount(uint32 accountId) { return AccountAuctionMap.count(accountId); }
     private:
+        // Same order as OrderedAuctionMap, so any index bucket can be listed as is
+        struct AuctionBuyoutOrder
+        {
+            bool operator()(AuctionEntry const* a, AuctionEntry const* b) const
+            {
+                return a->buyout != b->buyout ? a->buyout < b->buyout : a->Id < b->Id;
+            }
+        };
+        typedef std::set<AuctionEntry*, AuctionBuyoutOrder> AuctionSet;
+        typedef std::map<uint32, AuctionSet> AuctionIndex;
+        typedef std::vector<AuctionSet const*> AuctionSetList;
+
+        // Lowercased localized names (random suffix included) of the auctions for one
+        // client locale, with a trigram index from name fragments to the names containing them
+        struct AuctionNameIndex
+        {
+            typedef std::unordered_map<std::wstring, AuctionSet> NameMap;
+            typedef NameMap::value_type NameEntry;
+
+            NameMap names;
+            std::unordered_map<uint32, NameEntry*> auctionNames;
+            std::unordered_map<uint64, std::unordered_set<NameEntry*>> trigrams;
+        };
+        typedef std::map<std::pair<int, LocaleConstant>, std::unique_ptr<AuctionNameIndex>> AuctionNameIndexMap;
+
+        // A listing query without its per player filters (usable, IP lock)
+        struct AuctionListKey
+        {
+            uint32 mainCategory, subCategory, slot, quality;
+            uint8 levelMin, levelMax;
+            int locIdx;
+            LocaleConstant dbcLoc;
+            std::wstring name;
+
+            bool operator<(AuctionListKey const& other) const
+            {
+                return std::tie(mainCategory, subCategory, slot, quality, levelMin, levelMax, locIdx, dbcLoc, name) <
+                    std::tie(other.mainCategory, other.subCategory, other.slot, other.quality, other.levelMin, other.levelMax, other.locIdx, other.dbcLoc, other.name);
+            }
+        };
+        typedef std::vector<AuctionEntry*> AuctionList;
+        struct AuctionListCacheEntry
+        {
+            uint32 version;                                 // ModificationCounter the list was built at
+            std::shared_ptr<AuctionList const> auctions;
+        };
+
+        // (class, subclass, inventory type) of an item, class in the high bits
+        static uint32 GetCategoryKey(uint32 itemClass, uint32 subClass, uint32 inventoryType)
+        {
+            return (itemClass << 16) | ((subClass & 0xFF) << 8) | (inventoryType & 0xFF);
+        }
+        static uint64 GetTrigram(std::wstring const& str, size_t pos)
+        {
+            return (uint64(str[pos] & 0x1FFFFF) << 42) | (uint64(str[pos + 1] & 0x1FFFFF) << 21) | uint64(str[pos + 2] & 0x1FFFFF);
+        }
+        static bool BuildSearchName(std::wstring& wname, AuctionEntry const* entry, int locIdx, LocaleConstant dbcLoc);
+
+        void IndexAuction(AuctionEntry* entry);
+        void UnindexAuction(AuctionEntry* entry);
+        static void AddToNameIndex(AuctionNameIndex& index, AuctionEntry* entry, int locIdx, LocaleConstant dbcLoc);
+        static void RemoveFromNameIndex(AuctionNameIndex& index, AuctionEntry* entry);
+        // built on the first name search of a locale, then kept up to date with the auctions
+        AuctionNameIndex const& GetNameIndex(int locIdx, LocaleConstant dbcLoc);
+        static void FindNames(AuctionNameIndex const& index, std::wstring const& search, AuctionSetList& sets);
+
+        // auctions matching the query in buyout order, shared by identical queries until an auction is added or removed
+        std::shared_ptr<AuctionList const> GetMatchingAuctions(AuctionHouseClientQuery const& query, int locIdx, LocaleConstant dbcLoc);
+        void FindAuctions(AuctionHouseClientQuery const& query, int locIdx, LocaleConstant dbcLoc, AuctionList& auctions);
+
         // Map BUYOUT prices to entry for pre-sorted results. We maintain it in
         // a map rather than build the list on query for performance reasons.
         // Similarly, maintain a map of account ID -> auction entry
         AuctionMultiMap OrderedAuctionMap;
         AuctionMultiMap AccountAuctionMap;
         AuctionEntryMap AuctionsMap;
+
+        // Secondary indexes for filtered listings, only modified from the world thread
+        // while listings run from the async tasks
+        AuctionIndex CategoryIndex;                         // GetCategoryKey -> auctions
+        AuctionIndex QualityIndex;                          // quality -> auctions
+        AuctionIndex LevelIndex;                            // required level -> auctions
+        AuctionNameIndexMap NameIndexes;
+        std::mutex NameIndexesLock;                         // only guards the lazy creation
+
+        uint32 ModificationCounter;                         // bumped by every added or removed auction
+        std::map<AuctionListKey, AuctionListCacheEntry> ListCache;
+        std::mutex ListCacheLock;
 };
 
 class AuctionHouseMgr
@@ -58,6 +58,10 @@ BattleGroundQueue::BattleGroundQueue()
                 m_WaitTimes[i][j][k] = 0;
         }
     }
+
+    for (auto& bracket : m_WaitingPlayers)
+        for (uint32& count : bracket)
+            count = 0;
 }
 
 BattleGroundQueue::~BattleGroundQueue()
@@ -73,6 +77,14 @@ BattleGroundQueue::~BattleGroundQueue()
             group[j].clear();
         }
     }
+
+    for (auto& invitedGroups : m_InvitedGroups)
+    {
+        for (GroupQueueInfo* ginfo : invitedGroups)
+            delete ginfo;
+
+        invitedGroups.clear();
+    }
 }
 
 /*********************************************************/
@@ -160,6 +172,24 @@ bool BattleGroundQueue::SelectionPool::AddGroup(GroupQueueInfo *ginfo, uint32 de
 /***               BATTLEGROUND QUEUES                 ***/
 /*********************************************************/
 
+void BattleGroundQueue::AddWaitingGroup(GroupQueueInfo* ginfo, uint32 queueType)
+{
+    ginfo->QueueType = queueType;
+    m_QueuedGroups[ginfo->BracketId][queueType].push_back(ginfo);
+    m_WaitingPlayers[ginfo->BracketId][queueType] += ginfo->Players.size();
+}
+
+void BattleGroundQueue::RemoveWaitingGroup(GroupQueueInfo* ginfo)
+{
+    GroupsQueueType& groups = m_QueuedGroups[ginfo->BracketId][ginfo->QueueType];
+    GroupsQueueType::iterator itr = std::find(groups.begin(), groups.end(), ginfo);
+    if (itr == groups.end())
+        return;
+
+    groups.erase(itr);
+    m_WaitingPlayers[ginfo->BracketId][ginfo->QueueType] -= ginfo->Players.size();
+}
+
 // add group or player (grp == nullptr) to bg queue with the given leader and bg specifications
 GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleGroundTypeId BgTypeId, BattleGroundBracketId bracketId, bool isPremade, uint32 instanceId, std::vector<uint32>* excludedMembers)
 {
@@ -172,6 +202,7 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
     ginfo->GroupTeam                 = leader->GetTeam();
     ginfo->BracketId                 = bracketId;
     ginfo->DesiredInstanceId         = instanceId;
+    ginfo->QueueType                 = 0;
     ginfo->Players.clear();
 
     //compute index (if group is premade or joined a rated match) to queues
@@ -235,7 +266,7 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
 
         //add GroupInfo to m_QueuedGroups
         if (!ginfo->Players.empty())
-            m_QueuedGroups[bracketId][index].push_back(ginfo);
+            AddWaitingGroup(ginfo, index);
         else
             return ginfo; // group size was above limit
 
@@ -247,17 +278,10 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
             {
                 char const* bgName = bg->GetName();
                 uint32 MinPlayers = bg->GetMinPlayersPerTeam();
-                uint32 qHorde = 0;
-                uint32 qAlliance = 0;
+                uint32 qHorde = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_HORDE];
+                uint32 qAlliance = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_ALLIANCE];
                 uint32 q_min_level = leader->GetMinLevelForBattleGroundBracketId(bracketId, BgTypeId);
                 uint32 q_max_level = leader->GetMaxLevelForBattleGroundBracketId(bracketId, BgTypeId);
-                GroupsQueueType::const_iterator itr;
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        qAlliance += (*itr)->Players.size();
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        qHorde += (*itr)->Players.size();
 
                 // Show queue status to player only (when joining queue)
                 if (sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_QUEUE_ANNOUNCER_JOIN) == 1)
@@ -336,7 +360,6 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     //Player *plr = sObjectMgr.GetPlayer(guid);
     //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
 
-    int32 bracket_id = -1;                                     // signed for proper for-loop finish
     QueuedPlayersMap::iterator itr;
 
     //remove player from map, if he's there
@@ -348,33 +371,7 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     }
 
     GroupQueueInfo* group = itr->second.GroupInfo;
-    GroupsQueueType::iterator group_itr, group_itr_tmp;
-    // mostly people with the highest levels are in battlegrounds, thats why
-    // we count from MAX_BATTLEGROUND_QUEUES - 1 to 0
-    // variable index removes useless searching in other team's queue
-    uint32 index = BattleGround::GetTeamIndexByTeamId(group->GroupTeam);
 
-    for (int32 bracket_id_tmp = MAX_BATTLEGROUND_BRACKETS - 1; bracket_id_tmp >= 0 && bracket_id == -1; --bracket_id_tmp)
-    {
-        //we must check premade and normal team's queue - because when players from premade are joining bg,
-        //they leave groupinfo so we can't use its players size to find out index
-        for (uint32 j = index; j < BG_QUEUE_GROUP_TYPES_COUNT; j += BG_QUEUE_NORMAL_ALLIANCE)
-        {
-            for (group_itr_tmp = m_QueuedGroups[bracket_id_tmp][j].begin(); group_itr_tmp != m_QueuedGroups[bracket_id_tmp][j].end(); ++group_itr_tmp)
-            {
-                if ((*group_itr_tmp) == group)
-                {
-                    bracket_id = bracket_id_tmp;
-                    group_itr = group_itr_tmp;
-                    //we must store index to be able to erase iterator
-                    index = j;
-                    break;
-                }
-            }
-        }
-    }
-
-    // ALL variables are correctly set
     // We can ignore leveling up in queue - it should not cause crash
     // remove player from group
     // if only one player there, remove group
@@ -382,7 +379,11 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     // remove player queue info from group queue info
     GroupQueueInfoPlayers::iterator pitr = group->Players.find(guid);
     if (pitr != group->Players.end())
+    {
         group->Players.erase(pitr);
+        if (!group->IsInvitedToBGInstanceGUID)
+            --m_WaitingPlayers[group->BracketId][group->QueueType];
+    }
 
     // if invited to bg, and should decrease invited count, then do it
     if (decreaseInvitedCount && group->IsInvitedToBGInstanceGUID)
@@ -394,19 +395,25 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
 
     // remove player queue info
     m_QueuedPlayers.erase(itr);
+    m_OfflinePlayers.erase(guid);
 
-    //player can't be in queue without group, but just in case
-    if (bracket_id == -1)
-    {
-        sLog.outError("BattleGroundQueue: ERROR Cannot find groupinfo for %s", guid.GetString().c_str());
-        return;
-    }
-    DEBUG_LOG("BattleGroundQueue: Removing %s, from bracket_id %u", guid.GetString().c_str(), (uint32)bracket_id);
+    DEBUG_LOG("BattleGroundQueue: Removing %s, from bracket_id %u", guid.GetString().c_str(), (uint32)group->BracketId);
 
     // remove group queue info if needed
     if (group->Players.empty())
     {
-        m_QueuedGroups[bracket_id][index].erase(group_itr);
+        // the group is either waiting in its queue type or invited
+        GroupsQueueType& groups = group->IsInvitedToBGInstanceGUID ? m_InvitedGroups[group->BracketId] : m_QueuedGroups[group->BracketId][group->QueueType];
+        GroupsQueueType::iterator group_itr = std::find(groups.begin(), groups.end(), group);
+
+        //player can't be in queue without group, but just in case
+        if (group_itr == groups.end())
+        {
+            sLog.outError("BattleGroundQueue: ERROR Cannot find groupinfo for %s", guid.GetString().c_str());
+            return;
+        }
+
+        groups.erase(group_itr);
         delete group;
     }
 }
@@ -439,7 +446,10 @@ bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * b
 
     if (!ginfo->IsInvitedToBGInstanceGUID)
     {
-        // not yet invited
+        // not yet invited, the group leaves the waiting queues
+        RemoveWaitingGroup(ginfo);
+        m_InvitedGroups[ginfo->BracketId].push_back(ginfo);
+
         // set invitation
         ginfo->IsInvitedToBGInstanceGUID = bg->GetInstanceID();
         BattleGroundTypeId bgTypeId = bg->GetTypeID();
@@ -610,8 +620,15 @@ void BattleGroundQueue::FillPlayersToBG(BattleGround* bg, BattleGroundBracketId
 // it tries to invite as much players as it can - to MaxPlayersPerTeam, because premade groups have more than MinPlayersPerTeam players
 bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint32 MinPlayersPerTeam, uint32 MaxPlayersPerTeam)
 {
+    // the pools can only be filled when both teams have enough waiting players
+    bool enoughPlayers = true;
+    if (!sBattleGroundMgr.isTesting())
+        for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
+            if (m_WaitingPlayers[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i] + m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i] < MinPlayersPerTeam)
+                enoughPlayers = false;
+
     GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
-    for (uint32 queueType = 0; queueType < 2; ++queueType)
+    for (uint32 queueType = 0; queueType < 2 && enoughPlayers; ++queueType)
         for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
         {
             itr_team[i] = m_QueuedGroups[bracket_id][2*queueType + i].begin();
@@ -643,12 +660,12 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
     {
         if (!m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].empty())
         {
-            GroupsQueueType::iterator itr = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].begin();
-            if (!(*itr)->IsInvitedToBGInstanceGUID && ((*itr)->JoinTime < time_before || (*itr)->Players.size() < MinPlayersPerTeam))
+            GroupQueueInfo* ginfo = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].front();
+            if (ginfo->JoinTime < time_before || ginfo->Players.size() < MinPlayersPerTeam)
             {
                 //we must insert group to normal queue and erase pointer from premade queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].push_back((*itr));
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].erase(itr);
+                RemoveWaitingGroup(ginfo);
+                AddWaitingGroup(ginfo, BG_QUEUE_NORMAL_ALLIANCE + i);
             }
         }
     }
@@ -659,6 +676,12 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
 // this method tries to create battleground with MinPlayersPerTeam against MinPlayersPerTeam
 bool BattleGroundQueue::CheckNormalMatch(BattleGroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
 {
+    // the pools may still hold groups selected by CheckPremadeMatch
+    if (!sBattleGroundMgr.isTesting())
+        for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
+            if (m_SelectionPools[i].GetPlayerCount() + m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i] < minPlayers)
+                return false;
+
     GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
     for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
     {
@@ -710,29 +733,46 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
     //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
 
     // First, remove players who shouldn't be in queue anymore
-    QueuedPlayersMap::iterator itrOffline = m_QueuedPlayers.begin();
-    while (itrOffline != m_QueuedPlayers.end())
+    for (std::set<ObjectGuid>::const_iterator itr = m_OfflinePlayers.begin(); itr != m_OfflinePlayers.end();)
     {
+        // RemovePlayer erases the guid from the set
+        ObjectGuid guid = *itr++;
+
         // remove offline players
-        if (!itrOffline->second.online && WorldTimer::getMSTimeDiffToNow(itrOffline->second.LastOnlineTime) > OFFLINE_BG_QUEUE_TIME)
-        {
-            RemovePlayer(itrOffline->first, true);
-            itrOffline = m_QueuedPlayers.begin();
-            continue;
-        }
+        QueuedPlayersMap::const_iterator qItr = m_QueuedPlayers.find(guid);
+        if (qItr == m_QueuedPlayers.end())
+            m_OfflinePlayers.erase(guid);
+        else if (!qItr->second.online && WorldTimer::getMSTimeDiffToNow(qItr->second.LastOnlineTime) > OFFLINE_BG_QUEUE_TIME)
+            RemovePlayer(guid, true);
+    }
 
-        // remove players who are in queue for bg that has ended
-        GroupQueueInfo* group = itrOffline->second.GroupInfo;
-        if (group->IsInvitedToBGInstanceGUID)
+    // remove players who are in queue for bg that has ended
+    std::vector<ObjectGuid> removedPlayers;
+    for (GroupsQueueType& invitedGroups : m_InvitedGroups)
+    {
+        for (size_t i = 0; i < invitedGroups.size();)
         {
-            BattleGround* bg;
-            if ((bg = sBattleGroundMgr.GetBattleGround(group->IsInvitedToBGInstanceGUID, group->BgTypeId)) && bg->GetStatus() == STATUS_WAIT_LEAVE)
+            GroupQueueInfo* group = invitedGroups[i];
+            BattleGround* bg = sBattleGroundMgr.GetBattleGround(group->IsInvitedToBGInstanceGUID, group->BgTypeId);
+            if (!bg || bg->GetStatus() != STATUS_WAIT_LEAVE)
             {
-                if (itrOffline->second.online)
+                ++i;
+                continue;
+            }
+
+            removedPlayers.clear();
+            for (auto const& member : group->Players)
+                removedPlayers.push_back(member.first);
+
+            // the group is deleted with its last player
+            for (ObjectGuid const& guid : removedPlayers)
+            {
+                QueuedPlayersMap::const_iterator qItr = m_QueuedPlayers.find(guid);
+                if (qItr != m_QueuedPlayers.end() && qItr->second.online)
                 {
-                    if (Player* player = ObjectAccessor::FindPlayerNotInWorld(itrOffline->first))
+                    if (Player* player = ObjectAccessor::FindPlayerNotInWorld(guid))
                     {
-                        BattleGroundQueueTypeId queueTypeId = BattleGroundMgr::BGQueueTypeId(group->BgTypeId);
+                        BattleGroundQueueTypeId queueTypeId = BattleGroundMgr::BGQueueTypeId(bg->GetTypeID());
                         uint32 queueSlot = player->GetBattleGroundQueueIndex(queueTypeId);
                         if (queueSlot < PLAYER_MAX_BATTLEGROUND_QUEUES)
                         {
@@ -745,13 +785,13 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
                     }
                 }
 
-                RemovePlayer(itrOffline->first, true);
-                itrOffline = m_QueuedPlayers.begin();
-                continue;
+                RemovePlayer(guid, true);
             }
-        }
 
-        ++itrOffline;
+            // just in case the group could not be removed
+            if (i < invitedGroups.size() && invitedGroups[i] == group)
+                ++i;
+        }
     }
 
     // if no players in queue - do nothing
@@ -832,12 +872,7 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
         int minPlayersInQueue = sWorld.getConfig(CONFIG_UINT32_AV_MIN_PLAYERS_IN_QUEUE);
         int playersInQueuePerTeam[BG_TEAMS_COUNT] = {0};
         for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
-        {
-            GroupsQueueType::const_iterator itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin();
-            for (; itr != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
-                if (!(*itr)->IsInvitedToBGInstanceGUID)
-                    playersInQueuePerTeam[i]++; // Only one player, because premades are not allowed in AV.
-        }
+            playersInQueuePerTeam[i] = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].size(); // Only one player, because premades are not allowed in AV.
         if (playersInQueuePerTeam[BG_TEAM_ALLIANCE] < minPlayersInQueue ||
                 playersInQueuePerTeam[BG_TEAM_HORDE] < minPlayersInQueue)
             normalMatchesCreationAttempts = 0;
@@ -1876,6 +1911,7 @@ void BattleGroundQueue::PlayerLoggedOut(ObjectGuid guid)
     }
     itr->second.LastOnlineTime  = WorldTimer::getMSTime();
     itr->second.online          = false;
+    m_OfflinePlayers.insert(guid);
 }
 
 bool BattleGroundQueue::PlayerLoggedIn(Player* player)
@@ -1888,18 +1924,18 @@ bool BattleGroundQueue::PlayerLoggedIn(Player* player)
         return false;
 
     itr->second.online          = true;
+    m_OfflinePlayers.erase(itr->first);
     return true;
 }
 
 bool BattleGroundQueue::IsAllQueuesEmpty(BattleGroundBracketId bracket_id)
 {
-    uint8 queueEmptyCount = 0;
-
-    for (uint8 i = 0; i < BG_QUEUE_MAX; i++)
-        if (m_QueuedGroups[bracket_id][i].empty())
-            queueEmptyCount++;
+    // the invited groups have nothing left to match
+    for (uint8 i = 0; i < BG_QUEUE_GROUP_TYPES_COUNT; i++)
+        if (!m_QueuedGroups[bracket_id][i].empty())
+            return false;
 
-    return queueEmptyCount == BG_QUEUE_MAX;
+    return true;
 }
 
 void BattleGroundMgr::AddBattleGround(uint32 InstanceID, BattleGroundTypeId bgTypeId, BattleGround* BG)
@@ -23,6 +23,7 @@
 #define __BATTLEGROUNDMGR_H
 
 #include <vector>
+#include <set>
 #include <mutex>
 
 #include "Common.h"
@@ -61,6 +62,7 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  IsInvitedToBGInstanceGUID;                      // was invited to certain BG
     uint32  DesiredInstanceId;                              // queued for this instance specifically
     BattleGroundBracketId BracketId;
+    uint8   QueueType;                                      // BG_QUEUE_* waiting list of the group, until invited
 };
 
 enum BattleGroundQueueGroupTypes
@@ -125,6 +127,21 @@ class BattleGroundQueue
         */
         GroupsQueueType m_QueuedGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
 
+        // Only the groups waiting for an invitation are in m_QueuedGroups, in join order. Once
+        // invited they move here until their players enter the battleground or the invitation
+        // expires, so that matching never walks past them.
+        GroupsQueueType m_InvitedGroups[MAX_BATTLEGROUND_BRACKETS];
+
+        // running count of the players in each m_QueuedGroups list, lets Update tell whether
+        // a match is possible without walking the queues
+        uint32 m_WaitingPlayers[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+
+        // queued players that logged out, removed from the queue after OFFLINE_BG_QUEUE_TIME
+        std::set<ObjectGuid> m_OfflinePlayers;
+
+        void AddWaitingGroup(GroupQueueInfo* ginfo, uint32 queueType);
+        void RemoveWaitingGroup(GroupQueueInfo* ginfo);
+
         // class to select and invite groups to bg
         class SelectionPool
         {
@@ -31,7 +31,7 @@
 
 Channel::Channel(std::string const& name, Team InTeam)
     : m_area_dependant(true), m_announce(true), m_moderate(false), m_levelRestricted(true), m_name(name), m_flags(0), m_securityLevel(0), m_channelId(0),
-    m_Team(InTeam)
+    m_Team(InTeam), m_membersVersion(0)
 {
     // TODO: Hackfix to properly identify built-in Chinese channels until/if we add support for multi language DBC
     //  loading.
@@ -150,6 +150,7 @@ void Channel::Join(ObjectGuid guid, const char *password, bool checkPassword)
     PlayerInfo& pinfo = m_players[guid];
     pinfo.player = guid;
     pinfo.flags = MEMBER_FLAG_NONE;
+    ++m_membersVersion;
 
     MakeYouJoined(&data);
     SendToOne(&data, guid);
@@ -192,6 +193,7 @@ void Channel::Leave(ObjectGuid guid, bool send)
     bool changeowner = m_players[guid].IsOwner();
 
     m_players.erase(guid);
+    ++m_membersVersion;
     if (m_announce && (!pPlayer.get() || pPlayer->GetSession()->GetSecurity() < SEC_OBSERVER || !sWorld.getConfig(CONFIG_BOOL_SILENTLY_GM_JOIN_TO_CHANNEL)))
     {
         WorldPacket data;
@@ -272,6 +274,7 @@ void Channel::KickOrBan(ObjectGuid guid, const char *targetName, bool ban)
 
     SendToAll(&data);
     m_players.erase(targetGuid);
+    ++m_membersVersion;
     pTarget->LeftChannel(this);
 
     if (changeowner)
@@ -805,12 +808,61 @@ void Channel::SetOwner(ObjectGuid guid, bool exclaim)
 
 void Channel::SendToAll(WorldPacket *data, ObjectGuid guid)
 {
+    std::shared_ptr<ChannelMemberSessions const> members = GetMemberSessions();
+
+    ChannelMemberMask ignoring;
+    if (guid)
+        BuildIgnoreMask(*members, guid, ignoring);
+
+    sWorld.GetChannelBroadcaster()->Deliver(*members, data, ignoring);
+}
+
+std::atomic<uint32> Channel::ms_sessionsVersion(0);
+
+std::shared_ptr<ChannelMemberSessions const> Channel::GetMemberSessions()
+{
+    std::lock_guard<std::mutex> guard(m_memberSessionsLock);
+
+    // m_players[] adds members without going through Join, the count catches those
+    uint32 const sessionsVersion = ms_sessionsVersion;
+    if (m_memberSessions && m_memberSessions->version == m_membersVersion && m_memberSessions->sessionsVersion == sessionsVersion &&
+        m_memberSessions->membersCount == m_players.size())
+        return m_memberSessions;
+
+    std::shared_ptr<ChannelMemberSessions> members = std::make_shared<ChannelMemberSessions>();
+    members->version = m_membersVersion;
+    members->sessionsVersion = sessionsVersion;
+    members->membersCount = m_players.size();
+    members->sessions.reserve(m_players.size());
+    members->indexes.reserve(m_players.size());
+
     for (const auto& itr : m_players)
     {
-        if (PlayerPointer pPlayer = GetPlayer(itr.first))
-            if (!pPlayer->GetSocial()->HasIgnore(guid))
-                pPlayer->GetSession()->SendPacket(data);
+        PlayerPointer pPlayer = GetPlayer(itr.first);
+        if (!pPlayer)
+            continue;
+
+        members->indexes[itr.first] = members->sessions.size();
+        members->sessions.push_back(pPlayer->GetSession());
     }
+
+    m_memberSessions = members;
+    return m_memberSessions;
+}
+
+void Channel::BuildIgnoreMask(ChannelMemberSessions const& members, ObjectGuid guid, ChannelMemberMask& mask)
+{
+    sSocialMgr.VisitIgnorers(guid, [&members, &mask](ObjectGuid const& ignorerGuid)
+    {
+        auto const itr = members.indexes.find(ignorerGuid);
+        if (itr == members.indexes.end())
+            return;
+
+        if (mask.empty())
+            mask.resize((members.sessions.size() + 63) / 64);
+
+        mask[itr->second / 64] |= uint64(1) << (itr->second % 64);
+    });
 }
 
 void Channel::SendToOne(WorldPacket *data, ObjectGuid who)
@@ -28,9 +28,29 @@
 #include "Opcodes.h"
 #include "MapNodes/AbstractPlayer.h"
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorldSession;
+
+/// Sessions of the channel members at one version of the member list, shared with the delivery threads
+struct ChannelMemberSessions
+{
+    uint32 version;                                         // Channel::m_membersVersion it was built from
+    uint32 sessionsVersion;                                 // Channel::ms_sessionsVersion it was built from
+    uint32 membersCount;                                    // including the members without session
+    std::vector<WorldSession*> sessions;
+    std::unordered_map<ObjectGuid, uint32> indexes;         // member guid -> index in sessions
+};
+
+/// One bit per index in ChannelMemberSessions::sessions, empty when no bit is set
+typedef std::vector<uint64> ChannelMemberMask;
 
 enum ChatNotify
 {
@@ -258,9 +278,17 @@ class Channel
         void MakePlayerInviteBanned(WorldPacket *data, std::string const& name);//? 0x1E
         void MakeThrottled(WorldPacket *data);                                  //? 0x1F
 
+        // skips the members ignoring guid
         void SendToAll(WorldPacket *data, ObjectGuid guid = ObjectGuid());
         void SendToOne(WorldPacket *data, ObjectGuid who);
 
+        // rebuilt on the first message after the member list changed or a player changed session
+        std::shared_ptr<ChannelMemberSessions const> GetMemberSessions();
+        // a relogin hands the online player over to a new session without leaving the channels,
+        // must be called before the old session is deleted
+        static void OnSessionHandoff() { ++ms_sessionsVersion; }
+        static void BuildIgnoreMask(ChannelMemberSessions const& members, ObjectGuid guid, ChannelMemberMask& mask);
+
         bool IsOn(ObjectGuid who) const { return m_players.find(who) != m_players.end(); }
         bool IsBanned(ObjectGuid guid) const { return m_banned.find(guid) != m_banned.end(); }
 
@@ -316,6 +344,10 @@ class Channel
 
         typedef     std::map<ObjectGuid, PlayerInfo> PlayerList;
         PlayerList  m_players;
+        uint32      m_membersVersion;                       // changed when m_players gets or loses a member
+        std::shared_ptr<ChannelMemberSessions const> m_memberSessions;
+        std::mutex  m_memberSessionsLock;
+        static std::atomic<uint32> ms_sessionsVersion;
         typedef     std::set<ObjectGuid> BannedList;
         BannedList  m_banned;
 };
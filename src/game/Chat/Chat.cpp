@@ -683,9 +683,19 @@ ChatCommand * ChatHandler::getCommandTable()
     };
        
 
+    static ChatCommand serverDbStatsCommandTable[] =
+    {
+        { "reset",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDbStatsResetCommand,   "", nullptr },
+        { "slow",           SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDbStatsSlowCommand,    "", nullptr },
+        { "",               SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDbStatsCommand,        "", nullptr },
+        { nullptr,          0,                  false, nullptr,                                         "", nullptr }
+    };
+
     static ChatCommand serverCommandTable[] =
     {
         { "corpses",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerCorpsesCommand,     "", nullptr },
+        { "dbqueues",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDbQueuesCommand,    "", nullptr },
+        { "dbstats",        SEC_ADMINISTRATOR,  true,  nullptr,                                      "", serverDbStatsCommandTable },
         { "exit",           SEC_CONSOLE,        true,  &ChatHandler::HandleServerExitCommand,        "", nullptr },
         { "idlerestart",    SEC_ADMINISTRATOR,  true,  nullptr,                                      "", serverIdleRestartCommandTable },
         { "idleshutdown",   SEC_ADMINISTRATOR,  true,  nullptr,                                      "", serverIdleShutdownCommandTable },
@@ -627,6 +627,10 @@ class ChatHandler
 
 
         bool HandleServerCorpsesCommand(char* args);
+        bool HandleServerDbQueuesCommand(char* args);
+        bool HandleServerDbStatsCommand(char* args);
+        bool HandleServerDbStatsSlowCommand(char* args);
+        bool HandleServerDbStatsResetCommand(char* args);
         bool HandleServerExitCommand(char* args);
         bool HandleServerIdleRestartCommand(char* args);
         bool HandleServerIdleShutDownCommand(char* args);
@@ -95,6 +95,7 @@
 #include "TransmogMgr.h"
 #include "PerfStats.h"
 #include "PerformanceMonitor.h"
+#include "Logging/DatabaseLogger.hpp"
 #include "../scripts/miscellaneous/npc_loothelper.h"
 
 
@@ -6368,6 +6369,12 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
         PSendSysMessage("Remaining HC Threshold hits: %u", sWorld.GetThresholdFlags());
         PSendSysMessage("Current dynamic respawn rate: %f", sWorld.m_dynamicRespawnRatio);
 
+        LatencyHistogram const& loginLoad = sWorld.GetLoginLoadTime();
+        LatencyHistogram const& loginTotal = sWorld.GetLoginTotalTime();
+        if (uint64 logins = loginTotal.Count())
+            PSendSysMessage("Character logins: " UI64FMTD ", loading p50 " UI64FMTD " ms p99 " UI64FMTD " ms, in world p50 " UI64FMTD " ms p99 " UI64FMTD " ms",
+                logins, loginLoad.Percentile(50.0f) / 1000, loginLoad.Percentile(99.0f) / 1000, loginTotal.Percentile(50.0f) / 1000, loginTotal.Percentile(99.0f) / 1000);
+
         if (!sWorld.getConfig(CONFIG_BOOL_SEA_NETWORK))
             PSendSysMessage("Queued region one : %u, region two : %u", queuedRegionOnePlayers, queuedRegionTwoPlayers);
 
@@ -6421,6 +6428,140 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
     return true;
 }
 
+static void ShowDatabaseShardStats(ChatHandler* handler, char const* name, Database& db)
+{
+    std::vector<SqlDelayThreadStats> stats;
+    db.GetSerialShardStats(stats);
+
+    if (stats.empty())
+    {
+        handler->PSendSysMessage("%s: write shards disabled", name);
+        return;
+    }
+
+    for (size_t i = 0; i < stats.size(); ++i)
+        handler->PSendSysMessage("%s shard %u: queued %u, oldest %u ms, slowest %u ms, executed " UI64FMTD,
+            name, uint32(i), stats[i].queueDepth, stats[i].oldestQueuedMs, stats[i].maxExecMs, stats[i].executed);
+}
+
+bool ChatHandler::HandleServerDbQueuesCommand(char* /*args*/)
+{
+    ShowDatabaseShardStats(this, "Character", CharacterDatabase);
+    ShowDatabaseShardStats(this, "Login", LoginDatabase);
+    ShowDatabaseShardStats(this, "World", WorldDatabase);
+    ShowDatabaseShardStats(this, "Logs", LogsDatabase);
+
+    DatabaseLoggerStats logger = sDBLogger.GetStats();
+    if (logger.capacity)
+        PSendSysMessage("Log writer: %u/%u queued, " UI64FMTD " written in " UI64FMTD " batches, " UI64FMTD " dropped",
+            logger.queued, logger.capacity, logger.written, logger.batches, logger.dropped);
+    return true;
+}
+
+static Database* GetDatabaseByName(char const* name)
+{
+    if (!name)
+        return &CharacterDatabase;
+    if (!stricmp(name, "character"))
+        return &CharacterDatabase;
+    if (!stricmp(name, "world"))
+        return &WorldDatabase;
+    if (!stricmp(name, "login"))
+        return &LoginDatabase;
+    if (!stricmp(name, "logs"))
+        return &LogsDatabase;
+    return nullptr;
+}
+
+bool ChatHandler::HandleServerDbStatsCommand(char* args)
+{
+    char* dbName = ExtractLiteralArg(&args);
+    Database* db = GetDatabaseByName(dbName);
+    if (!db)
+    {
+        SendSysMessage("Unknown database, use character, world, login or logs.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 limit;
+    if (!ExtractOptUInt32(&args, limit, 10))
+        return false;
+
+    SqlStatsSortBy sortBy = SQL_STATS_SORT_TOTAL_TIME;
+    if (char* sortName = ExtractLiteralArg(&args))
+    {
+        if (!stricmp(sortName, "count"))
+            sortBy = SQL_STATS_SORT_COUNT;
+        else if (!stricmp(sortName, "max"))
+            sortBy = SQL_STATS_SORT_MAX_TIME;
+        else if (!stricmp(sortName, "queue"))
+            sortBy = SQL_STATS_SORT_QUEUE_WAIT;
+    }
+
+    if (!db->GetStatementStats().IsEnabled())
+    {
+        SendSysMessage("Statement statistics are disabled (Database.StatementStats).");
+        return true;
+    }
+
+    std::vector<SqlStatementReport> report;
+    db->GetStatementStats().GetReport(report, sortBy, limit);
+
+    for (const auto& entry : report)
+    {
+        PSendSysMessage("%u x, total %u ms, p50 %u us, p99 %u us, max %u us, queue p99 %u us, rows " UI64FMTD ": %s",
+            uint32(entry.count), uint32(entry.totalExecUs / 1000), uint32(entry.p50ExecUs), uint32(entry.p99ExecUs),
+            entry.maxExecUs, uint32(entry.p99QueueUs), entry.rows, entry.query.substr(0, 160).c_str());
+    }
+
+    if (report.empty())
+        SendSysMessage("No statements recorded.");
+
+    return true;
+}
+
+bool ChatHandler::HandleServerDbStatsSlowCommand(char* args)
+{
+    Database* db = GetDatabaseByName(ExtractLiteralArg(&args));
+    if (!db)
+    {
+        SendSysMessage("Unknown database, use character, world, login or logs.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    std::vector<SqlSlowQuerySample> samples;
+    db->GetStatementStats().GetSlowSamples(samples);
+
+    for (const auto& sample : samples)
+    {
+        std::string time = TimeToTimestampStr(sample.time);
+        PSendSysMessage("%s: %u ms (queued %u ms) %s", time.c_str(), sample.execUs / 1000, sample.queueUs / 1000,
+            sample.sql.substr(0, 200).c_str());
+    }
+
+    if (samples.empty())
+        SendSysMessage("No slow queries recorded.");
+
+    return true;
+}
+
+bool ChatHandler::HandleServerDbStatsResetCommand(char* args)
+{
+    Database* db = GetDatabaseByName(ExtractLiteralArg(&args));
+    if (!db)
+    {
+        SendSysMessage("Unknown database, use character, world, login or logs.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    db->GetStatementStats().Reset();
+    SendSysMessage("Statement statistics reset.");
+    return true;
+}
+
 bool ChatHandler::HandleDismountCommand(char* /*args*/)
 {
     Player* pPlayer = m_session->GetPlayer();
@@ -28,6 +28,8 @@
 #include "BattleGround.h"
 #include "CreatureGroups.h"
 
+#include <unordered_map>
+
 char const* conditionSourceToStr[] =
         {
                 "loot system",
@@ -530,7 +532,7 @@ bool inline ConditionEntry::Evaluate(WorldObject const* target, Map const* map,
                     WorldObject* pObject = pMap->GetWorldObject(eventTarget.target);
 
                     if (pObject)
-                        bSatisfied = bSatisfied && sConditionStorage.LookupEntry<ConditionEntry>(m_value2)->Meets(pObject, map, source, conditionSourceType);
+                        bSatisfied = bSatisfied && sObjectMgr.IsConditionSatisfied(m_value2, pObject, map, source, conditionSourceType);
 
                     if (!bSatisfied)
                         return false;
@@ -559,7 +561,7 @@ bool inline ConditionEntry::Evaluate(WorldObject const* target, Map const* map,
             Map* pMap = const_cast<Map*>(map ? map : (source ? source->GetMap() : target->GetMap()));
             if (GameObjectData const* pGameObjectData = sObjectMgr.GetGOData(m_value1))
                 if (GameObject* pGameObject = pMap->GetGameObject(ObjectGuid(HIGHGUID_GAMEOBJECT, pGameObjectData->id, uint32(m_value1))))
-                    return sConditionStorage.LookupEntry<ConditionEntry>(m_value2)->Meets(pGameObject, map, source, conditionSourceType);
+                    return sObjectMgr.IsConditionSatisfied(m_value2, pGameObject, map, source, conditionSourceType);
             return false;
         }
         case CONDITION_PVP_RANK:
@@ -1381,10 +1383,275 @@ bool ConditionEntry::CanBeUsedWithoutPlayer(uint32 entry)
     return false;
 }
 
-bool IsConditionSatisfied(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType)
+// Results of the memoizable conditions, by condition and target
+struct ConditionMemoKey
 {
-    if (ConditionEntry const* condition = sConditionStorage.LookupEntry<ConditionEntry>(conditionId))
-        return condition->Meets(target, map, source, conditionSourceType);
+    uint32 conditionId;
+    uint64 targetGuid;
 
-    return false;
+    bool operator==(ConditionMemoKey const& other) const { return conditionId == other.conditionId && targetGuid == other.targetGuid; }
+};
+
+struct ConditionMemoKeyHash
+{
+    std::size_t operator()(ConditionMemoKey const& key) const
+    {
+        return std::hash<uint64>()(key.targetGuid * 0x9E3779B97F4A7C15ULL + key.conditionId);
+    }
+};
+
+static thread_local bool t_conditionMemoActive = false;
+static thread_local std::unordered_map<ConditionMemoKey, bool, ConditionMemoKeyHash> t_conditionMemo;
+
+ConditionMemoScope::ConditionMemoScope() : m_owner(!t_conditionMemoActive)
+{
+    t_conditionMemoActive = true;
+}
+
+ConditionMemoScope::~ConditionMemoScope()
+{
+    if (!m_owner)
+        return;
+
+    t_conditionMemo.clear();
+    t_conditionMemoActive = false;
+}
+
+// Checks from players interacting with the world always see the current state
+static bool IsMemoizedSource(ConditionSource conditionSourceType)
+{
+    switch (conditionSourceType)
+    {
+        case CONDITION_FROM_EVENTAI:
+        case CONDITION_FROM_SPELL_AREA:
+        case CONDITION_FROM_MAP_EVENT:
+        case CONDITION_FROM_DBSCRIPTS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ConditionPrograms::IsSlowlyChanging(ConditionType type)
+{
+    switch (type)
+    {
+        case CONDITION_REPUTATION_RANK_MIN:
+        case CONDITION_REPUTATION_RANK_MAX:
+        case CONDITION_TEAM:
+        case CONDITION_SKILL:
+        case CONDITION_SKILL_BELOW:
+        case CONDITION_QUESTREWARDED:
+        case CONDITION_QUESTTAKEN:
+        case CONDITION_QUEST_NONE:
+        case CONDITION_WAR_EFFORT_STAGE:
+        case CONDITION_ACTIVE_GAME_EVENT:
+        case CONDITION_ACTIVE_HOLIDAY:
+        case CONDITION_CONTENT_PHASE:
+        case CONDITION_RACE_CLASS:
+        case CONDITION_GENDER:
+        case CONDITION_SPELL:
+        case CONDITION_PVP_RANK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+ConditionPrograms::Fragment ConditionPrograms::CompileLeaf(ConditionEntry const* condition, bool swapTargets)
+{
+    Fragment fragment;
+    fragment.code.push_back({ CONDITION_OP_LEAF, swapTargets, 0, condition });
+
+    // the leaf swaps its targets again on its own
+    bool checksTarget = swapTargets == bool(condition->m_flags & CONDITION_FLAG_SWAP_TARGETS);
+    fragment.memoizable = checksTarget && IsSlowlyChanging(condition->m_condition);
+    return fragment;
+}
+
+void ConditionPrograms::Negate(Fragment& fragment)
+{
+    if (fragment.constant >= 0)
+        fragment.constant = !fragment.constant;
+    else
+        fragment.code.push_back({ CONDITION_OP_NOT, false, 0, nullptr });
+}
+
+// Checks the parts in order until one of them gives stopOn
+ConditionPrograms::Fragment ConditionPrograms::Chain(std::vector<Fragment>& parts, bool stopOn)
+{
+    Fragment chained;
+
+    std::vector<Fragment*> kept;
+    for (auto& part : parts)
+    {
+        if (part.constant == int8(stopOn))
+        {
+            chained.constant = stopOn;
+            return chained;
+        }
+
+        if (part.constant < 0)
+            kept.push_back(&part);
+    }
+
+    if (kept.empty())
+    {
+        chained.constant = !stopOn;
+        return chained;
+    }
+
+    // built from the last part, every jump skips the parts after it
+    chained.code = std::move(kept.back()->code);
+    chained.memoizable = kept.back()->memoizable;
+    for (auto itr = kept.rbegin() + 1; itr != kept.rend(); ++itr)
+    {
+        std::vector<Op> code = std::move((*itr)->code);
+        code.push_back({ stopOn ? CONDITION_OP_JUMP_IF_TRUE : CONDITION_OP_JUMP_IF_FALSE, false, uint32(chained.code.size()), nullptr });
+        code.insert(code.end(), chained.code.begin(), chained.code.end());
+        chained.code = std::move(code);
+        chained.memoizable = chained.memoizable && (*itr)->memoizable;
+    }
+
+    return chained;
+}
+
+ConditionPrograms::Fragment const& ConditionPrograms::CompileEntry(uint32 entry, bool swapTargets, FragmentCache& cache) const
+{
+    uint64 key = (uint64(entry) << 1) | uint64(swapTargets);
+    auto itr = cache.find(key);
+    if (itr != cache.end())
+        return itr->second;
+
+    Fragment fragment;
+    if (ConditionEntry const* condition = sConditionStorage.LookupEntry<ConditionEntry>(entry))
+        fragment = CompileParts(condition, swapTargets, cache);
+    else
+        fragment.constant = 0;
+
+    // element references stay valid when the map rehashes
+    return cache.emplace(key, std::move(fragment)).first->second;
+}
+
+ConditionPrograms::Fragment ConditionPrograms::CompileParts(ConditionEntry const* condition, bool swapTargets, FragmentCache& cache) const
+{
+    Fragment fragment;
+
+    switch (condition->m_condition)
+    {
+        case CONDITION_NONE:
+            fragment.constant = !(condition->m_flags & CONDITION_FLAG_REVERSE_RESULT);
+            return fragment;
+        case CONDITION_NOT:
+        case CONDITION_OR:
+        case CONDITION_AND:
+            break;
+        default:
+            return CompileLeaf(condition, swapTargets);
+    }
+
+    bool partsSwapTargets = swapTargets != bool(condition->m_flags & CONDITION_FLAG_SWAP_TARGETS);
+
+    // same order as the recursive check, the optional third and fourth parts first
+    // copies, Chain consumes them; each is at most MAX_INLINED_OPS long
+    std::vector<Fragment> parts;
+    if (condition->m_value3)
+        parts.push_back(CompileEntry(condition->m_value3, partsSwapTargets, cache));
+    if (condition->m_value4)
+        parts.push_back(CompileEntry(condition->m_value4, partsSwapTargets, cache));
+    parts.push_back(CompileEntry(condition->m_value1, partsSwapTargets, cache));
+    if (condition->m_condition == CONDITION_NOT)
+        Negate(parts.back());
+    else
+        parts.push_back(CompileEntry(condition->m_value2, partsSwapTargets, cache));
+
+    fragment = Chain(parts, condition->m_condition != CONDITION_AND);
+    if (condition->m_flags & CONDITION_FLAG_REVERSE_RESULT)
+        Negate(fragment);
+
+    if (fragment.code.size() > MAX_INLINED_OPS)
+        fragment = CompileLeaf(condition, swapTargets);
+
+    return fragment;
+}
+
+void ConditionPrograms::Compile()
+{
+    m_code.clear();
+    m_programs.clear();
+    m_programs.resize(sConditionStorage.GetMaxEntry());
+
+    FragmentCache cache;
+    for (uint32 i = 0; i < sConditionStorage.GetMaxEntry(); ++i)
+    {
+        if (!sConditionStorage.LookupEntry<ConditionEntry>(i))
+            continue;
+
+        Fragment const& fragment = CompileEntry(i, false, cache);
+
+        Program& program = m_programs[i];
+        program.start = m_code.size();
+        if (fragment.constant >= 0)
+            m_code.push_back({ CONDITION_OP_CONST, false, uint32(fragment.constant), nullptr });
+        else
+        {
+            m_code.insert(m_code.end(), fragment.code.begin(), fragment.code.end());
+            program.memoizable = fragment.memoizable;
+        }
+        m_code.push_back({ CONDITION_OP_RETURN, false, 0, nullptr });
+    }
+}
+
+bool ConditionPrograms::Run(uint32 start, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType) const
+{
+    bool result = false;
+    for (Op const* op = &m_code[start];; ++op)
+    {
+        switch (op->code)
+        {
+            case CONDITION_OP_CONST:
+                result = op->arg != 0;
+                break;
+            case CONDITION_OP_LEAF:
+                result = op->swapTargets ? op->leaf->Meets(source, map, target, conditionSourceType) : op->leaf->Meets(target, map, source, conditionSourceType);
+                break;
+            case CONDITION_OP_NOT:
+                result = !result;
+                break;
+            case CONDITION_OP_JUMP_IF_FALSE:
+                if (!result)
+                    op += op->arg;
+                break;
+            case CONDITION_OP_JUMP_IF_TRUE:
+                if (result)
+                    op += op->arg;
+                break;
+            case CONDITION_OP_RETURN:
+                return result;
+        }
+    }
+}
+
+bool ConditionPrograms::Evaluate(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType) const
+{
+    if (conditionId >= m_programs.size() || m_programs[conditionId].start == NOT_COMPILED)
+        return false;
+
+    Program const& program = m_programs[conditionId];
+    if (!program.memoizable || !target || !t_conditionMemoActive || !IsMemoizedSource(conditionSourceType))
+        return Run(program.start, target, map, source, conditionSourceType);
+
+    ConditionMemoKey key = { conditionId, target->GetObjectGuid().GetRawValue() };
+    auto itr = t_conditionMemo.find(key);
+    if (itr != t_conditionMemo.end())
+        return itr->second;
+
+    bool result = Run(program.start, target, map, source, conditionSourceType);
+    t_conditionMemo.emplace(key, result);
+    return result;
+}
+
+bool IsConditionSatisfied(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType)
+{
+    return sObjectMgr.IsConditionSatisfied(conditionId, target, map, source, conditionSourceType);
 }
\ No newline at end of file
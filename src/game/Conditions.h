@@ -23,6 +23,8 @@
 
 #include "SharedDefines.h"
 
+#include <vector>
+
 enum ConditionType
 {
     //                                                      // Legend:
@@ -308,6 +310,7 @@ enum eEscortConditionFlags
 
 class ConditionEntry
 {
+    friend class ConditionPrograms;
 public:
     // Default constructor, required for SQL Storage (Will give errors if used elsewise)
     ConditionEntry() : m_entry(0), m_condition(CONDITION_AND), m_value1(0), m_value2(0), m_value3(0), m_value4(0), m_flags(0) {}
@@ -339,6 +342,83 @@ private:
     uint8 m_flags;
 };
 
+// Condition trees flattened into short circuiting code when the conditions are loaded, so
+// that _AND, _OR and _NOT conditions no longer look up their parts on every check. Parts
+// with a constant result are folded, the other parts keep their evaluation order.
+class ConditionPrograms
+{
+public:
+    void Compile();
+    bool Evaluate(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType) const;
+
+private:
+    enum OpCode : uint8
+    {
+        CONDITION_OP_CONST,                             // result = arg
+        CONDITION_OP_LEAF,                              // result = leaf condition met
+        CONDITION_OP_NOT,
+        CONDITION_OP_JUMP_IF_FALSE,                     // skips the next arg ops
+        CONDITION_OP_JUMP_IF_TRUE,
+        CONDITION_OP_RETURN,
+    };
+
+    struct Op
+    {
+        OpCode code;
+        bool swapTargets;                               // leaf is checked with source and target swapped
+        uint32 arg;
+        ConditionEntry const* leaf;
+    };
+
+    struct Program
+    {
+        uint32 start = NOT_COMPILED;                    // first op in m_code
+        bool memoizable = false;                        // only depends on the target and slowly changing state
+    };
+
+    struct Fragment
+    {
+        std::vector<Op> code;
+        int8 constant = -1;                             // 0 or 1 when the result is known at load
+        bool memoizable = true;
+    };
+
+    // compiled parts by entry and swapTargets, shared parts are compiled only once
+    typedef std::unordered_map<uint64, Fragment> FragmentCache;
+
+    static uint32 const NOT_COMPILED = uint32(-1);
+    // bigger parts are left to the recursive check
+    static uint32 const MAX_INLINED_OPS = 64;
+
+    Fragment const& CompileEntry(uint32 entry, bool swapTargets, FragmentCache& cache) const;
+    Fragment CompileParts(ConditionEntry const* condition, bool swapTargets, FragmentCache& cache) const;
+    static Fragment CompileLeaf(ConditionEntry const* condition, bool swapTargets);
+    static Fragment Chain(std::vector<Fragment>& parts, bool stopOn);
+    static void Negate(Fragment& fragment);
+    static bool IsSlowlyChanging(ConditionType type);
+    bool Run(uint32 start, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType) const;
+
+    std::vector<Op> m_code;
+    std::vector<Program> m_programs;                    // by condition entry
+};
+
+// While one is alive, the results of the conditions that only depend on the target and on
+// slowly changing state (quest status, reputation, active events) are reused for the same
+// condition and target by the checks from scripts on this thread. Maps keep one for the
+// length of an update, so the results never outlive a map tick.
+class ConditionMemoScope
+{
+public:
+    ConditionMemoScope();
+    ~ConditionMemoScope();
+
+    ConditionMemoScope(ConditionMemoScope const&) = delete;
+    ConditionMemoScope& operator=(ConditionMemoScope const&) = delete;
+
+private:
+    bool m_owner;
+};
+
 // Check if a player meets condition conditionId
 bool IsConditionSatisfied(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType);
 
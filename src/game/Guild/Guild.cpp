@@ -29,6 +29,7 @@
 #include "GuildMgr.h"
 #include "Chat.h"
 #include "SocialMgr.h"
+#include "WhoListDirectory.h"
 #include "Util.h"
 #include "Language.h"
 #include "World.h"
@@ -37,6 +38,35 @@
 
 #define MAX_UNCOMPRESSED_PACKET_SIZE 0x8000 
 
+namespace
+{
+    // Keeps the writes of a guild in order on its serial write shard. Joins the transaction
+    // of the caller when one is already open, so that nested guild writes commit together.
+    class GuildSerialTransaction
+    {
+        public:
+            explicit GuildSerialTransaction(uint32 guildId) : m_owner(!CharacterDatabase.InTransaction())
+            {
+                if (m_owner)
+                    CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, guildId));
+                else if (CharacterDatabase.GetTransactionSerialId() != MakeSqlSerialId(SQL_SERIAL_GUILD, guildId))
+                    sLog.outError("Guild %u is written in a transaction that is not serialized with its own id", guildId);
+            }
+
+            ~GuildSerialTransaction()
+            {
+                if (m_owner)
+                    CharacterDatabase.CommitTransaction();
+            }
+
+            GuildSerialTransaction(GuildSerialTransaction const&) = delete;
+            GuildSerialTransaction& operator=(GuildSerialTransaction const&) = delete;
+
+        private:
+            bool m_owner;
+    };
+}
+
 //// MemberSlot ////////////////////////////////////////////
 void MemberSlot::SetMemberStats(Player* player)
 {
@@ -44,6 +74,7 @@ void MemberSlot::SetMemberStats(Player* player)
     Level  = player->GetLevel();
     Class  = player->GetClass();
     ZoneId = player->GetCachedZoneId();
+    ++Revision;
 }
 
 void MemberSlot::UpdateLogoutTime()
@@ -57,9 +88,11 @@ void MemberSlot::SetPublicNote(std::string const& publicNote)
         return;
 
     PublicNote = publicNote;
+    ++Revision;
 
     // pnote now can be used for encoding to DB
     CharacterDatabase.escape_string(PublicNote);
+    GuildSerialTransaction trans(GuildId);
     CharacterDatabase.PExecute("UPDATE guild_member SET pnote = '%s' WHERE guid = '%u'", PublicNote.c_str(), guid.GetCounter());
 }
 
@@ -69,21 +102,25 @@ void MemberSlot::SetOfficerNote(std::string const& officerNote)
         return;
 
     OfficerNote = officerNote;
+    ++Revision;
 
     // offnote now can be used for encoding to DB
     CharacterDatabase.escape_string(OfficerNote);
+    GuildSerialTransaction trans(GuildId);
     CharacterDatabase.PExecute("UPDATE guild_member SET offnote = '%s' WHERE guid = '%u'", OfficerNote.c_str(), guid.GetCounter());
 }
 
 void MemberSlot::ChangeRank(uint32 newRank)
 {
     RankId = newRank;
+    ++Revision;
 
     Player *player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
     if (player)
         player->SetRank(newRank);
 
+    GuildSerialTransaction trans(GuildId);
     CharacterDatabase.PExecute("UPDATE guild_member SET `rank`='%u' WHERE guid='%u'", newRank, guid.GetCounter());
 }
 
@@ -149,7 +186,7 @@ bool Guild::Create(Player* leader, std::string gname)
     CharacterDatabase.escape_string(dbGINFO);
     CharacterDatabase.escape_string(dbMOTD);
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, m_Id));
     // CharacterDatabase.PExecute("DELETE FROM guild WHERE guildid='%u'", Id); - MAX(guildid)+1 not exist
     CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guildid='%u'", m_Id);
     CharacterDatabase.PExecute("INSERT INTO guild (guildid,name,leaderguid,info,motd,createdate,EmblemStyle,EmblemColor,BorderStyle,BorderColor,BackgroundColor) "
@@ -170,6 +207,7 @@ bool Guild::Create(Player* leader, std::string gname)
 
 void Guild::CreateDefaultGuildRanks(int locale_idx)
 {
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE guildid='%u'", m_Id);
 
     CreateRank(sObjectMgr.GetMangosString(LANG_GUILD_MASTER, locale_idx),   GR_RIGHT_ALL);
@@ -182,10 +220,12 @@ void Guild::CreateDefaultGuildRanks(int locale_idx)
 void Guild::Rename(std::string& newName)
 {
     m_Name = newName;
+    sWhoListDirectory.RenameGuild(m_Id, m_Name);
 
     std::string escaped = m_Name;
     CharacterDatabase.escape_string(escaped);
 
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild SET name = '%s' WHERE guildid = '%u'", escaped.c_str(), m_Id);
 }
 
@@ -216,6 +256,7 @@ GuildAddStatus Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
     MemberSlot newmember;
 
     newmember.guid = plGuid;
+    newmember.GuildId = m_Id;
 
     if (pl)
     {
@@ -259,8 +300,11 @@ GuildAddStatus Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
     CharacterDatabase.escape_string(dbPnote);
     CharacterDatabase.escape_string(dbOFFnote);
 
-    CharacterDatabase.PExecute("INSERT INTO guild_member (guildid,guid,`rank`,pnote,offnote) VALUES ('%u', '%u', '%u','%s','%s')",
-                               m_Id, lowguid, newmember.RankId, dbPnote.c_str(), dbOFFnote.c_str());
+    {
+        GuildSerialTransaction trans(m_Id);
+        CharacterDatabase.PExecute("INSERT INTO guild_member (guildid,guid,`rank`,pnote,offnote) VALUES ('%u', '%u', '%u','%s','%s')",
+                                   m_Id, lowguid, newmember.RankId, dbPnote.c_str(), dbOFFnote.c_str());
+    }
 
     // If player not in game data in data field will be loaded from guild tables, no need to update it!!
     if (pl)
@@ -268,7 +312,7 @@ GuildAddStatus Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
         pl->SetInGuild(m_Id);
         pl->SetRank(newmember.RankId);
         pl->SetGuildIdInvited(0);
-        AddToCache(lowguid);
+        AddToCache(lowguid, pl->GetSession());
     }
 
     UpdateAccountsNumber();
@@ -282,6 +326,7 @@ void Guild::SetMOTD(std::string motd)
 
     // motd now can be used for encoding to DB
     CharacterDatabase.escape_string(motd);
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild SET motd='%s' WHERE guildid='%u'", motd.c_str(), m_Id);
 }
 
@@ -291,6 +336,7 @@ void Guild::SetGINFO(std::string ginfo)
 
     // ginfo now can be used for encoding to DB
     CharacterDatabase.escape_string(ginfo);
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild SET info='%s' WHERE guildid='%u'", ginfo.c_str(), m_Id);
 }
 
@@ -375,6 +421,7 @@ bool Guild::LoadRanksFromDB(QueryResult *guildRanksResult)
         {
             //there is in table guild_rank record which doesn't have guildid in guild table, report error
             sLog.outErrorDb("Guild %u does not exist but it has a record in guild_rank table, deleting it!", guildId);
+            GuildSerialTransaction trans(guildId);
             CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE guildid = '%u'", guildId);
             continue;
         }
@@ -408,7 +455,7 @@ bool Guild::LoadRanksFromDB(QueryResult *guildRanksResult)
     if (broken_ranks)
     {
         sLog.outError("Guild %u has broken `guild_rank` data, repairing...", m_Id);
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, m_Id));
         CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE guildid='%u'", m_Id);
         for (size_t i = 0; i < m_Ranks.size(); ++i)
         {
@@ -439,6 +486,7 @@ bool Guild::LoadMembersFromDB(QueryResult *guildMembersResult)
         {
             // there is in table guild_member record which doesn't have guildid in guild table, report error
             sLog.outErrorDb("Guild %u does not exist but it has a record in guild_member table, deleting it!", guildId);
+            GuildSerialTransaction trans(guildId);
             CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guildid = '%u'", guildId);
             continue;
         }
@@ -450,6 +498,7 @@ bool Guild::LoadMembersFromDB(QueryResult *guildMembersResult)
         MemberSlot newmember;
         uint32 lowguid = fields[1].GetUInt32();
         newmember.guid = ObjectGuid(HIGHGUID_PLAYER, lowguid);
+        newmember.GuildId = m_Id;
         newmember.RankId = fields[2].GetUInt32();
         // don't allow member to have not existing rank!
         if (newmember.RankId >= m_Ranks.size())
@@ -469,6 +518,7 @@ bool Guild::LoadMembersFromDB(QueryResult *guildMembersResult)
         if (newmember.Level < 1 || newmember.Level > PLAYER_STRONG_MAX_LEVEL) // can be at broken `data` field
         {
             sLog.outError("%s has a broken data in field `characters`.`data`, deleting him from guild!", newmember.guid.GetString().c_str());
+            GuildSerialTransaction trans(m_Id);
             CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
             continue;
         }
@@ -482,12 +532,14 @@ bool Guild::LoadMembersFromDB(QueryResult *guildMembersResult)
         if (!((1 << (newmember.Class - 1)) & CLASSMASK_ALL_PLAYABLE)) // can be at broken `class` field
         {
             sLog.outError("%s has a broken data in field `characters`.`class`, deleting him from guild!", newmember.guid.GetString().c_str());
+            GuildSerialTransaction trans(m_Id);
             CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
             continue;
         }
         if (newmember.Name.empty()) // no deleted characters
         {
             sLog.outError("%s has no name, deleting him from guild!", newmember.guid.GetString().c_str());
+            GuildSerialTransaction trans(m_Id);
             CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
             continue;
         }
@@ -518,6 +570,8 @@ void Guild::SetLeader(ObjectGuid guid)
 void Guild::SetLeader(MemberSlot* slot)
 {
     m_LeaderGuid = slot->guid;
+
+    GuildSerialTransaction trans(m_Id);
     slot->ChangeRank(GR_GUILDMASTER);
 
     CharacterDatabase.PExecute("UPDATE guild SET leaderguid='%u' WHERE guildid='%u'", slot->guid.GetCounter(), m_Id);
@@ -551,8 +605,9 @@ bool Guild::DelMember(ObjectGuid guid, bool isDisbanding)
             BroadcastEvent(GE_LEFT, guid, oldLeader->Name.c_str());
     }
 
-    members.erase(lowguid);
     RemoveFromCache(lowguid);
+    members.erase(lowguid);
+    m_rosterBlocks.erase(lowguid);
     sGuildMgr.GuildMemberRemoved(lowguid);
 
     Player *player = sObjectMgr.GetPlayer(guid);
@@ -563,7 +618,10 @@ bool Guild::DelMember(ObjectGuid guid, bool isDisbanding)
         player->SetRank(0);
     }
 
-    CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
+    {
+        GuildSerialTransaction trans(m_Id);
+        CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
+    }
 
     if (!isDisbanding)
         UpdateAccountsNumber();
@@ -648,39 +706,16 @@ void Guild::BroadcastToGuild(MasterPlayer* pPlayer, std::string const& msg, uint
     WorldPacket data;
     ChatHandler::BuildChatPacket(data, CHAT_MSG_GUILD, msg.c_str(), Language(language), pPlayer->GetChatTag(), pPlayer->GetObjectGuid(), pPlayer->GetName());
 
-    if (IsMemberCacheEnabled())
+    for (auto const& itr : m_onlineMembers)
     {
-        for (auto const& guidLow : m_onlineMemberCache)
-        {
-            auto pl = ObjectAccessor::FindMasterPlayer(ObjectGuid(HIGHGUID_PLAYER, guidLow));
-            if (!pl)
-                continue;
-
-            auto memberItr = members.find(guidLow);
-            if (memberItr == members.end())
-                continue;
-
-            if (!HasRankRight(memberItr->second.RankId, GR_RIGHT_GCHATLISTEN))
-                continue;
-            
-            if (pl && pl->GetSession() && !pl->GetSession()->PlayerLogout() &&
-                pl->GetSocial() && !pl->GetSocial()->HasIgnore(pPlayer->GetObjectGuid()))
-                pl->GetSession()->SendPacket(&data);
-        }
-    }
-    else
-    {
-        for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
-        {
-            if (!HasRankRight(itr->second.RankId, GR_RIGHT_GCHATLISTEN))
-                continue;
+        if (!HasRankRight(itr.second.slot->RankId, GR_RIGHT_GCHATLISTEN))
+            continue;
 
-            MasterPlayer* pl = ObjectAccessor::FindMasterPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
+        MasterPlayer* pl = itr.second.session->GetMasterPlayer();
 
-            if (pl && pl->GetSession() && !pl->GetSession()->PlayerLogout() &&
-                pl->GetSocial() && !pl->GetSocial()->HasIgnore(pPlayer->GetObjectGuid()))
-                pl->GetSession()->SendPacket(&data);
-        }
+        if (pl && !itr.second.session->PlayerLogout() &&
+            pl->GetSocial() && !pl->GetSocial()->HasIgnore(pPlayer->GetObjectGuid()))
+            itr.second.session->SendPacket(&data);
     }
 
     for (const auto& gmGuid : m_GmListeners)
@@ -704,15 +739,15 @@ void Guild::BroadcastToOfficers(WorldSession *session, std::string const& msg, u
     WorldPacket data;
     ChatHandler::BuildChatPacket(data, CHAT_MSG_OFFICER, msg.c_str(), Language(language), pPlayer->GetChatTag(), pPlayer->GetObjectGuid(), pPlayer->GetName());
 
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (auto const& itr : m_onlineMembers)
     {
-        if (!HasRankRight(itr->second.RankId, GR_RIGHT_OFFCHATLISTEN))
+        if (!HasRankRight(itr.second.slot->RankId, GR_RIGHT_OFFCHATLISTEN))
             continue;
 
-        MasterPlayer *pl = ObjectAccessor::FindMasterPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
+        MasterPlayer *pl = itr.second.session->GetMasterPlayer();
 
-        if (pl && pl->GetSession() && !pl->GetSocial()->HasIgnore(session->GetMasterPlayer()->GetObjectGuid()))
-            pl->GetSession()->SendPacket(&data);
+        if (pl && pl->GetSocial() && !pl->GetSocial()->HasIgnore(pPlayer->GetObjectGuid()))
+            itr.second.session->SendPacket(&data);
     }
 
     for (const auto& gmGuid : m_GmListeners)
@@ -724,28 +759,10 @@ void Guild::BroadcastToOfficers(WorldSession *session, std::string const& msg, u
     }
 }
 
-void Guild::BroadcastPacket(WorldPacket *packet)
+void Guild::BroadcastPacket(WorldPacket const* packet)
 {
-    if (IsMemberCacheEnabled())
-    {
-        for (auto const& guidLow : m_onlineMemberCache)
-        {
-            auto pl = ObjectAccessor::FindMasterPlayer(ObjectGuid(HIGHGUID_PLAYER, guidLow));
-            if (!pl)
-                continue;
-
-            pl->GetSession()->SendPacket(packet);
-        }
-    }
-    else
-    {
-        for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
-        {
-            Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-            if (player)
-                player->GetSession()->SendPacket(packet);
-        }
-    }
+    for (auto const& itr : m_onlineMembers)
+        itr.second.session->SendPacket(packet);
 
     for (const auto& gmGuid : m_GmListeners)
     {
@@ -758,14 +775,10 @@ void Guild::BroadcastPacket(WorldPacket *packet)
 
 void Guild::BroadcastPacketToRank(WorldPacket *packet, uint32 rankId)
 {
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (auto const& itr : m_onlineMembers)
     {
-        if (itr->second.RankId == rankId)
-        {
-            Player *player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-            if (player)
-                player->GetSession()->SendPacket(packet);
-        }
+        if (itr.second.slot->RankId == rankId)
+            itr.second.session->SendPacket(packet);
     }
 }
 
@@ -781,6 +794,7 @@ void Guild::CreateRank(std::string name_, uint32 rights)
 
     // name now can be used for encoding to DB
     CharacterDatabase.escape_string(name_);
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("INSERT INTO guild_rank (guildid,rid,rname,rights) VALUES ('%u', '%u', '%s', '%u')", m_Id, new_rank_id, name_.c_str(), rights);
 }
 
@@ -797,6 +811,7 @@ void Guild::DelRank()
 
     // delete lowest guild_rank
     uint32 rank = GetLowestRank();
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE rid>='%u' AND guildid='%u'", rank, m_Id);
 
 	_Bank->UpdateMinranks(rank);
@@ -830,6 +845,7 @@ void Guild::SetRankName(uint32 rankId, std::string name_)
 
     // name now can be used for encoding to DB
     CharacterDatabase.escape_string(name_);
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild_rank SET rname='%s' WHERE rid='%u' AND guildid='%u'", name_.c_str(), rankId, m_Id);
 }
 
@@ -840,6 +856,7 @@ void Guild::SetRankRights(uint32 rankId, uint32 rights)
 
     m_Ranks[rankId].Rights = rights;
 
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild_rank SET rights='%u' WHERE rid='%u' AND guildid='%u'", rights, rankId, m_Id);
 }
 
@@ -851,6 +868,8 @@ void Guild::SetRankRights(uint32 rankId, uint32 rights)
 void Guild::Disband()
 {
     BroadcastEvent(GE_DISBANDED);
+    // the guild is deleted before the next world tick
+    SendPendingBroadcasts();
 
     while (!members.empty())
     {
@@ -858,7 +877,7 @@ void Guild::Disband()
         DelMember(ObjectGuid(HIGHGUID_PLAYER, itr->first), true);
     }
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, m_Id));
     CharacterDatabase.PExecute("DELETE FROM guild WHERE guildid = '%u'", m_Id);
     CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE guildid = '%u'", m_Id);
     CharacterDatabase.PExecute("DELETE FROM guild_eventlog WHERE guildid = '%u'", m_Id);
@@ -884,17 +903,60 @@ void Guild::Disband()
     sGuildMgr.RemoveGuild(m_Id);
 }
 
-WorldPacket Guild::BuildOnlineRosterPacket(bool sendOfficerNote)
+Player* Guild::GetRosterPlayer(uint32 guidLow) const
 {
-    struct TempMemberInfo
+    OnlineMemberList::const_iterator itr = m_onlineMembers.find(guidLow);
+    if (itr == m_onlineMembers.end())
+        return nullptr;
+
+    // GMs without socials are shown offline
+    Player* player = itr->second.session->GetPlayer();
+    if (!player || !player->IsInWorld() || player->HasGMDisabledSocials())
+        return nullptr;
+
+    return player;
+}
+
+void Guild::AppendRosterMember(WorldPacket& data, MemberSlot& slot, Player* player, bool sendOfficerNote)
+{
+    bool const online = player != nullptr;
+
+    RosterMemberBlock& block = m_rosterBlocks[slot.guid.GetCounter()];
+    if (block.data.empty() || block.revision != slot.Revision || block.online != online)
     {
-        ObjectGuid Guid;
-        Player* Member = nullptr;
-        MemberSlot* Slot = nullptr;
-    };
+        block.revision = slot.Revision;
+        block.online = online;
+        block.data.clear();
+
+        block.data << slot.guid;
+        block.data << uint8(online);
+        block.data << (online ? player->GetName() : slot.Name.c_str());
+        block.data << uint32(slot.RankId);
+        block.data << uint8(online ? player->GetLevel() : slot.Level);
+        block.data << uint8(online ? player->GetClass() : slot.Class);
+        block.data << uint32(online ? player->GetCachedZoneId() : slot.ZoneId);
+    }
+
+    size_t const blockPos = data.wpos();
+    data.append(block.data);
+
+    if (online)
+    {
+        // level and zone change while online without touching the slot
+        data.put<uint8>(blockPos + block.data.size() - 6, uint8(player->GetLevel()));
+        data.put<uint32>(blockPos + block.data.size() - 4, uint32(player->GetCachedZoneId()));
+    }
+    else
+        data << float(float(time(nullptr) - slot.LogoutTime) / DAY);
 
+    data << slot.PublicNote;
+    data << (sendOfficerNote ? slot.OfficerNote : "");
+}
+
+WorldPacket Guild::BuildOnlineRosterPacket(bool sendOfficerNote)
+{
     size_t onlineMembers = 0;
-    std::vector<TempMemberInfo> onlineMemberCache;
+    std::vector<std::pair<MemberSlot*, Player*>> onlineMemberCache;
 
     uint32 totalSize = 0;
     totalSize += sizeof(uint32); // count
@@ -902,49 +964,22 @@ WorldPacket Guild::BuildOnlineRosterPacket(bool sendOfficerNote)
     totalSize += sizeof(uint32); // m_ranks.size()
     totalSize += sizeof(uint32) * m_Ranks.size(); // all ranks
 
-
-    for (auto itr = members.begin(); itr != members.end(); ++itr)
+    for (auto const& itr : m_onlineMembers)
     {
-        TempMemberInfo info;
-        info.Guid = ObjectGuid(HIGHGUID_PLAYER, itr->first);
-        info.Member = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-        info.Slot = &itr->second;
-
-        if (info.Member && !info.Member->HasGMDisabledSocials())
+        if (Player* player = GetRosterPlayer(itr.first))
         {
             totalSize += GUILD_MEMBER_BLOCK_SIZE_WITHOUT_NOTE;
-            totalSize += info.Slot->PublicNote.length();
+            totalSize += itr.second.slot->PublicNote.length();
             if (sendOfficerNote)
-                totalSize += info.Slot->OfficerNote.length();
+                totalSize += itr.second.slot->OfficerNote.length();
 
-            onlineMemberCache.emplace_back(info);
+            onlineMemberCache.emplace_back(itr.second.slot, player);
             ++onlineMembers;
         }
     }
 
     const bool inPacketCap = totalSize < MAX_UNCOMPRESSED_PACKET_SIZE;
 
-    auto writeMemberData = [inPacketCap, sendOfficerNote](WorldPacket& data, TempMemberInfo const& member) -> bool
-    {
-        if (!inPacketCap)
-        {
-            // if the packet is expected to be bigger than cap we filter otherwise we might send too much.
-            if (data.size() + GUILD_MEMBER_BLOCK_SIZE >= MAX_UNCOMPRESSED_PACKET_SIZE)
-                return false;
-        }
-
-        data << member.Guid;
-        data << uint8(1); // only online
-        data << member.Member->GetName();
-        data << uint32(member.Slot->RankId);
-        data << uint8(member.Member->GetLevel());
-        data << uint8(member.Member->GetClass());
-        data << uint32(member.Member->GetCachedZoneId());
-        data << member.Slot->PublicNote;
-        data << (sendOfficerNote ? member.Slot->OfficerNote : "");
-        return true;
-    };
-
     // we can only guess size
     WorldPacket data(SMSG_GUILD_ROSTER, (4 + m_motd.length() + 1 + m_info.length() + 1 + 4 + m_Ranks.size() * 4 + onlineMembers * GUILD_MEMBER_BLOCK_SIZE_WITHOUT_NOTE));
 
@@ -961,9 +996,9 @@ WorldPacket Guild::BuildOnlineRosterPacket(bool sendOfficerNote)
     //sort the members from highest to lowest rank if over limit.
     if (!inPacketCap)
     {
-        std::sort(onlineMemberCache.begin(), onlineMemberCache.end(), [](const TempMemberInfo& a, const TempMemberInfo& b)
+        std::sort(onlineMemberCache.begin(), onlineMemberCache.end(), [](std::pair<MemberSlot*, Player*> const& a, std::pair<MemberSlot*, Player*> const& b)
             {
-                return a.Slot->RankId < b.Slot->RankId; // lowest ranks first, lowest rank ids -> highest actual rank
+                return a.first->RankId < b.first->RankId; // lowest ranks first, lowest rank ids -> highest actual rank
             });
     }
 
@@ -971,13 +1006,12 @@ WorldPacket Guild::BuildOnlineRosterPacket(bool sendOfficerNote)
 
     for (const auto& member : onlineMemberCache)
     {
-        if (!member.Member)
-            continue;
-
-        if (writeMemberData(data, member))
-            ++finalCount;
-        else
+        // if the packet is expected to be bigger than cap we filter otherwise we might send too much.
+        if (!inPacketCap && data.size() + GUILD_MEMBER_BLOCK_SIZE >= MAX_UNCOMPRESSED_PACKET_SIZE)
             break;
+
+        AppendRosterMember(data, *member.first, member.second, sendOfficerNote);
+        ++finalCount;
     }
 
     data.put<uint32>(countPos, finalCount);
@@ -1012,6 +1046,8 @@ void Guild::TempRosterOnline(WorldSession* session /*= nullptr*/)
 
 void Guild::UpdateCaches(uint32 diff)
 {
+    SendPendingBroadcasts();
+
     if (!IsMemberCacheEnabled())
         return;
 
@@ -1031,22 +1067,49 @@ void Guild::UpdateCaches(uint32 diff)
         m_cacheTimer -= diff;
 }
 
-void Guild::Roster(WorldSession *session /*= nullptr*/)
+void Guild::SendPendingBroadcasts()
 {
+    if (!m_pendingEvents.empty())
+    {
+        std::vector<PendingGuildEvent> events = std::move(m_pendingEvents);
+        m_pendingEvents.clear();
+
+        for (auto const& itr : m_onlineMembers)
+        {
+            for (auto const& event : events)
+                itr.second.session->SendPacket(&event.packet);
+        }
 
-    struct TempMemberInfo
+        for (const auto& gmGuid : m_GmListeners)
+        {
+            if (Player* gm = sObjectAccessor.FindPlayer(gmGuid))
+            {
+                for (auto const& event : events)
+                    gm->GetSession()->SendPacket(&event.packet);
+            }
+        }
+
+        DEBUG_LOG("WORLD: Sent %u SMSG_GUILD_EVENT", uint32(events.size()));
+    }
+
+    if (m_rosterBroadcastPending)
     {
-        ObjectGuid Guid;
-        Player* Member = nullptr;
-        MemberSlot* Slot = nullptr;
-    };
+        m_rosterBroadcastPending = false;
+
+        WorldPacket data = BuildRosterPacket(false);
+        BroadcastPacket(&data);
+        DEBUG_LOG("WORLD: Sent (SMSG_GUILD_ROSTER)");
+    }
+}
 
+WorldPacket Guild::BuildRosterPacket(bool sendOfficerNote)
+{
     size_t onlineMembers = 0;
     size_t offlineMembers = 0;
-    std::vector<TempMemberInfo> onlineMemberCache;
-    std::vector<TempMemberInfo> offlineMemberCache;
-    onlineMemberCache.reserve(members.size() / 2);
-    offlineMemberCache.reserve(members.size() / 2);
+    std::vector<std::pair<MemberSlot*, Player*>> onlineMemberCache;
+    std::vector<std::pair<MemberSlot*, Player*>> offlineMemberCache;
+    onlineMemberCache.reserve(m_onlineMembers.size());
+    offlineMemberCache.reserve(members.size() - std::min(members.size(), m_onlineMembers.size()));
 
     uint32 totalSize = 0;
     totalSize += sizeof(uint32); // count
@@ -1056,25 +1119,21 @@ void Guild::Roster(WorldSession *session /*= nullptr*/)
 
     for (auto itr = members.begin(); itr != members.end(); ++itr)
     {
-        TempMemberInfo info;
-        info.Guid = ObjectGuid(HIGHGUID_PLAYER, itr->first);
-        info.Member = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-        info.Slot = &itr->second;
+        MemberSlot* slot = &itr->second;
 
-        if (info.Member && !info.Member->HasGMDisabledSocials())
+        if (Player* player = GetRosterPlayer(itr->first))
         {
-            onlineMemberCache.emplace_back(info);
+            onlineMemberCache.emplace_back(slot, player);
             ++onlineMembers;
         }
         else
         {
-            offlineMemberCache.emplace_back(info);
+            offlineMemberCache.emplace_back(slot, nullptr);
             ++offlineMembers;
         }
 
-
         totalSize += GUILD_MEMBER_BLOCK_SIZE_WITHOUT_NOTE;
-        totalSize += info.Slot->PublicNote.length() + 1 + info.Slot->OfficerNote.length() + 1;
+        totalSize += slot->PublicNote.length() + 1 + slot->OfficerNote.length() + 1;
     }
 
     size_t count = onlineMembers + offlineMembers;
@@ -1083,51 +1142,9 @@ void Guild::Roster(WorldSession *session /*= nullptr*/)
     onlineMembers = std::min(onlineMembers, size_t(GUILD_MAX_MEMBERS));
     offlineMembers = std::min(offlineMembers, size_t(GUILD_MAX_MEMBERS) - onlineMembers);
 
+    // guild with notes is too big to show in one packet. We could for later add some UI to paginate the member list.
+    // For now just prefer online members, then ranks, then the rest.
     const bool inPacketCap = totalSize < MAX_UNCOMPRESSED_PACKET_SIZE;
-    auto sendOfficerNote = session && session->GetPlayer() ? HasRankRight(session->GetPlayer()->GetRank(), GR_RIGHT_VIEWOFFNOTE) : false;
-
-    if (!inPacketCap)
-    {
-        // figure out how many we can send before having to apply pagination (soon tm).
-        // guild with notes is too big to show in one packet. We could for later add some UI to paginate the member list.
-        // For now just prefer online members, then ranks, then the rest.
-        // this if block is intentionally left empty.
-    }
-
-    auto writeMemberData = [inPacketCap, sendOfficerNote](WorldPacket& data, TempMemberInfo const& member) -> bool
-    {
-        if (!inPacketCap)
-        {
-            // if the packet is expected to be bigger than cap we filter otherwise we might send too much.
-            if (data.size() + GUILD_MEMBER_BLOCK_SIZE >= MAX_UNCOMPRESSED_PACKET_SIZE)
-                return false;
-        }
-
-        bool online = member.Member != nullptr && !member.Member->HasGMDisabledSocials();
-
-        data << member.Guid;
-        data << uint8((online)); // online / offline state, send 0 for GMS without socials enabled too
-        if (member.Member)
-        {
-            data << member.Member->GetName();
-            data << uint32(member.Slot->RankId);
-            data << uint8(member.Member->GetLevel());
-            data << uint8(member.Member->GetClass());
-            data << uint32(member.Member->GetCachedZoneId());
-        }
-        else
-        {
-            data << member.Slot->Name;
-            data << uint32(member.Slot->RankId);
-            data << uint8(member.Slot->Level);
-            data << uint8(member.Slot->Class);
-            data << uint32(member.Slot->ZoneId);
-            data << float(float(time(nullptr) - member.Slot->LogoutTime) / DAY);
-        }
-        data << member.Slot->PublicNote;
-        data << (sendOfficerNote ? member.Slot->OfficerNote : "");
-        return true;
-    };
 
     // we can only guess size
     WorldPacket data(SMSG_GUILD_ROSTER, (4 + m_motd.length() + 1 + m_info.length() + 1 + 4 + m_Ranks.size() * 4 + count * GUILD_MEMBER_BLOCK_SIZE_WITHOUT_NOTE));
@@ -1142,63 +1159,68 @@ void Guild::Roster(WorldSession *session /*= nullptr*/)
     for (RankList::const_iterator ritr = m_Ranks.begin(); ritr != m_Ranks.end(); ++ritr)
         data << uint32(ritr->Rights);
 
-
     //sort the members from highest to lowest rank if over limit.
     if (!inPacketCap)
     {
-        std::sort(onlineMemberCache.begin(), onlineMemberCache.end(), [](const TempMemberInfo& a, const TempMemberInfo& b)
+        auto byRank = [](std::pair<MemberSlot*, Player*> const& a, std::pair<MemberSlot*, Player*> const& b)
         {
-            return a.Slot->RankId < b.Slot->RankId; // lowest ranks first, lowest rank ids -> highest actual rank
-        });
+            return a.first->RankId < b.first->RankId; // lowest ranks first, lowest rank ids -> highest actual rank
+        };
 
-        std::sort(offlineMemberCache.begin(), offlineMemberCache.end(), [](const TempMemberInfo& a, const TempMemberInfo& b)
-        {
-            return a.Slot->RankId < b.Slot->RankId; // lowest ranks first, lowest rank ids -> highest actual rank
-        });
+        std::sort(onlineMemberCache.begin(), onlineMemberCache.end(), byRank);
+        std::sort(offlineMemberCache.begin(), offlineMemberCache.end(), byRank);
     }
 
     //cull caches if they're too big.
     if (onlineMembers < onlineMemberCache.size())
-        onlineMemberCache.resize(onlineMemberCache.size() - (onlineMemberCache.size() - onlineMembers));
+        onlineMemberCache.resize(onlineMembers);
 
     if (offlineMembers < offlineMemberCache.size())
-        offlineMemberCache.resize(offlineMemberCache.size() - (offlineMemberCache.size() - offlineMembers));
+        offlineMemberCache.resize(offlineMembers);
 
     uint32 finalCount = 0;
 
     for (const auto& member : onlineMemberCache)
     {
-        if (!member.Member)
-            continue;
-
-        if (writeMemberData(data, member))
-            ++finalCount;
-        else
+        // if the packet is expected to be bigger than cap we filter otherwise we might send too much.
+        if (!inPacketCap && data.size() + GUILD_MEMBER_BLOCK_SIZE >= MAX_UNCOMPRESSED_PACKET_SIZE)
             break;
+
+        AppendRosterMember(data, *member.first, member.second, sendOfficerNote);
+        ++finalCount;
     }
 
     for (const auto& member : offlineMemberCache)
     {
-        if (member.Member && !member.Member->HasGMDisabledSocials())
-            continue;
-
         // skip deleted characters with no name
         // they should be removed from guild but somehow it happens on live
-        if (member.Slot->Name.empty())
+        if (member.first->Name.empty())
             continue;
 
-        if (writeMemberData(data, member))
-            ++finalCount;
-        else
+        if (!inPacketCap && data.size() + GUILD_MEMBER_BLOCK_SIZE >= MAX_UNCOMPRESSED_PACKET_SIZE)
             break;
+
+        AppendRosterMember(data, *member.first, nullptr, sendOfficerNote);
+        ++finalCount;
     }
 
     data.put<uint32>(countPos, finalCount);
+    return data;
+}
 
-    if (session)
-        session->SendPacket(&data);
-    else
-        BroadcastPacket(&data);
+void Guild::Roster(WorldSession *session /*= nullptr*/)
+{
+    // broadcasts are coalesced and sent once per world tick
+    if (!session)
+    {
+        m_rosterBroadcastPending = true;
+        return;
+    }
+
+    bool const sendOfficerNote = session->GetPlayer() ? HasRankRight(session->GetPlayer()->GetRank(), GR_RIGHT_VIEWOFFNOTE) : false;
+
+    WorldPacket data = BuildRosterPacket(sendOfficerNote);
+    session->SendPacket(&data);
     DEBUG_LOG("WORLD: Sent (SMSG_GUILD_ROSTER)");
 }
 
@@ -1235,6 +1257,7 @@ void Guild::SetEmblem(uint32 emblemStyle, uint32 emblemColor, uint32 borderStyle
     m_BorderColor = borderColor;
     m_BackgroundColor = backgroundColor;
 
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("UPDATE guild SET EmblemStyle=%u, EmblemColor=%u, BorderStyle=%u, BorderColor=%u, BackgroundColor=%u WHERE guildid = %u", m_EmblemStyle, m_EmblemColor, m_BorderStyle, m_BorderColor, m_BackgroundColor, m_Id);
 }
 
@@ -1333,6 +1356,7 @@ void Guild::LogGuildEvent(uint8 EventType, ObjectGuid playerGuid1, ObjectGuid pl
     // Add event to list
     m_GuildEventLog.push_back(NewEvent);
     // Save event to DB
+    GuildSerialTransaction trans(m_Id);
     CharacterDatabase.PExecute("DELETE FROM guild_eventlog WHERE guildid='%u' AND LogGuid='%u'", m_Id, m_GuildEventLogNextGuid);
     CharacterDatabase.PExecute("INSERT INTO guild_eventlog (guildid, LogGuid, EventType, PlayerGuid1, PlayerGuid2, NewRank, TimeStamp) VALUES ('%u','%u','%u','%u','%u','%u','" UI64FMTD "')",
                                m_Id, m_GuildEventLogNextGuid, uint32(NewEvent.EventType), NewEvent.PlayerGuid1, NewEvent.PlayerGuid2, uint32(NewEvent.NewRank), NewEvent.TimeStamp);
@@ -1374,7 +1398,14 @@ void Guild::BroadcastEvent(GuildEvents event, ObjectGuid guid, char const* str1
     if (!guid.IsEmpty())
         data << guid;
 
-    BroadcastPacket(&data);
+    // only the last message of the day of a tick is worth sending
+    if (event == GE_MOTD)
+    {
+        m_pendingEvents.erase(std::remove_if(m_pendingEvents.begin(), m_pendingEvents.end(), [](PendingGuildEvent const& pending)
+        {
+            return pending.event == GE_MOTD;
+        }), m_pendingEvents.end());
+    }
 
-    DEBUG_LOG("WORLD: Sent SMSG_GUILD_EVENT");
+    m_pendingEvents.push_back({ event, std::move(data) });
 }
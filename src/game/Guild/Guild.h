@@ -31,6 +31,7 @@
 
 class Item;
 class Petition;
+class WorldSession;
 
 #define GUILD_RANKS_MIN_COUNT   5
 #define GUILD_RANKS_MAX_COUNT   10
@@ -191,6 +192,7 @@ struct MemberSlot
     void ChangeRank(uint32 newRank);
 
     ObjectGuid guid;
+    uint32 GuildId = 0;                                     // serial key of the member writes
     uint32 accountId;
     std::string Name;
     uint32 RankId;
@@ -200,6 +202,7 @@ struct MemberSlot
     uint64 LogoutTime;
     std::string PublicNote;
     std::string OfficerNote;
+    uint32 Revision = 0;                                    // changed with the fields above, for the roster cache
 };
 
 struct RankInfo
@@ -273,7 +276,7 @@ class Guild
         void BroadcastToGuild(MasterPlayer* pPlayer, std::string const& msg, uint32 language = LANG_UNIVERSAL);
         void BroadcastToOfficers(WorldSession *session, std::string const& msg, uint32 language = LANG_UNIVERSAL);
         void BroadcastPacketToRank(WorldPacket *packet, uint32 rankId);
-        void BroadcastPacket(WorldPacket *packet);
+        void BroadcastPacket(WorldPacket const* packet);
 
         void BroadcastEvent(GuildEvents event, ObjectGuid guid, char const* str1 = nullptr, char const* str2 = nullptr, char const* str3 = nullptr);
         void BroadcastEvent(GuildEvents event, char const* str1 = nullptr, char const* str2 = nullptr, char const* str3 = nullptr)
@@ -332,7 +335,8 @@ class Guild
         
         void UpdateCaches(uint32 diff);
         WorldPacket BuildOnlineRosterPacket(bool sendOfficerNote);
-        void Roster(WorldSession *session = nullptr);          // nullptr = broadcast
+        WorldPacket BuildRosterPacket(bool sendOfficerNote);
+        void Roster(WorldSession *session = nullptr);          // nullptr = broadcast at the next world tick
         void TempRosterOnline(WorldSession* session = nullptr);          // nullptr = broadcast
         void Query(WorldSession *session);
 
@@ -345,14 +349,19 @@ class Guild
         void SetNewLeader(ObjectGuid newLeaderGuid);
         void SetNewLeader(MemberSlot* newLeaderSlot, MemberSlot* oldLeaderSlot);
 
-        void AddToCache(uint32 guidLow)
+        void AddToCache(uint32 guidLow, WorldSession* session)
         {
-            m_onlineMemberCache.insert(guidLow);
+            MemberList::iterator itr = members.find(guidLow);
+            if (itr != members.end())
+                m_onlineMembers[guidLow] = { session, &itr->second };
         }
 
-        void RemoveFromCache(uint32 guidLow)
+        // the session is checked as a relogin hands the player over to a new session before the old one logs out
+        void RemoveFromCache(uint32 guidLow, WorldSession* session = nullptr)
         {
-            m_onlineMemberCache.erase(guidLow);
+            OnlineMemberList::iterator itr = m_onlineMembers.find(guidLow);
+            if (itr != m_onlineMembers.end() && (!session || itr->second.session == session))
+                m_onlineMembers.erase(itr);
         }
 
         bool IsMemberCacheEnabled() const
@@ -368,6 +377,12 @@ class Guild
     protected:
         void AddRank(std::string const& name,uint32 rights);
 
+        // in world player shown online in the roster
+        Player* GetRosterPlayer(uint32 guidLow) const;
+        // appends the member block, from the member cached serialization when still up to date
+        void AppendRosterMember(WorldPacket& data, MemberSlot& slot, Player* player, bool sendOfficerNote);
+        void SendPendingBroadcasts();
+
         uint32 m_Id;
         std::string m_Name;
         ObjectGuid m_LeaderGuid;
@@ -391,7 +406,33 @@ class Guild
         uint32 m_cacheTimer = CacheExpiryMs;
 
         MemberList members;
-        std::unordered_set<uint32> m_onlineMemberCache;
+
+        // members logged in, with their session, maintained at login and logout
+        struct OnlineMember
+        {
+            WorldSession* session;
+            MemberSlot* slot;
+        };
+        typedef std::unordered_map<uint32, OnlineMember> OnlineMemberList;
+        OnlineMemberList m_onlineMembers;
+
+        // roster block of a member, from the guid up to the zone
+        struct RosterMemberBlock
+        {
+            uint32 revision;
+            bool online;
+            ByteBuffer data;
+        };
+        std::unordered_map<uint32, RosterMemberBlock> m_rosterBlocks;
+
+        // guild events and roster broadcasts of the current world tick
+        struct PendingGuildEvent
+        {
+            GuildEvents event;
+            WorldPacket packet;
+        };
+        std::vector<PendingGuildEvent> m_pendingEvents;
+        bool m_rosterBroadcastPending = false;
 
         /** These are actually ordered lists. The first element is the oldest entry.*/
         std::list<GuildEventLogEntry> m_GuildEventLog;
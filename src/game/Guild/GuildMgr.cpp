@@ -25,6 +25,7 @@
 #include "World.h"
 #include "ObjectMgr.h"
 #include "Player.h"
+#include "WhoListDirectory.h"
 
 #define GUILD_BANK_SAVE_INTERVAL 1 * MINUTE * IN_MILLISECONDS
 
@@ -76,7 +77,9 @@ void GuildMgr::FixupInfernoBanks()
                     if (item)
                     {
                         guild->_Bank->DepositInternal(tab, item);
+                        CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, guildId));
                         CharacterDatabase.PExecute("DELETE FROM `guild_bank` WHERE `guildId` = %u AND `guid` = %u AND `isInferno` = %u", guildId, guid, isInferno);
+                        CharacterDatabase.CommitTransaction();
                     }
                 }
             }
@@ -89,14 +92,19 @@ void GuildMgr::FixupInfernoBanks()
 
 void GuildMgr::AddGuild(Guild* guild)
 {
-    std::lock_guard<std::shared_mutex> guard(m_guildMutex);
-    m_GuildMap[guild->GetId()] = guild;
+    {
+        std::lock_guard<std::shared_mutex> guard(m_guildMutex);
+        m_GuildMap[guild->GetId()] = guild;
 
-    guild->_Bank = new GuildBank{ false };
-	guild->_Bank->SetGuild(guild);
+        guild->_Bank = new GuildBank{ false };
+        guild->_Bank->SetGuild(guild);
+
+        guild->_InfernoBank = new GuildBank{ true };
+        guild->_InfernoBank->SetGuild(guild);
+    }
 
-    guild->_InfernoBank = new GuildBank{ true };
-    guild->_InfernoBank->SetGuild(guild);
+    // the members of a new guild were listed before its name could be found
+    sWhoListDirectory.RenameGuild(guild->GetId(), guild->GetName());
 }
 
 void GuildMgr::RemoveGuild(uint32 guildId)
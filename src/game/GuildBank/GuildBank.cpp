@@ -208,7 +208,7 @@ void GuildBank::SaveToDB()
 
 	b_saveLock = true;
 
-	CharacterDatabase.BeginTransaction();
+	CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, guildid));
 
 	// Save Money
 	if (b_money_changed)
@@ -323,7 +323,7 @@ void GuildBank::SaveToDB()
 void GuildBank::DeleteFromDB()
 {
 	b_saveLock = true;
-	CharacterDatabase.BeginTransaction();
+	CharacterDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_GUILD, guildid));
 	CharacterDatabase.PExecute("DELETE FROM guild_bank WHERE guildid = '%u' AND isInferno = '%u'", guildid, b_infernoBank);
 	CharacterDatabase.PExecute("DELETE FROM guild_bank_log WHERE guildid = '%u' AND isInferno = '%u'", guildid, b_infernoBank);
 	CharacterDatabase.PExecute("DELETE FROM guild_bank_money WHERE guildid = '%u' AND isInferno = '%u'", guildid, b_infernoBank);
@@ -425,9 +425,10 @@ void WorldSession::HandleAuctionSellItem(WorldPacket & recv_data)
 
     pl->LogItem(it, LogItemAction::Auctioned);
 
-    auctionHouse->AddAuction(AH);
-
+    // the auction is indexed with the random suffix of its item
     sAuctionMgr.AddAItem(it);
+
+    auctionHouse->AddAuction(AH);
     pl->MoveItemFromInventory(it->GetBagSlot(), it->GetSlot(), true);
 
     CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
@@ -558,6 +559,7 @@ void WorldSession::HandleAuctionPlaceBid(WorldPacket & recv_data)
 
         auction->bidder = pl->GetGUIDLow();
         auction->bid = price;
+        auctionHouse->UpdateAuction(auction);
 
         if (auction_owner)
             auction_owner->GetSession()->SendAuctionOwnerNotification(auction, false);
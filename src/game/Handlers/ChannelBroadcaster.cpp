@@ -2,11 +2,18 @@
 #include <chrono>
 #include "ChannelBroadcaster.h"
 #include "ChannelMgr.h"
+#include "WorldSession.h"
 #include "World.h"
 
 
-ChannelBroadcaster::ChannelBroadcaster() : MessageQueue(15)
+ChannelBroadcaster::ChannelBroadcaster(uint32 DeliveryThreadsCount) : MessageQueue(15)
 {
+	if (DeliveryThreadsCount)
+	{
+		DeliveryThreads.reset(new ThreadPool(DeliveryThreadsCount, "ChannelDelivery"));
+		DeliveryThreads->start<ThreadPool::MultiQueue>();
+	}
+
 	StartThread();
 }
 
@@ -62,6 +69,47 @@ void ChannelBroadcaster::EnqueueMessage(std::string&& Message, const std::string
 	MessageQueue.enqueue(ChannelMessage{std::move(Message), ChannelName, PlayerGuid, Language, ChannelTeam, bSkipChecks });
 }
 
+void ChannelBroadcaster::Deliver(ChannelMemberSessions const& Members, WorldPacket const* Packet, ChannelMemberMask const& SkippedMembers)
+{
+	uint32 const MembersCount = Members.sessions.size();
+
+	auto SendToRange = [&Members, Packet, &SkippedMembers](uint32 Begin, uint32 End)
+	{
+		for (uint32 i = Begin; i < End; ++i)
+		{
+			if (!SkippedMembers.empty() && (SkippedMembers[i / 64] & (uint64(1) << (i % 64))))
+				continue;
+
+			Members.sessions[i]->SendPacket(Packet);
+		}
+	};
+
+	if (!DeliveryThreads || MembersCount < 2 * DeliveryBatchSize)
+	{
+		SendToRange(0, MembersCount);
+		return;
+	}
+
+	// channels are also written to from the world thread, the pool takes one workload at a time
+	std::lock_guard<std::mutex> Guard(DeliveryLock);
+
+	std::atomic<uint32> NextBatch(0);
+	auto SendBatches = [&NextBatch, &SendToRange, MembersCount]()
+	{
+		uint32 Begin;
+		while ((Begin = NextBatch++ * DeliveryBatchSize) < MembersCount)
+			SendToRange(Begin, std::min(Begin + DeliveryBatchSize, MembersCount));
+	};
+
+	for (size_t i = 0; i < DeliveryThreads->size(); ++i)
+		DeliveryThreads << SendBatches;
+
+	std::future<void> Job = DeliveryThreads->processWorkload();
+	SendBatches();
+	if (Job.valid())
+		Job.wait();
+}
+
 void ChannelBroadcaster::ThreadProc()
 {
 	while (!sWorld.IsStopped())
@@ -3,7 +3,11 @@
 #include "SharedDefines.h"
 #include "ObjectGuid.h"
 #include "Utilities/readerwriterqueue.h"
+#include "ThreadPool.h"
+#include "Channel.h"
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 
 struct ChannelMessage
@@ -21,7 +25,7 @@ class ChannelBroadcaster
 {
 public:
 
-	ChannelBroadcaster();
+	ChannelBroadcaster(uint32 DeliveryThreadsCount);
 	~ChannelBroadcaster();
 
 	void EnableSendingMessages();
@@ -29,6 +33,10 @@ public:
 
 	void EnqueueMessage(std::string&& Message, const std::string& ChannelName, ObjectGuid PlayerGuid, uint32 Language, Team ChannelTeam, bool bSkipChecks);
 
+	// Sends the packet to every member not set in SkippedMembers. Large channels are split in batches
+	// of members which are delivered by the delivery threads, the packet is built once and shared by all of them.
+	void Deliver(ChannelMemberSessions const& Members, WorldPacket const* Packet, ChannelMemberMask const& SkippedMembers);
+
 protected:
 
 	void StartThread();
@@ -39,6 +47,11 @@ protected:
 	moodycamel::ReaderWriterQueue<ChannelMessage> MessageQueue;
 
 	std::thread* Worker = nullptr;
+
+	static constexpr uint32 DeliveryBatchSize = 256;
+
+	std::unique_ptr<ThreadPool> DeliveryThreads;
+	std::mutex DeliveryLock;
 	
 	char CacheLineDelimiter[4096];
 
@@ -41,6 +41,7 @@
 #include "Util.h"
 #include "Language.h"
 #include "Chat.h"
+#include "Channel.h"
 #include "Anticheat.h"
 #include "MasterPlayer.h"
 #include "PlayerBroadcaster.h"
@@ -65,7 +66,11 @@ private:
     ObjectGuid m_guid;
 public:
     LoginQueryHolder(uint32 accountId, ObjectGuid guid)
-        : SqlQueryHolder(guid.GetCounter()), m_accountId(accountId), m_guid(guid) { }
+        : SqlQueryHolder(guid.GetCounter()), m_accountId(accountId), m_guid(guid)
+    {
+        // every query only reads the character's own rows
+        SetParallel(true);
+    }
     ~LoginQueryHolder()
     {
         // Queries should NOT be deleted by user
@@ -503,6 +508,7 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket & recv_data)
         return;
     }
     m_playerLoading = true;
+    m_playerLoadingStart = WorldTimer::getMSTime();
     CharacterDatabase.DelayQueryHolderUnsafe(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
 
@@ -548,6 +554,7 @@ void WorldSession::LoginPlayer(ObjectGuid loginPlayerGuid)
         return;
     }
     m_playerLoading = true;
+    m_playerLoadingStart = WorldTimer::getMSTime();
     CharacterDatabase.DelayQueryHolderUnsafe(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
 
@@ -566,6 +573,8 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
     ObjectGuid playerGuid = holder->GetGuid();
     ASSERT(playerGuid.IsPlayer());
 
+    uint32 loadTime = WorldTimer::getMSTimeDiffToNow(m_playerLoadingStart);
+
     // If the character is online (ALT-F4 logout for example)
     Player *pCurrChar = sObjectAccessor.FindPlayer(playerGuid);
     MasterPlayer* pCurrMasterPlayer = sObjectAccessor.FindMasterPlayer(playerGuid);
@@ -582,6 +591,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
         }
         pCurrChar->GetSession()->SetPlayer(nullptr);
         pCurrChar->SetSession(this);
+        Channel::OnSessionHandoff();
 
         // Need to attach packet bcaster to the new socket
         pCurrChar->m_broadcaster->ChangeSocket(GetSocket());
@@ -643,6 +653,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
     {
         pCurrMasterPlayer->GetSession()->SetMasterPlayer(nullptr);
         pCurrMasterPlayer->SetSession(this);
+        Channel::OnSessionHandoff();
         m_masterPlayer = pCurrMasterPlayer;
     }
     else
@@ -797,7 +808,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
             sSocialMgr.SendFriendStatus(GetMasterPlayer(), FRIEND_ONLINE, GetMasterPlayer()->GetObjectGuid(), true);
 
         if (Guild* guild = sGuildMgr.GetGuildById(pCurrChar->GetGuildId()))
-            guild->AddToCache(GetMasterPlayer()->GetGUIDLow());
+            guild->AddToCache(GetMasterPlayer()->GetGUIDLow(), this);
     }
 
     if (!alreadyOnline)
@@ -887,6 +898,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
 
     m_playerLoading = false;
     m_clientMoverGuid = pCurrChar->GetObjectGuid();
+    sWorld.RecordPlayerLogin(loadTime, WorldTimer::getMSTimeDiffToNow(m_playerLoadingStart));
     delete holder;
     if (alreadyOnline)
     {
@@ -43,6 +43,7 @@
 #include "BattleGroundMgr.h"
 #include "Pet.h"
 #include "SocialMgr.h"
+#include "WhoListDirectory.h"
 #include "Spell.h"
 #include "ZoneScript.h"
 #include "Anticheat.h"
@@ -84,14 +85,10 @@ void WorldSession::HandleRepopRequestOpcode(WorldPacket & /*recv_data*/)
     player->ScheduleRepopAtGraveyard();
 }
 
-class WhoListClientQueryTask
+class WhoListClientQueryTask : public WhoListQuery
 {
 public:
     uint32 accountId;
-    uint32 level_min, level_max, racemask, classmask, zones_count, str_count;
-    uint32 zoneids[10];                                     // 10 is client limit
-    std::wstring str[4];                                    // 4 is client limit
-    std::wstring wplayer_name, wguild_name;
     void operator()()
     {
         WorldSession* sess = sWorld.FindSession(accountId);
@@ -100,138 +97,14 @@ public:
         sess->SetReceivedWhoRequest(false);
         if (!sess->GetPlayer() || !sess->GetPlayer()->IsInWorld())
             return;
-        uint32 clientcount = 0;
-        Team team = sess->GetPlayer()->GetTeam();
-        AccountTypes security = sess->GetSecurity();
-        bool allowTwoSideWhoList = sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
-        AccountTypes gmLevelInWhoList = (AccountTypes)sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST);
-
-        const uint32 zone = sess->GetPlayer()->GetCachedZoneId();
-        const bool notInBattleground = !((zone == 2597) || (zone == 3277) || (zone == 3358));
 
         WorldPacket data(SMSG_WHO, 50);                         // guess size
-        data << uint32(clientcount);                            // clientcount place holder, listed count
-        data << uint32(clientcount);                            // clientcount place holder, online count
-
-        // TODO: Guard Player map
-        HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-        for (const auto& itr : m)
-        {
-            Player* pPlayer = itr.second;
-
-            if (security == SEC_PLAYER)
-            {
-                // player can see member of other team only if CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST
-                if (pPlayer->GetTeam() != team && !allowTwoSideWhoList)
-                    continue;
-
-                // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
-                if (pPlayer->GetSession()->GetSecurity() > gmLevelInWhoList)
-                    continue;
-
-                if (pPlayer->HasGMDisabledSocials())
-                    continue;
-            }
-
-            // do not process players which are not in world
-            if (!pPlayer->IsInWorld())
-                continue;
-
-            // check if target's level is in level range
-            uint32 lvl = pPlayer->GetLevel();
-            if (lvl < level_min || lvl > level_max)
-                continue;
-
-            // check if target is globally visible for player
-            if (!pPlayer->IsVisibleGloballyFor(sess->GetPlayer()))
-                continue;
-
-            // check if class matches classmask
-            uint32 class_ = pPlayer->GetClass();
-            if (!(classmask & (1 << class_)))
-                continue;
-
-            // check if race matches racemask
-            uint32 race = pPlayer->GetRace();
-            if (!(racemask & (1 << race)))
-                continue;
-
-            std::string pname = pPlayer->GetName();
-            std::wstring wpname;
-            wpname.reserve(pname.size());
-            if (!Utf8toWStr(pname, wpname))
-                continue;
-            wstrToLower(wpname);
-
-            if (!(wplayer_name.empty() || wpname.find(wplayer_name) != std::wstring::npos))
-                continue;
-
-            std::string gname = sGuildMgr.GetGuildNameById(pPlayer->GetGuildId());
-            std::wstring wgname;
-            wgname.reserve(gname.size());
-            if (!Utf8toWStr(gname, wgname))
-                continue;
-            wstrToLower(wgname);
-
-            if (!(wguild_name.empty() || wgname.find(wguild_name) != std::wstring::npos))
-                continue;
-
-            uint32 pzoneid = pPlayer->GetCachedZoneId();
-
-            bool z_show = true;
-            for (uint32 i = 0; i < zones_count; ++i)
-            {
-                if (zoneids[i] == pzoneid)
-                {
-                    // World of Warcraft Client Patch 1.7.0 (2005-09-13)
-                    // Using the / who command while in a Battleground instance will now only display players in your instance.
-                    z_show = (zone != pzoneid) || notInBattleground || (sess->GetPlayer()->GetInstanceId() == pPlayer->GetInstanceId());
-                    break;
-                }
-
-                z_show = false;
-            }
-            if (!z_show)
-                continue;
-
-            std::string aname;
-            if (const auto *areaEntry = AreaEntry::GetById(pzoneid))
-            {
-                aname = areaEntry->Name;
-                sObjectMgr.GetAreaLocaleString(areaEntry->Id, sess->GetSessionDbLocaleIndex(), &aname);
-            }
+        data << uint32(0);                                      // clientcount place holder, listed count
+        data << uint32(0);                                      // clientcount place holder, online count
 
-            bool s_show = true;
-            for (uint32 i = 0; i < str_count; ++i)
-            {
-                if (!str[i].empty())
-                {
-                    if (wgname.find(str[i]) != std::wstring::npos ||
-                            wpname.find(str[i]) != std::wstring::npos ||
-                            Utf8FitTo(aname, str[i]))
-                    {
-                        s_show = true;
-                        break;
-                    }
-                    s_show = false;
-                }
-            }
-            if (!s_show)
-                continue;
-
-            data << pname;                                      // player name
-            data << gname;                                      // guild name
-            data << uint32(lvl);                                // player level
-            data << uint32(class_);                             // player class
-            data << uint32(race);                               // player race
-            data << uint32(pzoneid);                            // player zone id
-
-            // 50 is maximum player count sent to client
-            if ((++clientcount) == 49)
-                break;
-        }
+        uint32 clientcount = sWhoListDirectory.BuildWhoList(sess, *this, data);
 
-        uint32 count = m.size();
+        uint32 count = sObjectAccessor.GetPlayers().size();
         data.put(0, clientcount);                               // insert right count, listed count
         data.put(4, count > 49 ? count : clientcount);          // insert right count, online count
 
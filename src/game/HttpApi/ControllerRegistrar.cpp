@@ -1,3 +1,4 @@
+#include "MetricsController.hpp"
 #include "TestController.hpp"
 #include "TransferController.hpp"
 #include "Config.hpp"
@@ -8,6 +9,10 @@ namespace HttpApi
     {
         new TestController();
         new TransferController(sConfig.GetStringDefault("HttpApi.TransferKey", "Gheor"));
+
+        std::string metricsKey = sConfig.GetStringDefault("HttpApi.MetricsKey", "");
+        if (!metricsKey.empty())
+            new MetricsController(metricsKey);
     }
 }
 
@@ -0,0 +1,94 @@
+#include "MetricsController.hpp"
+
+#include "HttpApi/Authorizers/ApiKeyAuthorizer.hpp"
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "Database/DatabaseEnv.h"
+
+using namespace httplib;
+
+namespace HttpApi
+{
+    MetricsController::MetricsController(std::string key)
+    {
+        _authorizer = std::make_unique<ApiKeyAuthorizer>(key.c_str());
+    }
+
+    static void WriteDatabaseMetrics(rapidjson::Writer<rapidjson::StringBuffer>& writer, char const* name, Database& db)
+    {
+        writer.Key(name);
+        writer.StartObject();
+
+        std::vector<SqlDelayThreadStats> shards;
+        db.GetSerialShardStats(shards);
+
+        writer.Key("shards");
+        writer.StartArray();
+        for (const auto& shard : shards)
+        {
+            writer.StartObject();
+            writer.Key("queued");           writer.Uint(shard.queueDepth);
+            writer.Key("oldestQueuedMs");   writer.Uint(shard.oldestQueuedMs);
+            writer.Key("maxExecMs");        writer.Uint(shard.maxExecMs);
+            writer.Key("executed");         writer.Uint64(shard.executed);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        std::vector<SqlStatementReport> report;
+        db.GetStatementStats().GetReport(report, SQL_STATS_SORT_TOTAL_TIME, 0);
+
+        writer.Key("statements");
+        writer.StartArray();
+        for (const auto& entry : report)
+        {
+            writer.StartObject();
+            writer.Key("query");            writer.String(entry.query.c_str());
+            writer.Key("count");            writer.Uint64(entry.count);
+            writer.Key("rows");             writer.Uint64(entry.rows);
+            writer.Key("totalExecUs");      writer.Uint64(entry.totalExecUs);
+            writer.Key("totalQueueUs");     writer.Uint64(entry.totalQueueUs);
+            writer.Key("maxExecUs");        writer.Uint(entry.maxExecUs);
+            writer.Key("p50ExecUs");        writer.Uint64(entry.p50ExecUs);
+            writer.Key("p99ExecUs");        writer.Uint64(entry.p99ExecUs);
+            writer.Key("p99QueueUs");       writer.Uint64(entry.p99QueueUs);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        std::vector<SqlSlowQuerySample> samples;
+        db.GetStatementStats().GetSlowSamples(samples);
+
+        writer.Key("slowQueries");
+        writer.StartArray();
+        for (const auto& sample : samples)
+        {
+            writer.StartObject();
+            writer.Key("time");             writer.Int64(sample.time);
+            writer.Key("execUs");           writer.Uint(sample.execUs);
+            writer.Key("queueUs");          writer.Uint(sample.queueUs);
+            writer.Key("sql");              writer.String(sample.sql.c_str());
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+    }
+
+    void DatabaseMetricsAction(const Request& req, Response& resp)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+        writer.StartObject();
+        WriteDatabaseMetrics(writer, "character", CharacterDatabase);
+        WriteDatabaseMetrics(writer, "world", WorldDatabase);
+        WriteDatabaseMetrics(writer, "login", LoginDatabase);
+        WriteDatabaseMetrics(writer, "logs", LogsDatabase);
+        writer.EndObject();
+
+        resp.set_content(buffer.GetString(), "application/json");
+    }
+}
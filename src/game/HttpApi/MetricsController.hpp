@@ -0,0 +1,22 @@
+#pragma once
+#include "httplib.h"
+
+#include "HttpApi/BaseController.hpp"
+
+namespace HttpApi
+{
+    void DatabaseMetricsAction(const httplib::Request& req, httplib::Response& resp);
+
+    class MetricsController final : public BaseController
+    {
+    public:
+
+        MetricsController(std::string key);
+
+        void RegisterCommands(httplib::Server* server) override
+        {
+            RegisterEndpoint<HttpMethod::Get>("/metrics/db", &DatabaseMetricsAction);
+        }
+
+    };
+}
@@ -53,21 +53,53 @@ void LFGPlayerQueueInfo::CalculateRoles(Classes playerClass)
     roleMask = LFGQueue::CalculateRoles(playerClass);
 
     // Determine role priority
-    for (ClassRoles role : PotentialRoles)
-    {
-        rolePriority.emplace_back(std::pair<ClassRoles, RolesPriority>(role, LFGQueue::getPriority(playerClass, role)));
-    }
+    for (uint32 i = 0; i < LFG_ROLES_COUNT; ++i)
+        rolePriority[i] = LFGQueue::getPriority(playerClass, PotentialRoles[i]);
+}
+
+RolesPriority LFGPlayerQueueInfo::GetRolePriority(ClassRoles role) const
+{
+    uint32 index = LFGQueue::GetRoleIndex(role);
+    return index < LFG_ROLES_COUNT ? rolePriority[index] : LFG_PRIORITY_NONE;
 }
 
-RolesPriority LFGPlayerQueueInfo::GetRolePriority(ClassRoles role)
+uint32 LFGQueue::GetRoleIndex(ClassRoles role)
 {
-    for (const auto& iter : rolePriority)
+    switch (role)
     {
-        if (iter.first == role)
-            return iter.second;
+        case LFG_ROLE_TANK:     return 0;
+        case LFG_ROLE_HEALER:   return 1;
+        case LFG_ROLE_DPS:      return 2;
+        default:                return LFG_ROLES_COUNT;
     }
+}
+
+void LFGQueue::IndexPlayer(ObjectGuid const& guid, LFGPlayerQueueInfo& info)
+{
+    info.joinTime = m_queueClock - std::min<uint64>(info.timeInLFG, m_queueClock);
+
+    LFGAreaQueue& area = m_AreaQueues[std::make_pair(info.areaId, info.team)];
+    area.players.insert(guid);
+    for (uint32 i = 0; i < LFG_ROLES_COUNT; ++i)
+        if (info.roleMask & PotentialRoles[i])
+            area.roles[i].emplace(info.joinTime, guid);
+}
+
+void LFGQueue::UnindexPlayer(ObjectGuid const& guid, LFGPlayerQueueInfo const& info)
+{
+    AreaQueuesMap::iterator area = m_AreaQueues.find(std::make_pair(info.areaId, info.team));
+    if (area == m_AreaQueues.end())
+        return;
+
+    area->second.players.erase(guid);
+    for (auto& bucket : area->second.roles)
+        bucket.erase(std::make_pair(info.joinTime, guid));
+}
 
-    return LFG_PRIORITY_NONE;
+LFGQueue::QueuedPlayersMap::iterator LFGQueue::EraseQueuedPlayer(QueuedPlayersMap::iterator iter)
+{
+    UnindexPlayer(iter->first, iter->second);
+    return m_QueuedPlayers.erase(iter);
 }
 
 // Add group or player into queue. If player has group and he's a leader then whole party will be added to queue.
@@ -101,6 +133,10 @@ void LFGQueue::AddToQueue(Player* leader, uint32 queueAreaID)
     else if (!grp)
     {
         // Add player to queued players list
+        QueuedPlayersMap::iterator queued = m_QueuedPlayers.find(leader->GetObjectGuid());
+        if (queued != m_QueuedPlayers.end())
+            UnindexPlayer(queued->first, queued->second);
+
         LFGPlayerQueueInfo& i_Player = m_QueuedPlayers[leader->GetObjectGuid()];
 
         i_Player.team = leader->GetTeam();
@@ -109,6 +145,7 @@ void LFGQueue::AddToQueue(Player* leader, uint32 queueAreaID)
         i_Player.CalculateRoles(static_cast<Classes>(leader->GetClass()));
         i_Player.name = leader->GetName();
         i_Player.isHardcore = leader->IsHardcore();
+        IndexPlayer(leader->GetObjectGuid(), i_Player);
 
         leader->GetSession()->SendMeetingstoneSetqueue(queueAreaID, MEETINGSTONE_STATUS_JOINED_QUEUE);
     }
@@ -124,7 +161,13 @@ void LFGQueue::RestoreOfflinePlayer(Player* player)
     if (offlinePlr != m_OfflinePlayers.end())
     {
         player->GetSession()->SendMeetingstoneSetqueue(offlinePlr->second.areaId, MEETINGSTONE_STATUS_JOINED_QUEUE);
-        m_QueuedPlayers[player->GetObjectGuid()] = offlinePlr->second;
+        QueuedPlayersMap::iterator queued = m_QueuedPlayers.find(player->GetObjectGuid());
+        if (queued != m_QueuedPlayers.end())
+            UnindexPlayer(queued->first, queued->second);
+
+        LFGPlayerQueueInfo& i_Player = m_QueuedPlayers[player->GetObjectGuid()];
+        i_Player = offlinePlr->second;
+        IndexPlayer(player->GetObjectGuid(), i_Player);
         m_OfflinePlayers.erase(offlinePlr);
     }
     else
@@ -222,6 +265,8 @@ void LFGQueue::Update(uint32 diff)
     if (m_QueuedGroups.empty() && m_QueuedPlayers.empty())
         return;
 
+    m_queueClock += diff;
+
     // Iterate over QueuedPlayersMap to update players timers and remove offline/disconnected players.
     for (QueuedPlayersMap::iterator iter = m_QueuedPlayers.begin(); iter != m_QueuedPlayers.end();)
     {
@@ -231,7 +276,7 @@ void LFGQueue::Update(uint32 diff)
         if (!plr || !plr->IsInWorld())
         {
             m_OfflinePlayers[iter->first] = iter->second;
-            iter = m_QueuedPlayers.erase(iter);
+            iter = EraseQueuedPlayer(iter);
             continue;
         }
 
@@ -267,40 +312,17 @@ void LFGQueue::Update(uint32 diff)
                 break;
             }
 
-            // Iterate over QueuedPlayersMap to find suitable player to join group
-            QueuedPlayersMap::iterator next = m_QueuedPlayers.begin();
-            for (QueuedPlayersMap::iterator qPlayer = next; next != m_QueuedPlayers.end(); qPlayer = next)
+            // Fill the roles the group needs from the queued players of the same dungeon and faction.
+            // Area entries are never erased, so the iterator survives FindRoleToGroup() removing players.
+            AreaQueuesMap::iterator area = m_AreaQueues.find(std::make_pair(qGroup->second.areaId, qGroup->second.team));
+            for (uint32 i = 0; area != m_AreaQueues.end() && i < LFG_ROLES_COUNT && !grp->IsFull(); ++i)
             {
-                // Pre-increment iterator here since FindRoleToGroup() may remove qPlayer
-                // from the map
-                ++next;
-
-                // Check here that players team and areaId they're in queue are same
-                if (qPlayer->second.team == qGroup->second.team &&
-                   qPlayer->second.areaId == qGroup->second.areaId &&
-                    qPlayer->second.isHardcore == qGroup->second.isHardcore)
+                ClassRoles role = PotentialRoles[i];
+                while (!grp->IsFull() && (role & qGroup->second.availableRoles) == role)
                 {
-                    bool groupFound = false;
-                    // Find any role that this player matches and that the group requires. If none,
-                    // then continue onto the next group.
-                    for (ClassRoles role : PotentialRoles)
-                    {
-                        if (!(qPlayer->second.roleMask & role))
-                            continue;
-
-                        if ((role & qGroup->second.availableRoles) == role && FindRoleToGroup(qPlayer->first, grp, role))
-                        {
-                            groupFound = true;
-                            break;
-                        }
-                    }
-
-                    // If we found a group and it's now full, break. If it's not full,
-                    // go onto the next player and maybe they can fill it.
-                    if (groupFound && grp->IsFull())
-                    {
+                    ObjectGuid candidate = FindRoleCandidate(area->second.roles[i], qGroup->second.isHardcore);
+                    if (candidate.IsEmpty() || !FindRoleToGroup(candidate, grp, role))
                         break;
-                    }
                 }
             }
 
@@ -335,14 +357,18 @@ void LFGQueue::Update(uint32 diff)
         // Pick Leader as first target.
         QueuedPlayersMap::iterator leader = m_QueuedPlayers.begin();
 
-        std::list<ObjectGuid> playersInArea;
-        FindInArea(playersInArea, leader->second.areaId, leader->second.team, leader->first);
+        std::set<ObjectGuid> const& playersInArea = m_AreaQueues[std::make_pair(leader->second.areaId, leader->second.team)].players;
 
         // 4 players + the leader
-        if (playersInArea.size() >= _groupSize-1)
+        if (playersInArea.size() >= _groupSize)
         {
+            // first other player of the area, in guid order
+            std::set<ObjectGuid>::const_iterator member = playersInArea.begin();
+            if (*member == leader->first)
+                ++member;
+
             Player* pLeader = sObjectMgr.GetPlayer(leader->first);
-            Player* pMember = sObjectMgr.GetPlayer(playersInArea.front());
+            Player* pMember = sObjectMgr.GetPlayer(*member);
 
             if (!pLeader || !pMember)
             {
@@ -376,6 +402,23 @@ void LFGQueue::Update(uint32 diff)
     }
 }
 
+ObjectGuid LFGQueue::FindRoleCandidate(LFGAreaQueue::RoleBucket const& bucket, bool isHardcore) const
+{
+    // Players that have been in queue longer are ahead for the role, whatever their time priority,
+    // so only the ones that joined first can take it.
+    for (auto const& slot : bucket)
+    {
+        if (slot.first != bucket.begin()->first)
+            break;
+
+        QueuedPlayersMap::const_iterator qPlayer = m_QueuedPlayers.find(slot.second);
+        if (qPlayer != m_QueuedPlayers.end() && qPlayer->second.isHardcore == isHardcore)
+            return slot.second;
+    }
+
+    return ObjectGuid();
+}
+
 // Don't pass playerGuid by ref since we may destroy it in RemovePlayerFromQueue
 bool LFGQueue::FindRoleToGroup(ObjectGuid playerGuid, Group* group, ClassRoles role)
 {
@@ -384,41 +427,6 @@ bool LFGQueue::FindRoleToGroup(ObjectGuid playerGuid, Group* group, ClassRoles r
 
     if (qGroup != m_QueuedGroups.end() && qPlayer != m_QueuedPlayers.end())
     {
-        bool queueTimePriority = qPlayer->second.hasQueuePriority;
-        bool classPriority = qPlayer->second.GetRolePriority(role);
-        // Iterate over QueuedPlayersMap to find if players have been longer in Queue.
-        for (auto& itr : m_QueuedPlayers)
-        {
-            if (qPlayer->first == itr.first)
-                continue;
-
-            // Ignore players queuing for a different dungeon or from opposite factions
-            if (qPlayer->second.areaId != itr.second.areaId || qPlayer->second.team != itr.second.team)
-                continue;
-
-            // Compare priority/queue time to players that can fill the same role
-            if ((itr.second.roleMask & role) == role)
-            {
-                bool otherTimePriority = itr.second.hasQueuePriority;
-                bool otherClassPriority = itr.second.GetRolePriority(role);
-                bool otherLongerInQueue = itr.second.timeInLFG > qPlayer->second.timeInLFG;
-
-                // Another player is more valuable in this role, they have priority
-                if (otherClassPriority > classPriority)
-                    return false;
-
-                // If the other player has time priority and has spent longer in the queue,
-                // they are ahead of us
-                if (otherTimePriority && otherLongerInQueue)
-                    return false;
-
-                // We do not have priority in the queue and they have spent longer
-                // in the queue, that means they are ahead
-                if (!queueTimePriority && otherLongerInQueue)
-                    return false;
-            }
-        }
-
         switch (role)
         {
             case LFG_ROLE_TANK:
@@ -494,7 +502,7 @@ void LFGQueue::RemovePlayerFromQueue(const ObjectGuid& plrGuid, PlayerLeaveMetho
             }
         }
 
-        m_QueuedPlayers.erase(iter);
+        EraseQueuedPlayer(iter);
     }
 }
 
@@ -531,18 +539,6 @@ void LFGQueue::RemoveGroupFromQueue(uint32 groupId, GroupLeaveMethod leaveMethod
     }
 }
 
-void LFGQueue::FindInArea(std::list<ObjectGuid>& players, uint32 area, uint32 team, ObjectGuid const& exclude)
-{
-    for (const auto& itr : m_QueuedPlayers)
-    {
-        if (itr.first == exclude)
-            continue;
-
-        if (itr.second.areaId == area && itr.second.team == team)
-            players.push_back(itr.first);
-    }
-}
-
 void LFGQueue::BuildSetQueuePacket(WorldPacket &data, uint32 areaId, uint8 status)
 {
     data.Initialize(SMSG_MEETINGSTONE_SETQUEUE, 5);
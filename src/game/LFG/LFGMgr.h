@@ -27,6 +27,7 @@
 
 #include <list>
 #include <map>
+#include <set>
 
 #include "Policies/Singleton.h"
 #include "Common.h"
@@ -60,6 +61,7 @@ enum GroupLeaveMethod
 };
 
 #define MAX_DPS_COUNT = 3
+#define LFG_ROLES_COUNT 3                                   // tank, healer, dps
 
 struct LFGPlayerQueueInfo
 {
@@ -70,10 +72,21 @@ struct LFGPlayerQueueInfo
     bool hasQueuePriority;
     bool isHardcore = false;
     std::string name;
-    std::list<std::pair<ClassRoles, RolesPriority>> rolePriority;
+    RolesPriority rolePriority[LFG_ROLES_COUNT];
+    uint64 joinTime;                                        // queue clock minus timeInLFG, orders the role buckets
 
     void CalculateRoles(Classes playerClass);
-    RolesPriority GetRolePriority(ClassRoles role);
+    RolesPriority GetRolePriority(ClassRoles role) const;
+};
+
+// Queued players of one dungeon and team. The role buckets hold everyone able to take the
+// role, longest in queue first, so that finding who may fill a role is a lookup at the front.
+struct LFGAreaQueue
+{
+    typedef std::set<std::pair<uint64 /*joinTime*/, ObjectGuid>> RoleBucket;
+
+    std::set<ObjectGuid> players;
+    RoleBucket roles[LFG_ROLES_COUNT];
 };
 
 struct LFGGroupQueueInfo
@@ -109,6 +122,7 @@ class LFGQueue
         static RolesPriority getPriority(Classes playerClass, ClassRoles playerRoles);
 
         static uint32 GetMaximumDPSSlots() { return 3u; }
+        static uint32 GetRoleIndex(ClassRoles role);
 
     private:
         typedef std::map<ObjectGuid, LFGPlayerQueueInfo> QueuedPlayersMap;
@@ -118,7 +132,17 @@ class LFGQueue
         typedef std::map<uint32, LFGGroupQueueInfo> QueuedGroupsMap;
         QueuedGroupsMap m_QueuedGroups;
 
-        void FindInArea(std::list<ObjectGuid>& players, uint32 area, uint32 team, ObjectGuid const& exclude);
+        // queued players by (area, team), entries are kept once created
+        typedef std::map<std::pair<uint32, uint32>, LFGAreaQueue> AreaQueuesMap;
+        AreaQueuesMap m_AreaQueues;
+        uint64 m_queueClock = 0;                            // sum of the update diffs, timeInLFG is measured against it
+
+        void IndexPlayer(ObjectGuid const& guid, LFGPlayerQueueInfo& info);
+        void UnindexPlayer(ObjectGuid const& guid, LFGPlayerQueueInfo const& info);
+        QueuedPlayersMap::iterator EraseQueuedPlayer(QueuedPlayersMap::iterator iter);
+
+        // first player of the role bucket allowed to join a group of that hardcore mode, empty guid if none
+        ObjectGuid FindRoleCandidate(LFGAreaQueue::RoleBucket const& bucket, bool isHardcore) const;
         bool FindRoleToGroup(ObjectGuid playerGuid, Group* group, ClassRoles role);
 
         uint32 _groupSize = 5;
@@ -1,40 +1,352 @@
 #include "DatabaseLogger.hpp"
 #include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "ByteBuffer.h"
+#include "Log.h"
+#include "Util.h"
 
 DatabaseLogger sDBLogger;
 
+// keep multi-row inserts well under max_allowed_packet
+static size_t const DBLOGGER_MAX_STATEMENT_SIZE = 256 * 1024;
+
+static void AppendRowValue(std::string& out, uint32 value)
+{
+    out += std::to_string(value);
+}
+
+// the value must already be escaped
+static void AppendRowValue(std::string& out, std::string_view value)
+{
+    out += '\'';
+    out += value;
+    out += '\'';
+}
+
+// appends "(value, value, ...)" to a multi-row insert, with no length limit on the values
+template<typename... Values>
+static void AppendRow(std::string& out, Values const&... values)
+{
+    char const* separator = "";
+    out += '(';
+    ((out += separator, AppendRowValue(out, values), separator = ", "), ...);
+    out += ')';
+}
+
+void DatabaseLogger::Start()
+{
+    if (m_running || !sConfig.GetBoolDefault("DatabaseLogger.Enable", false))
+        return;
+
+    m_flushInterval = std::max(sConfig.GetIntDefault("DatabaseLogger.FlushInterval", 1000), 10);
+    m_batchSize = std::max(sConfig.GetIntDefault("DatabaseLogger.BatchSize", 500), 1);
+    uint32 queueSize = std::max(uint32(sConfig.GetIntDefault("DatabaseLogger.QueueSize", 65536)), m_batchSize);
+
+    m_filePath = sConfig.GetStringDefault("DatabaseLogger.File", "");
+    m_fileMaxSize = uint64(sConfig.GetIntDefault("DatabaseLogger.FileMaxSize", 64)) * 1024 * 1024;
+    if (!m_filePath.empty() && !OpenFile())
+        sLog.outError("DatabaseLogger: can not open %s, logging to the logs database instead.", m_filePath.c_str());
+
+    m_queue.reset(new MPSCRingBuffer<DatabaseLogRecord>(queueSize));
+    m_running = true;
+    m_writer = std::thread(&DatabaseLogger::WriterThread, this);
+}
+
+void DatabaseLogger::Stop()
+{
+    if (!m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_wakeLock);
+        m_running = false;
+    }
+    m_wake.notify_one();
+
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
 void DatabaseLogger::LogLoot(const LootLogEntry& log)
 {
-    //For now just log to DB, we can do some pre-processing here later.
-    /*LogsDatabase.PExecute("INSERT INTO `logs_character_loot` (`receiver_name`, `receiver_guid`, `receiver_account_id`, `receiver_ip`, `source_type`, `source_guid`, `source_entry`, `money`, `item_entry`, `item_count`, `loot_type`) "
-        "VALUES('%s', %u, %u, '%s', '%s', %u, %u, %u, %u, %u, '%s')", log.receiverName.c_str(), log.receiverGuid, log.receiverAccountId, log.receiverIp.c_str(), log.sourceType.data(), 
-        log.sourceGuid, log.sourceEntry, log.money, log.itemEntry, log.itemCount, log.lootType.data());*/
+    if (!m_running.load(std::memory_order_relaxed))
+        return;
+
+    DatabaseLogRecord record;
+    record.type = DatabaseLogRecord::TYPE_LOOT;
+    record.loot = log;
+    Push(std::move(record));
 }
 
 void DatabaseLogger::LogCharAction(const CharActionLogEntry& log)
 {
-    /*if (!_maxCharActionId)
+    if (!m_running.load(std::memory_order_relaxed))
+        return;
+
+    if (log.action == LogCharAction::ActionRename && !log.renameInfo.has_value())
+        return;
+
+    DatabaseLogRecord record;
+    record.type = DatabaseLogRecord::TYPE_CHAR_ACTION;
+    record.action = log;
+    Push(std::move(record));
+}
+
+void DatabaseLogger::Push(DatabaseLogRecord&& record)
+{
+    record.time = time(nullptr);
+    if (!m_queue->Push(std::move(record)))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (m_queue->Size() >= m_batchSize)
+        m_wake.notify_one();
+}
+
+DatabaseLoggerStats DatabaseLogger::GetStats() const
+{
+    DatabaseLoggerStats stats;
+    stats.written = m_written;
+    stats.dropped = m_dropped;
+    stats.batches = m_batches;
+    if (m_queue)
+    {
+        stats.queued = m_queue->Size();
+        stats.capacity = m_queue->Capacity();
+    }
+    return stats;
+}
+
+void DatabaseLogger::WriterThread()
+{
+    LogsDatabase.ThreadStart();
+
+    while (m_running)
+    {
+        {
+            std::unique_lock<std::mutex> guard(m_wakeLock);
+            m_wake.wait_for(guard, std::chrono::milliseconds(m_flushInterval), [this]
+            {
+                return !m_running || m_queue->Size() >= m_batchSize;
+            });
+        }
+
+        Drain();
+    }
+
+    // last entries, producers are stopped by now
+    Drain();
+
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    LogsDatabase.ThreadEnd();
+}
+
+void DatabaseLogger::Drain()
+{
+    std::vector<DatabaseLogRecord> batch;
+    batch.reserve(m_batchSize);
+
+    DatabaseLogRecord record;
+    do
+    {
+        batch.clear();
+        while (batch.size() < m_batchSize && m_queue->Pop(record))
+            batch.push_back(std::move(record));
+        m_queue->UpdateSize();
+
+        if (batch.empty())
+            break;
+
+        if (m_file)
+            WriteToFile(batch);
+        else
+            WriteToDatabase(batch);
+
+        m_written.fetch_add(batch.size(), std::memory_order_relaxed);
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+    } while (batch.size() == m_batchSize);
+
+    uint64 dropped = m_dropped;
+    if (dropped != m_droppedReported)
+    {
+        sLog.out(LOG_PERFORMANCE, "DatabaseLogger: " UI64FMTD " entries dropped so far, the log writer can not keep up.", dropped);
+        m_droppedReported = dropped;
+    }
+}
+
+void DatabaseLogger::WriteToDatabase(std::vector<DatabaseLogRecord> const& records)
+{
+    std::string loot;
+    std::string actions;
+    std::string renames;
+
+    // rename rows reference their action, both go in the same transaction
+    auto flushActions = [&actions, &renames]()
+    {
+        if (actions.empty())
+            return;
+
+        LogsDatabase.BeginTransaction();
+        LogsDatabase.Execute(actions.c_str());
+        if (!renames.empty())
+            LogsDatabase.Execute(renames.c_str());
+        LogsDatabase.CommitTransaction();
+
+        actions.clear();
+        renames.clear();
+    };
+
+    for (auto const& record : records)
     {
-        //have to do it this way because auto increment insert results aren't available for async inserts which is what all of our logs are based on.
-        QueryResult* Query = LogsDatabase.Query("SELECT IFNULL(MAX(id), 0) FROM logs_character_action");
-        if (Query != nullptr)
+        switch (record.type)
         {
-			Field* QueryResult = Query->Fetch();
-            _maxCharActionId = QueryResult[0].GetUInt32();
+            case DatabaseLogRecord::TYPE_LOOT:
+            {
+                LootLogEntry const& log = record.loot;
+                std::string name = log.receiverName;
+                std::string ip = log.receiverIp;
+                LogsDatabase.escape_string(name);
+                LogsDatabase.escape_string(ip);
+
+                if (loot.empty())
+                    loot = "INSERT INTO `logs_character_loot` (`receiver_name`, `receiver_guid`, `receiver_account_id`, `receiver_ip`, `source_type`, `source_guid`, `source_entry`, `money`, `item_entry`, `item_count`, `loot_type`) VALUES ";
+                else
+                    loot += ',';
 
-			delete Query;
+                AppendRow(loot, std::string_view(name), log.receiverGuid, log.receiverAccountId, std::string_view(ip),
+                    log.sourceType, log.sourceGuid, log.sourceEntry, log.money, log.itemEntry, log.itemCount, log.lootType);
+
+                if (loot.size() >= DBLOGGER_MAX_STATEMENT_SIZE)
+                {
+                    LogsDatabase.Execute(loot.c_str());
+                    loot.clear();
+                }
+                break;
+            }
+            case DatabaseLogRecord::TYPE_CHAR_ACTION:
+            {
+                CharActionLogEntry const& log = record.action;
+                if (!_maxCharActionId)
+                {
+                    // have to do it this way because auto increment insert results aren't available for async inserts which is what all of our logs are based on.
+                    if (QueryResult* result = LogsDatabase.Query("SELECT IFNULL(MAX(id), 0) FROM logs_character_action"))
+                    {
+                        _maxCharActionId = result->Fetch()[0].GetUInt32();
+                        delete result;
+                    }
+                }
+
+                ++_maxCharActionId;
+
+                if (actions.empty())
+                    actions = "INSERT INTO `logs_character_action` (`id`, `char_guid`, `account_id`, `action`) VALUES ";
+                else
+                    actions += ',';
+
+                AppendRow(actions, _maxCharActionId, log.charGuid, log.accountId, log.action);
+
+                if (log.action == LogCharAction::ActionRename)
+                {
+                    std::string oldName = log.renameInfo->oldName;
+                    std::string newName = log.renameInfo->newName;
+                    LogsDatabase.escape_string(oldName);
+                    LogsDatabase.escape_string(newName);
+
+                    if (renames.empty())
+                        renames = "INSERT INTO `logs_character_action_renames` (`action_id`, `old_name`, `new_name`) VALUES ";
+                    else
+                        renames += ',';
+
+                    AppendRow(renames, _maxCharActionId, std::string_view(oldName), std::string_view(newName));
+                }
+
+                if (actions.size() + renames.size() >= DBLOGGER_MAX_STATEMENT_SIZE)
+                    flushActions();
+                break;
+            }
+            default:
+                break;
         }
     }
 
-    bool saveRename = log.action == LogCharAction::ActionRename;
+    if (!loot.empty())
+        LogsDatabase.Execute(loot.c_str());
+
+    flushActions();
+}
+
+bool DatabaseLogger::OpenFile()
+{
+    m_file = fopen(m_filePath.c_str(), "ab");
+    if (!m_file)
+        return false;
 
-    if (saveRename && !log.renameInfo.has_value())
+    fseek(m_file, 0, SEEK_END);
+    m_fileSize = ftell(m_file);
+    return true;
+}
+
+// Append-only binary log, one record after another:
+// uint32 time, uint8 type, then the entry fields in declaration order (strings are null terminated).
+// The file is renamed to <File>.<timestamp> once it reaches DatabaseLogger.FileMaxSize.
+void DatabaseLogger::WriteToFile(std::vector<DatabaseLogRecord> const& records)
+{
+    ByteBuffer buffer(records.size() * 64);
+    for (auto const& record : records)
+    {
+        buffer << uint32(record.time);
+        buffer << uint8(record.type);
+
+        switch (record.type)
+        {
+            case DatabaseLogRecord::TYPE_LOOT:
+            {
+                LootLogEntry const& log = record.loot;
+                buffer << log.receiverGuid << log.receiverName << log.receiverAccountId << log.receiverIp;
+                buffer << std::string(log.sourceType) << log.sourceGuid << log.sourceEntry;
+                buffer << log.money << log.itemEntry << log.itemCount << std::string(log.lootType);
+                break;
+            }
+            case DatabaseLogRecord::TYPE_CHAR_ACTION:
+            {
+                CharActionLogEntry const& log = record.action;
+                buffer << log.charGuid << log.accountId << std::string(log.action);
+                buffer << uint8(log.renameInfo.has_value());
+                if (log.renameInfo.has_value())
+                    buffer << log.renameInfo->oldName << log.renameInfo->newName;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (buffer.empty())
         return;
 
-    ++_maxCharActionId;
+    if (fwrite(buffer.contents(), 1, buffer.wpos(), m_file) != buffer.wpos())
+        sLog.outError("DatabaseLogger: failed to write " SIZEFMTD " entries to %s.", records.size(), m_filePath.c_str());
+    fflush(m_file);
+
+    m_fileSize += buffer.wpos();
+    if (m_fileMaxSize && m_fileSize >= m_fileMaxSize)
+    {
+        fclose(m_file);
+        m_file = nullptr;
 
-    LogsDatabase.PExecute("INSERT INTO `logs_character_action` (`id`, `char_guid`, `account_id`, `action`) VALUES (%u, %u, %u, '%s')", _maxCharActionId, log.charGuid, log.accountId, log.action.data());
+        std::string rotated = m_filePath + "." + TimeToTimestampStr(time(nullptr));
+        if (rename(m_filePath.c_str(), rotated.c_str()) != 0)
+            sLog.outError("DatabaseLogger: can not rotate %s.", m_filePath.c_str());
 
-    if (saveRename)
-        LogsDatabase.PExecute("INSERT INTO `logs_character_action_renames` (`action_id`, `old_name`, `new_name`) VALUES (%u, '%s', '%s')", _maxCharActionId, log.renameInfo->oldName.c_str(), log.renameInfo->newName.c_str());*/
-}
\ No newline at end of file
+        // if this fails, following entries go to the logs database
+        if (!OpenFile())
+            sLog.outError("DatabaseLogger: can not open %s, logging to the logs database instead.", m_filePath.c_str());
+    }
+}
@@ -1,7 +1,15 @@
 #pragma once
 #include <string_view>
+#include <optional>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "ObjectGuid.h"
+#include "MPSCRingBuffer.h"
 
 #define DEFINE_ENUM_TYPE(pre, name) constexpr std::string_view pre##name = #name;
 
@@ -77,14 +85,74 @@ struct CharActionLogEntry
 };
 
 
+struct DatabaseLogRecord
+{
+    enum Type : uint8
+    {
+        TYPE_NONE           = 0,
+        TYPE_LOOT           = 1,
+        TYPE_CHAR_ACTION    = 2,
+    };
+
+    Type type = TYPE_NONE;
+    time_t time = 0;
+    LootLogEntry loot;
+    CharActionLogEntry action;
+};
+
+struct DatabaseLoggerStats
+{
+    uint64 written = 0;
+    uint64 dropped = 0;                                     // queue full, the writer fell behind
+    uint64 batches = 0;
+    uint32 queued = 0;
+    uint32 capacity = 0;
+};
+
+// Log calls only push the entry to a bounded lock-free queue. A writer thread groups
+// entries into multi-row inserts every DatabaseLogger.FlushInterval ms or BatchSize
+// entries, or appends them to a binary file when DatabaseLogger.File is set.
 class DatabaseLogger
 {
 public:
 
+    void Start();
+    // writes what is still queued, call before the logs database is closed
+    void Stop();
+
     void LogLoot(const LootLogEntry& log);
     void LogCharAction(const CharActionLogEntry& log);
 
+    DatabaseLoggerStats GetStats() const;
+
     uint32 _maxCharActionId = 0;
+
+private:
+    void Push(DatabaseLogRecord&& record);
+    void WriterThread();
+    void Drain();
+    void WriteToDatabase(std::vector<DatabaseLogRecord> const& records);
+    void WriteToFile(std::vector<DatabaseLogRecord> const& records);
+    bool OpenFile();
+
+    std::unique_ptr<MPSCRingBuffer<DatabaseLogRecord>> m_queue;
+    std::thread m_writer;
+    std::atomic<bool> m_running = false;
+    std::mutex m_wakeLock;
+    std::condition_variable m_wake;
+
+    uint32 m_flushInterval = 1000;
+    uint32 m_batchSize = 500;
+
+    std::string m_filePath;
+    uint64 m_fileMaxSize = 0;
+    uint64 m_fileSize = 0;
+    FILE* m_file = nullptr;
+
+    std::atomic<uint64> m_written = 0;
+    std::atomic<uint64> m_dropped = 0;
+    std::atomic<uint64> m_batches = 0;
+    uint64 m_droppedReported = 0;
 };
 
-extern DatabaseLogger sDBLogger;
\ No newline at end of file
+extern DatabaseLogger sDBLogger;
@@ -0,0 +1,170 @@
+#include "LoginQueue.h"
+#include "WorldSession.h"
+
+void LoginQueue::Split(Node* node, Node const* pivot, Node*& left, Node*& right)
+{
+    if (!node)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    if (IsBefore(node, pivot))
+    {
+        Split(node->right, pivot, node->right, right);
+        left = node;
+    }
+    else
+    {
+        Split(node->left, pivot, left, node->left);
+        right = node;
+    }
+
+    UpdateSize(node);
+}
+
+LoginQueue::Node* LoginQueue::Merge(Node* left, Node* right)
+{
+    if (!left || !right)
+        return left ? left : right;
+
+    if (left->heapPriority > right->heapPriority)
+    {
+        left->right = Merge(left->right, right);
+        UpdateSize(left);
+        return left;
+    }
+
+    right->left = Merge(left, right->left);
+    UpdateSize(right);
+    return right;
+}
+
+LoginQueue::Node* LoginQueue::Erase(Node* node, Node const* target)
+{
+    if (node == target)
+        return Merge(node->left, node->right);
+
+    if (IsBefore(target, node))
+        node->left = Erase(node->left, target);
+    else
+        node->right = Erase(node->right, target);
+
+    UpdateSize(node);
+    return node;
+}
+
+uint32 LoginQueue::Add(WorldSession* session, uint32 priority)
+{
+    if (m_nodes.find(session) != m_nodes.end())
+        return GetPosition(session);
+
+    // xorshift, the treap only needs the heap priorities to be spread
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    Node* node = new Node();
+    node->key = int64(priority) - m_ageOffset;
+    node->sequence = m_sequence++;
+    node->heapPriority = m_seed;
+    node->size = 1;
+    node->left = node->right = nullptr;
+    node->session = session;
+
+    Node* left;
+    Node* right;
+    Split(m_root, node, left, right);
+    node->sentPosition = GetSize(left) + 1;
+    m_root = Merge(Merge(left, node), right);
+    m_nodes[session] = node;
+    return node->sentPosition;
+}
+
+bool LoginQueue::Remove(WorldSession* session)
+{
+    auto itr = m_nodes.find(session);
+    if (itr == m_nodes.end())
+        return false;
+
+    Node* node = itr->second;
+    m_root = Erase(m_root, node);
+    m_nodes.erase(itr);
+    delete node;
+    return true;
+}
+
+WorldSession* LoginQueue::PopFront()
+{
+    if (!m_root)
+        return nullptr;
+
+    Node* node = m_root;
+    while (node->left)
+        node = node->left;
+
+    WorldSession* session = node->session;
+    Remove(session);
+    return session;
+}
+
+void LoginQueue::Clear()
+{
+    for (auto const& itr : m_nodes)
+        delete itr.second;
+
+    m_nodes.clear();
+    m_root = nullptr;
+}
+
+uint32 LoginQueue::GetPosition(WorldSession* session) const
+{
+    auto itr = m_nodes.find(session);
+    if (itr == m_nodes.end())
+        return 0;
+
+    Node const* target = itr->second;
+    uint32 position = 1;
+    for (Node const* node = m_root; node;)
+    {
+        if (node == target)
+            return position + GetSize(node->left);
+
+        if (IsBefore(target, node))
+            node = node->left;
+        else
+        {
+            position += GetSize(node->left) + 1;
+            node = node->right;
+        }
+    }
+
+    return 0;
+}
+
+void LoginQueue::SendPositions()
+{
+    // in order walk
+    uint32 position = 0;
+    m_walk.clear();
+    for (Node* node = m_root; node || !m_walk.empty();)
+    {
+        if (node)
+        {
+            m_walk.push_back(node);
+            node = node->left;
+            continue;
+        }
+
+        node = m_walk.back();
+        m_walk.pop_back();
+
+        if (node->sentPosition != ++position)
+        {
+            node->sentPosition = position;
+            node->session->SendAuthWaitQue(position);
+        }
+
+        node = node->right;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+
+#include <unordered_map>
+#include <vector>
+
+class WorldSession;
+
+/// Sessions waiting in the priority login queue, highest priority first and in arrival order
+/// for equal priorities. Kept in a treap whose nodes count their subtree, so that adding,
+/// removing and finding the position of a session are O(log n). Every queued session gains
+/// the same priority over time, which is kept as an offset of the whole queue instead of
+/// being added to every entry. The positions shown to the clients are only sent when they
+/// changed since the last time. Only used from the world thread.
+class LoginQueue
+{
+    public:
+        LoginQueue() : m_ageOffset(0), m_sequence(0), m_seed(0x9E3779B9), m_root(nullptr) {}
+        ~LoginQueue() { Clear(); }
+
+        LoginQueue(LoginQueue const&) = delete;
+        LoginQueue& operator=(LoginQueue const&) = delete;
+
+        // returns the position of the session, which the caller sends to it
+        uint32 Add(WorldSession* session, uint32 priority);
+        bool Remove(WorldSession* session);
+        // removes and returns the first session, nullptr if the queue is empty
+        WorldSession* PopFront();
+        void Clear();
+
+        // every queued session gains that much priority
+        void Age(uint32 priority) { m_ageOffset += priority; }
+
+        // 1 for the first session, 0 if the session is not queued
+        uint32 GetPosition(WorldSession* session) const;
+
+        // sends SMSG_AUTH_RESPONSE to the sessions whose position changed
+        void SendPositions();
+
+        uint32 size() const { return m_nodes.size(); }
+        bool empty() const { return m_nodes.empty(); }
+
+    private:
+        struct Node
+        {
+            int64 key;                                      // priority minus the age offset when added
+            uint64 sequence;
+            uint32 heapPriority;
+            uint32 size;
+            Node* left;
+            Node* right;
+            WorldSession* session;
+            uint32 sentPosition;
+        };
+
+        static bool IsBefore(Node const* a, Node const* b)
+        {
+            return a->key != b->key ? a->key > b->key : a->sequence < b->sequence;
+        }
+        static uint32 GetSize(Node const* node) { return node ? node->size : 0; }
+        static void UpdateSize(Node* node) { node->size = 1 + GetSize(node->left) + GetSize(node->right); }
+
+        // left gets the nodes before pivot, right the others
+        static void Split(Node* node, Node const* pivot, Node*& left, Node*& right);
+        static Node* Merge(Node* left, Node* right);
+        static Node* Erase(Node* node, Node const* target);
+
+        int64 m_ageOffset;
+        uint64 m_sequence;
+        uint32 m_seed;
+        Node* m_root;
+        std::unordered_map<WorldSession*, Node*> m_nodes;
+        std::vector<Node*> m_walk;                          // reused by SendPositions
+};
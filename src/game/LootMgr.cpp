@@ -48,11 +48,80 @@ LootStore LootTemplates_Pickpocketing("pickpocketing_loot_template", "creature p
 LootStore LootTemplates_Reference(    "reference_loot_template",     "reference id",                       false);
 LootStore LootTemplates_Skinning(     "skinning_loot_template",      "creature skinning id",               true);
 
+// Walker alias table, picks one of the weighted outcomes in O(1)
+class LootAliasTable
+{
+public:
+    void Build(std::vector<float> const& weights);
+    uint32 Pick() const;
+
+private:
+    std::vector<float> Probability;                     // chance to keep the rolled outcome instead of its alias
+    std::vector<uint32> Alias;
+};
+
+void LootAliasTable::Build(std::vector<float> const& weights)
+{
+    uint32 const count = weights.size();
+    float total = 0.0f;
+    for (float weight : weights)
+        total += weight;
+
+    Probability.assign(count, 1.0f);
+    Alias.resize(count);
+
+    std::vector<float> scaled(count);
+    std::vector<uint32> small, large;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        Alias[i] = i;
+        scaled[i] = total > 0.0f ? weights[i] * count / total : 1.0f;
+        if (scaled[i] < 1.0f)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32 less = small.back();
+        small.pop_back();
+        uint32 more = large.back();
+        large.pop_back();
+
+        Probability[less] = scaled[less];
+        Alias[less] = more;
+
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0f;
+        if (scaled[more] < 1.0f)
+            small.push_back(more);
+        else
+            large.push_back(more);
+    }
+    // what is left only misses 1 by rounding errors and keeps its outcome
+}
+
+uint32 LootAliasTable::Pick() const
+{
+    uint32 rolled = urand(0, Probability.size() - 1);
+    return rand_norm_f() < Probability[rolled] ? rolled : Alias[rolled];
+}
+
+// Loot teams the group picks are built for
+static Team const LootTeams[] = { TEAM_CROSSFACTION, ALLIANCE, HORDE };
+static uint32 const MAX_LOOT_TEAMS = 3;
+
+static uint32 GetLootTeamIndex(uint32 team)
+{
+    return team == ALLIANCE ? 1 : (team == HORDE ? 2 : 0);
+}
+
 class LootTemplate::LootGroup                               // A set of loot definitions for items (refs are not allowed)
 {
 public:
     LootGroup() : hasConditionalEqualChancedItem(false) {}
     void AddEntry(LootStoreItem& item);                 // Adds an entry to the group (at loading stage)
+    void PrepareRolls();                                // Builds the picks once the group is loaded
     bool HasQuestDrop() const;                          // True if group includes at least 1 quest drop entry
     bool HasQuestDropForPlayer(Player const * player) const;
     // The same for active quests of the player
@@ -69,6 +138,11 @@ private:
 
     LootStoreItem const * Roll(Loot const& loot) const;                 // Rolls an item from the group, returns nullptr if all miss their chances
     bool hasConditionalEqualChancedItem;
+
+    // Picks by loot team, only built when the conditions of the entries do not depend on the looted object.
+    // A single pick is shared by all teams when the entries have no condition.
+    std::vector<LootAliasTable> ExplicitlyChancedPicks; // the outcome after the last entry is no item
+    std::vector<std::vector<uint32>> EqualChancedAllowed;
 };
 
 //Remove all data and free all memory
@@ -185,6 +259,9 @@ void LootStore::LoadLootTable()
 
         delete result;
 
+        for (const auto& itr : m_LootTemplates)
+            itr.second->PrepareRolls();
+
         Verify();                                           // Checks validity of the loot store
     }
 }
@@ -205,6 +282,7 @@ void LootStore::AddLoot(uint32 entry, uint32 itemid, float chanceOrQuestChance,
 
     // Adds current row to the template
     tab->second->AddEntry(storeitem);
+    tab->second->PrepareRolls();
 }
 
 bool LootStore::HaveQuestLootFor(uint32 loot_id) const
@@ -245,7 +323,7 @@ void LootStore::LoadAndCollectLootIds(LootIdSet& ids_set)
         ids_set.insert(itr.first);
 }
 
-void LootStore::CheckLootRefs(LootIdSet* ref_set) const
+void LootStore::CheckLootRefs(LootIdSet* ref_set)
 {
     for (const auto& itr : m_LootTemplates)
         itr.second->CheckLootRefs(ref_set);
@@ -1130,10 +1208,94 @@ void LootTemplate::LootGroup::AddEntry(LootStoreItem& item)
     }
 }
 
+// Whether the entry can drop for the loot team, when its condition does not depend on the looted object
+static bool IsAllowedForLootTeam(LootStoreItem const& item, Team team)
+{
+    if (!item.conditionId)
+        return true;
+
+    ConditionEntry const* condition = sConditionStorage.LookupEntry<ConditionEntry>(item.conditionId);
+    if (!condition)
+        return false;
+
+    Team conditionTeam = condition->GetTeam();
+    return (conditionTeam != ALLIANCE && conditionTeam != HORDE) || conditionTeam == team;
+}
+
+// Conditions checked against the looted object while rolling, see LootStoreItem::AllowedForTeam()
+static bool HasObjectCondition(LootStoreItemList const& items)
+{
+    for (const auto& item : items)
+        if (item.conditionId && ConditionEntry::CanBeUsedWithoutPlayer(item.conditionId))
+            return true;
+
+    return false;
+}
+
+static bool HasCondition(LootStoreItemList const& items)
+{
+    for (const auto& item : items)
+        if (item.conditionId)
+            return true;
+
+    return false;
+}
+
+void LootTemplate::LootGroup::PrepareRolls()
+{
+    ExplicitlyChancedPicks.clear();
+    EqualChancedAllowed.clear();
+
+    if (!ExplicitlyChanced.empty() && !HasObjectCondition(ExplicitlyChanced))
+    {
+        ExplicitlyChancedPicks.resize(HasCondition(ExplicitlyChanced) ? MAX_LOOT_TEAMS : 1);
+        for (uint32 teamIndex = 0; teamIndex < ExplicitlyChancedPicks.size(); ++teamIndex)
+        {
+            // same odds as walking the entries with a single roll below 100
+            std::vector<float> weights;
+            weights.reserve(ExplicitlyChanced.size() + 1);
+            float total = 0.0f;
+            bool sure = false;
+            for (const auto& i : ExplicitlyChanced)
+            {
+                if (sure || !IsAllowedForLootTeam(i, LootTeams[teamIndex]))
+                {
+                    weights.push_back(0.0f);
+                    continue;
+                }
+
+                float reached = i.chance >= 100.0f ? 100.0f : std::min(total + i.chance, 100.0f);
+                weights.push_back(std::max(reached - total, 0.0f));
+                total = std::max(total, reached);
+                sure = i.chance >= 100.0f;
+            }
+            weights.push_back(100.0f - total);
+
+            ExplicitlyChancedPicks[teamIndex].Build(weights);
+        }
+    }
+
+    if (hasConditionalEqualChancedItem && !HasObjectCondition(EqualChanced))
+    {
+        EqualChancedAllowed.resize(MAX_LOOT_TEAMS);
+        for (uint32 teamIndex = 0; teamIndex < MAX_LOOT_TEAMS; ++teamIndex)
+            for (uint32 i = 0; i < EqualChanced.size(); ++i)
+                if (IsAllowedForLootTeam(EqualChanced[i], LootTeams[teamIndex]))
+                    EqualChancedAllowed[teamIndex].push_back(i);
+    }
+}
+
 // Rolls an item from the group, returns nullptr if all miss their chances
 LootStoreItem const * LootTemplate::LootGroup::Roll(Loot const& loot) const
 {
-    if (!ExplicitlyChanced.empty())                         // First explicitly chanced entries are checked
+    if (!ExplicitlyChancedPicks.empty())                    // Entries without conditions on the looted object are picked at once
+    {
+        LootAliasTable const& pick = ExplicitlyChancedPicks.size() > 1 ? ExplicitlyChancedPicks[GetLootTeamIndex(loot.GetTeam())] : ExplicitlyChancedPicks[0];
+        uint32 picked = pick.Pick();
+        if (picked < ExplicitlyChanced.size())
+            return &ExplicitlyChanced[picked];
+    }
+    else if (!ExplicitlyChanced.empty())                    // First explicitly chanced entries are checked
     {
         float Roll = rand_chance_f();
 
@@ -1154,6 +1316,13 @@ LootStoreItem const * LootTemplate::LootGroup::Roll(Loot const& loot) const
     {
         if (!hasConditionalEqualChancedItem || loot.GetTeam() == TEAM_CROSSFACTION)
             return &EqualChanced[irand(0, EqualChanced.size() - 1)];
+        if (!EqualChancedAllowed.empty())
+        {
+            std::vector<uint32> const& allowed = EqualChancedAllowed[GetLootTeamIndex(loot.GetTeam())];
+            if (!allowed.empty())
+                return &EqualChanced[allowed[urand(0, allowed.size() - 1)]];
+            return nullptr;
+        }
         // Select valid loots only, regarding looting group faction
         std::vector<uint32> indexesOk;
         indexesOk.reserve(EqualChanced.size());
@@ -1300,7 +1469,17 @@ void LootTemplate::AddEntry(LootStoreItem& item)
         Groups[item.group - 1].AddEntry(item);              // Adds new entry to the group
     }
     else                                                    // Non-grouped entries and references are stored together
+    {
         Entries.push_back(item);
+        References.push_back(nullptr);                      // Found by CheckLootRefs()
+    }
+}
+
+// Builds the group picks once the template is loaded
+void LootTemplate::PrepareRolls()
+{
+    for (auto& group : Groups)
+        group.PrepareRolls();
 }
 
 // Rolls for every item in the template and adds the rolled items the the loot
@@ -1316,14 +1495,17 @@ void LootTemplate::Process(Loot& loot, LootStore const& store, bool rate, uint8
     }
 
     // Rolling non-grouped items
-    for (const auto& itr : Entries)
+    for (uint32 i = 0; i < Entries.size(); ++i)
     {
+        LootStoreItem const& itr = Entries[i];
         if (!itr.Roll(rate))
             continue;                                       // Bad luck for the entry
 
         if (itr.mincountOrRef < 0)                          // References processing
         {
-            LootTemplate const* Referenced = LootTemplates_Reference.GetLootFor(-itr.mincountOrRef);
+            LootTemplate const* Referenced = References[i];
+            if (!Referenced)
+                Referenced = LootTemplates_Reference.GetLootFor(-itr.mincountOrRef);
 
             if (!Referenced)
                 continue;                                   // Error message already printed at loading stage
@@ -1415,13 +1597,15 @@ void LootTemplate::Verify(LootStore const& lootstore, uint32 id) const
     // TODO: References validity checks
 }
 
-void LootTemplate::CheckLootRefs(LootIdSet* ref_set) const
+void LootTemplate::CheckLootRefs(LootIdSet* ref_set)
 {
-    for (const auto& itr : Entries)
+    for (uint32 i = 0; i < Entries.size(); ++i)
     {
+        LootStoreItem const& itr = Entries[i];
         if (itr.mincountOrRef < 0)
         {
-            if (!LootTemplates_Reference.GetLootFor(-itr.mincountOrRef))
+            References[i] = LootTemplates_Reference.GetLootFor(-itr.mincountOrRef);
+            if (!References[i])
                 LootTemplates_Reference.ReportNotExistedId(-itr.mincountOrRef);
             else if (ref_set)
                 ref_set->erase(-itr.mincountOrRef);
@@ -186,7 +186,7 @@ class LootStore
         void Verify() const;
 
         void LoadAndCollectLootIds(LootIdSet& ids_set);
-        void CheckLootRefs(LootIdSet* ref_set = nullptr) const;// check existence reference and remove it from ref_set
+        void CheckLootRefs(LootIdSet* ref_set = nullptr);   // check existence reference, keep the referenced templates and remove it from ref_set
         void ReportUnusedIds(LootIdSet const& ids_set) const;
         void ReportNotExistedId(uint32 id) const;
 
@@ -218,6 +218,8 @@ class LootTemplate
     public:
         // Adds an entry to the group (at loading stage)
         void AddEntry(LootStoreItem& item);
+        // Builds what rolling needs once the template is loaded
+        void PrepareRolls();
         // Rolls for every item in the template and adds the rolled items the the loot
         void Process(Loot& loot, LootStore const& store, bool rate, uint8 GroupId = 0) const;
 
@@ -228,9 +230,10 @@ class LootTemplate
 
         // Checks integrity of the template
         void Verify(LootStore const& store, uint32 Id) const;
-        void CheckLootRefs(LootIdSet* ref_set) const;
+        void CheckLootRefs(LootIdSet* ref_set);
     private:
         LootStoreItemList Entries;                          // not grouped only
+        std::vector<LootTemplate const*> References;        // referenced template of each entry, nullptr for items
         LootGroups        Groups;                           // groups have own (optimised) processing, grouped entries go there
 };
 
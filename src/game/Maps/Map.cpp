@@ -65,8 +65,7 @@ Map::~Map()
 {
     UnloadAll(true);
 
-    if (!m_scriptSchedule.empty())
-        sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
+    sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.Clear());
 
     if (m_persistentState)
         m_persistentState->SetUsedByMapState(nullptr);         // field pointer can be deleted after this
@@ -861,6 +860,7 @@ void Map::DoUpdate(uint32 maxDiff)
 void Map::Update(uint32 t_diff)
 {
     XScopeStatTimer ScopeStatTimer{ UpdateTimer };
+    ConditionMemoScope conditionMemo;                   // condition results are reused for this tick only
     uint32 updateMapTime = WorldTimer::getMSTime();
     _dynamicTree.update(t_diff);
 
@@ -2416,23 +2416,17 @@ void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, ObjectGuid source
     if (s == scripts.end())
         return;
 
-    ///- Schedule script execution for all scripts in the script map
-    ScriptMap const* s2 = &(s->second);
-    bool immedScript = false;
-
-    std::unique_lock<MapMutexType> lock(m_scriptSchedule_lock);
-    for (ScriptMap::const_iterator iter = s2->begin(); iter != s2->end(); ++iter)
+    ///- Schedule script execution for all steps of the script
+    time_t now = sWorld.GetGameTime();
+    for (ScriptInfo const& script : s->second)
     {
         ScriptAction sa;
         sa.sourceGuid = sourceGuid;
         sa.targetGuid = targetGuid;
 
-        sa.script = &iter->second;
-        m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + iter->first), sa));
-        if (iter->first == 0)
-            immedScript = true;
-
+        sa.script = &script;
         sScriptMgr.IncreaseScheduledScriptsCount();
+        m_scriptSchedule.Schedule(sa, time_t(now + script.delay));
     }
 }
 
@@ -2445,9 +2439,8 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, ObjectGuid
     sa.targetGuid = targetGuid;
 
     sa.script = &script;
-    std::unique_lock<std::mutex> lock(m_scriptSchedule_lock);
-    m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + delay), sa));
     sScriptMgr.IncreaseScheduledScriptsCount();
+    m_scriptSchedule.Schedule(sa, time_t(sWorld.GetGameTime() + delay));
 }
 
 bool Map::ScriptCommandStartDirect(const ScriptInfo& script, WorldObject* source, WorldObject* target)
@@ -2513,34 +2506,19 @@ bool Map::FindScriptFinalTargets(WorldObject*& source, WorldObject*& target, con
 
 void Map::TerminateScript(const ScriptAction& step)
 {
-    for (auto rmItr = m_scriptSchedule.begin(); rmItr != m_scriptSchedule.end();)
-    {
-        if (rmItr->second.IsSameScript(step.script->id, step.sourceGuid, step.targetGuid))
-        {
-            m_scriptSchedule.erase(rmItr++);
-            sScriptMgr.DecreaseScheduledScriptCount();
-        }
-        else
-            ++rmItr;
-    }
+    sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.Terminate(step));
 }
 
 /// Process queued scripts
 void Map::ScriptsProcess()
 {
-    std::unique_lock<std::mutex> lock(m_scriptSchedule_lock);
-
     if (m_scriptSchedule.empty())
         return;
 
-    ///- Process overdue queued scripts
-    ScriptScheduleMap::iterator iter = m_scriptSchedule.begin();
-    // ok as multimap is a *sorted* associative container
-    while (!m_scriptSchedule.empty() && (iter->first <= sWorld.GetGameTime()))
+    ///- Process overdue queued scripts, including the immediate ones they start
+    ScriptAction step;
+    while (m_scriptSchedule.PopDue(sWorld.GetGameTime(), step))
     {
-        ScriptAction const step = iter->second;
-        lock.unlock();
-
         WorldObject* source = nullptr;
         WorldObject* target = nullptr;
 
@@ -2552,21 +2530,11 @@ void Map::ScriptsProcess()
         if (scriptResultOk)
             scriptResultOk = (this->*(m_ScriptCommands[step.script->command]))(*step.script, source, target);
 
-        lock.lock();
+        sScriptMgr.DecreaseScheduledScriptCount();
 
         // Command returns true if we should abort script.
         if (scriptResultOk)
             TerminateScript(step);
-        else
-        {
-            iter = m_scriptSchedule.begin();
-
-            if (iter->second.script == step.script)
-                m_scriptSchedule.erase(iter);
-
-            sScriptMgr.DecreaseScheduledScriptCount();
-        }
-        iter = m_scriptSchedule.begin();
     }
 }
 
@@ -3393,8 +3361,7 @@ void Map::CrashUnload()
     }
     //UnloadAll(true);
 
-    if (!m_scriptSchedule.empty())
-        sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
+    sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.Clear());
 
     if (m_persistentState)
     {
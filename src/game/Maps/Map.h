@@ -41,6 +41,7 @@
 #include "WorldSession.h"
 #include "SQLStorages.h"
 #include "CreatureLinkingMgr.h"
+#include "ScriptSchedule.h"
 
 #include <bitset>
 #include <list>
@@ -490,7 +491,7 @@ class Map : public GridRefManager<NGridType>
         ScriptedEvent* StartScriptedEvent(uint32 id, WorldObject* source, WorldObject* target, uint32 timelimit, uint32 failureCondition, uint32 failureScript, uint32 successCondition, uint32 successScript);
 
         // Adds all commands that are part of the provided script id to the queue.
-        void ScriptsStart(std::map<uint32, std::multimap<uint32, ScriptInfo> > const& scripts, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid);
+        void ScriptsStart(ScriptMapMap const& scripts, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid);
         // Adds the provided command to the queue. Will be handled by ScriptsProcess.
         void ScriptCommandStart(ScriptInfo const& script, uint32 delay, ObjectGuid sourceGuid, ObjectGuid targetGuid);
         // Immediately executes the provided command.
@@ -735,9 +736,7 @@ class Map : public GridRefManager<NGridType>
         mutable std::mutex      i_objectsToRemove_lock;
         std::set<WorldObject *> i_objectsToRemove;
 
-        typedef std::multimap<time_t, ScriptAction> ScriptScheduleMap;
-        mutable MapMutexType      m_scriptSchedule_lock;
-        ScriptScheduleMap m_scriptSchedule;
+        ScriptSchedule m_scriptSchedule;
 
         InstanceData* i_data = nullptr;
         uint32 i_script_id = 0;
@@ -1421,7 +1421,7 @@ bool Map::ScriptCommand_SetPhase(const ScriptInfo& script, WorldObject* source,
         return ShouldAbortScript(script);
     }
 
-    pAI->m_Phase = uiPhase;
+    pAI->SetPhase(uiPhase);
 
     return false;
 }
@@ -1448,11 +1448,11 @@ bool Map::ScriptCommand_SetPhaseRandom(const ScriptInfo& script, WorldObject* so
     uint32 phase4 = script.setPhaseRandom.phase[3];
 
     if (phase4)
-        pAI->m_Phase = RAND(phase1, phase2, phase3, phase4);
+        pAI->SetPhase(RAND(phase1, phase2, phase3, phase4));
     else if (phase3)
-        pAI->m_Phase = RAND(phase1, phase2, phase3);
+        pAI->SetPhase(RAND(phase1, phase2, phase3));
     else
-        pAI->m_Phase = RAND(phase1, phase2);
+        pAI->SetPhase(RAND(phase1, phase2));
 
     return false;
 }
@@ -1473,7 +1473,7 @@ bool Map::ScriptCommand_SetPhaseRange(const ScriptInfo& script, WorldObject* sou
     if (!pAI)
         return ShouldAbortScript(script);
 
-    pAI->m_Phase = urand(script.setPhaseRange.phaseMin, script.setPhaseRange.phaseMax);
+    pAI->SetPhase(urand(script.setPhaseRange.phaseMin, script.setPhaseRange.phaseMax));
 
     return false;
 }
@@ -0,0 +1,207 @@
+#include "ScriptSchedule.h"
+
+#include <algorithm>
+
+void ScriptSchedule::Schedule(ScriptAction const& action, time_t when)
+{
+    Step* step = new Step();
+    step->action = action;
+    step->when = when;
+    step->sequence = m_sequence++;
+    ++m_size;
+
+    step->next = m_incoming.load(std::memory_order_relaxed);
+    while (!m_incoming.compare_exchange_weak(step->next, step, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+void ScriptSchedule::MoveIncoming()
+{
+    for (Step* step = m_incoming.exchange(nullptr, std::memory_order_acquire); step; step = step->next)
+        m_pending.push_back(step);
+}
+
+void ScriptSchedule::Insert(Step* step)
+{
+    uint64 const wheelSpan = uint64(1) << (WHEEL_BITS * WHEEL_LEVELS);
+
+    time_t when = std::max(step->when, m_current);
+    uint64 delta = uint64(when - m_current);
+
+    uint32 level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (uint64(1) << (WHEEL_BITS * (level + 1))))
+        ++level;
+
+    // farther than the wheel goes, parked in its last slot and put back when that one cascades
+    if (delta >= wheelSpan)
+        when = m_current + time_t(wheelSpan - 1);
+
+    Slot& slot = m_wheel[level][(uint64(when) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+    step->next = nullptr;
+    if (slot.tail)
+        slot.tail->next = step;
+    else
+        slot.head = step;
+    slot.tail = step;
+    ++m_wheelCount;
+}
+
+void ScriptSchedule::Cascade(uint32 level)
+{
+    Slot& slot = m_wheel[level][(uint64(m_current) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+    Step* step = slot.head;
+    slot.head = slot.tail = nullptr;
+
+    while (step)
+    {
+        Step* next = step->next;
+        --m_wheelCount;
+        Insert(step);
+        step = next;
+    }
+}
+
+void ScriptSchedule::PushReady(Step* step)
+{
+    m_ready.push_back(step);
+    std::push_heap(m_ready.begin(), m_ready.end(), IsAfter);
+}
+
+void ScriptSchedule::Advance(time_t now)
+{
+    while (m_wheelCount && m_current <= now)
+    {
+        // when a level wraps, the next slot of the level above is spread over the levels below
+        for (uint32 level = 1; level < WHEEL_LEVELS; ++level)
+        {
+            if ((uint64(m_current) >> (WHEEL_BITS * (level - 1))) & (WHEEL_SLOTS - 1))
+                break;
+            Cascade(level);
+        }
+
+        Slot& slot = m_wheel[0][uint64(m_current) & (WHEEL_SLOTS - 1)];
+        for (Step* step = slot.head; step;)
+        {
+            Step* next = step->next;
+            --m_wheelCount;
+            PushReady(step);
+            step = next;
+        }
+        slot.head = slot.tail = nullptr;
+
+        ++m_current;
+    }
+
+    // nothing left to expire in between, no need to walk the idle seconds
+    if (m_current <= now)
+        m_current = now + 1;
+}
+
+bool ScriptSchedule::PopDue(time_t now, ScriptAction& action)
+{
+    Advance(now);
+
+    MoveIncoming();
+    for (Step* step : m_pending)
+    {
+        if (step->when < m_current)
+            PushReady(step);
+        else
+            Insert(step);
+    }
+    m_pending.clear();
+
+    if (m_ready.empty())
+        return false;
+
+    std::pop_heap(m_ready.begin(), m_ready.end(), IsAfter);
+    Step* step = m_ready.back();
+    m_ready.pop_back();
+
+    action = step->action;
+    delete step;
+    --m_size;
+    return true;
+}
+
+uint32 ScriptSchedule::Terminate(ScriptAction const& step)
+{
+    MoveIncoming();
+
+    uint32 count = 0;
+    auto remove = [&](Step* pending)
+    {
+        if (!pending->action.IsSameScript(step.script->id, step.sourceGuid, step.targetGuid))
+            return false;
+
+        delete pending;
+        ++count;
+        return true;
+    };
+
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), remove), m_pending.end());
+
+    uint32 readyCount = count;
+    m_ready.erase(std::remove_if(m_ready.begin(), m_ready.end(), remove), m_ready.end());
+    if (count != readyCount)
+        std::make_heap(m_ready.begin(), m_ready.end(), IsAfter);
+
+    for (auto& level : m_wheel)
+    {
+        for (Slot& slot : level)
+        {
+            Step* last = nullptr;
+            for (Step** link = &slot.head; *link;)
+            {
+                Step* pending = *link;
+                Step* next = pending->next;
+                if (remove(pending))
+                {
+                    *link = next;
+                    --m_wheelCount;
+                }
+                else
+                {
+                    last = pending;
+                    link = &pending->next;
+                }
+            }
+            slot.tail = last;
+        }
+    }
+
+    m_size -= count;
+    return count;
+}
+
+uint32 ScriptSchedule::Clear()
+{
+    MoveIncoming();
+
+    uint32 count = m_pending.size() + m_ready.size();
+    for (Step* step : m_pending)
+        delete step;
+    for (Step* step : m_ready)
+        delete step;
+    m_pending.clear();
+    m_ready.clear();
+
+    for (auto& level : m_wheel)
+    {
+        for (Slot& slot : level)
+        {
+            for (Step* step = slot.head; step;)
+            {
+                Step* next = step->next;
+                delete step;
+                ++count;
+                step = next;
+            }
+            slot.head = slot.tail = nullptr;
+        }
+    }
+    m_wheelCount = 0;
+
+    m_size -= count;
+    return count;
+}
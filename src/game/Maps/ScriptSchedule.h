@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+#include "ScriptMgr.h"
+
+#include <atomic>
+#include <vector>
+
+/// Db script steps waiting to be executed on a map, due at a game time in seconds. They wait
+/// in a hierarchical timing wheel, so scheduling a step and taking the due ones costs the same
+/// whatever the number of pending steps. Steps can be scheduled from any thread: they are
+/// pushed on a lock free stack that the map thread moves into the wheel when it looks for due
+/// steps. Everything else is only called from the map thread.
+class ScriptSchedule
+{
+    public:
+        ScriptSchedule() : m_incoming(nullptr), m_sequence(0), m_size(0), m_current(0), m_wheelCount(0) {}
+        ~ScriptSchedule() { Clear(); }
+
+        ScriptSchedule(ScriptSchedule const&) = delete;
+        ScriptSchedule& operator=(ScriptSchedule const&) = delete;
+
+        void Schedule(ScriptAction const& action, time_t when);
+
+        // next step due at now, by due time then scheduling order, the steps scheduled
+        // meanwhile included
+        bool PopDue(time_t now, ScriptAction& action);
+        // removes the pending steps of the same script, returns how many
+        uint32 Terminate(ScriptAction const& step);
+        // returns the number of removed steps
+        uint32 Clear();
+
+        uint32 size() const { return m_size; }
+        bool empty() const { return !m_size; }
+
+    private:
+        static uint32 const WHEEL_BITS = 6;
+        static uint32 const WHEEL_SLOTS = 1 << WHEEL_BITS;
+        static uint32 const WHEEL_LEVELS = 4;
+
+        struct Step
+        {
+            ScriptAction action;
+            time_t when;
+            uint64 sequence;
+            Step* next;
+        };
+
+        struct Slot
+        {
+            Step* head = nullptr;
+            Step* tail = nullptr;
+        };
+
+        static bool IsAfter(Step const* a, Step const* b)
+        {
+            return a->when != b->when ? a->when > b->when : a->sequence > b->sequence;
+        }
+
+        void MoveIncoming();
+        void Insert(Step* step);
+        void Cascade(uint32 level);
+        void Advance(time_t now);
+        void PushReady(Step* step);
+
+        std::atomic<Step*> m_incoming;                      // newest first
+        std::atomic<uint64> m_sequence;
+        std::atomic<uint32> m_size;
+
+        std::vector<Step*> m_pending;                       // moved from m_incoming, oldest first
+        Slot m_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+        time_t m_current;                                   // next second to expire, every earlier one is in m_ready
+        uint32 m_wheelCount;
+        std::vector<Step*> m_ready;                         // heap of the due steps
+};
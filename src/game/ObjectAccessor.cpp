@@ -33,6 +33,7 @@
 #include "GridNotifiersImpl.h"
 #include "ObjectGuid.h"
 #include "World.h"
+#include "WhoListDirectory.h"
 
 #include <cmath>
 
@@ -310,9 +311,11 @@ void ObjectAccessor::AddObject(Player *player)
 {
     HashMapHolder<Player>::Insert(player);
     playerNameToPlayerPointer[player->GetName()] = player;
+    sWhoListDirectory.AddPlayer(player);
 }
 void ObjectAccessor::RemoveObject(Player *player)
 {
+    sWhoListDirectory.RemovePlayer(player);
     HashMapHolder<Player>::Remove(player);
     playerNameToPlayerPointer.erase(player->GetName());
 }
@@ -9147,6 +9147,8 @@ void ObjectMgr::LoadConditions()
         }
     }
 
+    m_conditionPrograms.Compile();
+
     for (auto& itr : m_QuestTemplatesMap) // needs to be checked after loading conditions
     {
         Quest* qinfo = itr.second.get();
@@ -9164,10 +9166,7 @@ void ObjectMgr::LoadConditions()
 // Check if a player meets condition conditionId
 bool ObjectMgr::IsConditionSatisfied(uint32 conditionId, WorldObject const* target, Map const* map, WorldObject const* source, ConditionSource conditionSourceType) const
 {
-    if (const ConditionEntry* condition = sConditionStorage.LookupEntry<ConditionEntry>(conditionId))
-        return condition->Meets(target, map, source, conditionSourceType);
-
-    return false;
+    return m_conditionPrograms.Evaluate(conditionId, target, map, source, conditionSourceType);
 }
 
 uint32 ObjectMgr::GenerateAuctionID()
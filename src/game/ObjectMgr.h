@@ -1645,6 +1645,7 @@ class ObjectMgr
         ObjectGuidGenerator<HIGHGUID_CORPSE>     m_CorpseGuids;
 
         QuestMap            m_QuestTemplatesMap;
+        ConditionPrograms   m_conditionPrograms;
 
         robin_hood::unordered_map<uint32, std::string> m_fakeNames;
 
@@ -65,6 +65,7 @@
 #include "Spell.h"
 #include "ScriptMgr.h"
 #include "SocialMgr.h"
+#include "WhoListDirectory.h"
 #include "Mail.h"
 #include "WaypointMovementGenerator.h"
 #include "GMTicketMgr.h"
@@ -7673,6 +7674,9 @@ void Player::SetFactionForRace(uint8 race)
 {
     m_team = TeamForRace(race);
     SetFactionTemplateId(GetFactionForRace(race));
+
+    // no-op unless the player is listed and changed team
+    sWhoListDirectory.UpdateTeam(this);
 }
 
 ReputationRank Player::GetReputationRank(uint32 faction) const
@@ -7854,6 +7858,12 @@ void Player::RewardReputation(Quest const *pQuest)
     // TODO: implement reputation spillover
 }
 
+void Player::SetInGuild(uint32 GuildId)
+{
+    SetUInt32Value(PLAYER_GUILDID, GuildId);
+    sWhoListDirectory.UpdateGuild(this);
+}
+
 uint32 Player::GetGuildIdFromDB(ObjectGuid guid)
 {
     uint32 lowguid = guid.GetCounter();
@@ -8032,6 +8042,8 @@ void Player::UpdateZone(uint32 newZone, uint32 newArea)
     }
 
     m_zoneUpdateId    = newZone;
+    if (oldZoneId != newZone)
+        sWhoListDirectory.UpdateZone(this);
     m_zoneUpdateTimer = ZONE_UPDATE_INTERVAL;
 
     // zone changed, so area changed as well, update it
@@ -23689,9 +23701,10 @@ void Player::InterruptSpellsWithCastItem(Item* item)
             }
 
     // Interrupt eventually delayed spells
-    auto i_Events = m_Events.GetEvents().begin();
-    for (; i_Events != m_Events.GetEvents().end(); ++i_Events)
-        if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_Events->second))
+    std::vector<BasicEvent*> events;
+    m_Events.GetEvents(events);
+    for (BasicEvent* basicEvent : events)
+        if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
             if (event && event->GetSpell()->m_CastItem == item)
             {
                 event->GetSpell()->ClearCastItem();
@@ -71,6 +71,7 @@
 #include <stdarg.h>
 #include "SuspiciousStatisticMgr.h"
 #include "PerfStats.h"
+#include "WhoListDirectory.h"
 
 float baseMoveSpeed[MAX_MOVE_TYPE] =
 {
@@ -8492,6 +8493,9 @@ void Unit::SetLevel(uint32 lvl)
 {
     SetUInt32Value(UNIT_FIELD_LEVEL, lvl);
 
+    if (IsPlayer())
+        sWhoListDirectory.UpdateLevel((Player*)this);
+
     // group update
     if ((IsPlayer()) && ((Player*)this)->GetGroup())
         ((Player*)this)->SetGroupUpdateFlag(GROUP_UPDATE_FLAG_LEVEL);
@@ -10567,9 +10571,10 @@ void Unit::InterruptSpellsCastedOnMe(bool killDelayed, bool interruptPositiveSpe
         if (!killDelayed)
             continue;
         // 2/ Interruption des sorts qui ne sont plus reference, mais dont il reste un event (ceux en parcours par exemple)
-        auto i_Events = iter->m_Events.GetEvents().begin();
-        for (; i_Events != iter->m_Events.GetEvents().end(); ++i_Events)
-            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_Events->second))
+        std::vector<BasicEvent*> events;
+        iter->m_Events.GetEvents(events);
+        for (BasicEvent* basicEvent : events)
+            if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
                 if (event && event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
                     if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                         event->GetSpell()->cancel();
@@ -1195,12 +1195,8 @@ void ScriptMgr::LoadScripts(ScriptMapMap& scripts, const char* tablename)
             }
         }
 
-        if (scripts.find(tmp.id) == scripts.end())
-        {
-            ScriptMap emptyMap;
-            scripts[tmp.id] = emptyMap;
-        }
-        scripts[tmp.id].insert(ScriptMap::value_type(tmp.delay, tmp));
+        // rows come ordered by delay
+        scripts[tmp.id].push_back(tmp);
     }
     while (result->NextRow());
 
@@ -1589,9 +1585,9 @@ void ScriptMgr::CheckScriptTexts(ScriptMapMap const& scripts)
     {
         for (ScriptMap::const_iterator itrM = script.second.begin(); itrM != script.second.end(); ++itrM)
         {
-            if (itrM->second.command == SCRIPT_COMMAND_TALK)
+            if (itrM->command == SCRIPT_COMMAND_TALK)
             {
-                for (int i : itrM->second.talk.textId)
+                for (int i : itrM->talk.textId)
                 {
                     if (i && !sObjectMgr.GetBroadcastTextLocale(i))
                         sLog.outErrorDb("Table `broadcast_text` is missing text id %u, used in database script id %u.", i, script.first);
@@ -1138,7 +1138,7 @@ struct ScriptAction
     }
 };
 
-typedef std::multimap<uint32, ScriptInfo> ScriptMap;
+typedef std::vector<ScriptInfo> ScriptMap;                  // steps of a script in delay order
 typedef std::map<uint32, ScriptMap > ScriptMapMap;
 
 extern ScriptMapMap sQuestEndScripts;
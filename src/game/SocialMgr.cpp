@@ -63,6 +63,8 @@ bool PlayerSocial::AddToSocialList(ObjectGuid const& friendGuid, SocialFlag flag
         m_playerSocialMap[friendGuid].Flags |= flag;
         CharacterDatabase.PExecute("INSERT INTO character_social (guid, friend, flags) VALUES ('%u', '%u', '%u')", m_playerGUID.GetCounter(), friendGuid.GetCounter(), flag);
     }
+
+    sSocialMgr.AddSocialLister(friendGuid, m_playerGUID, flag);
     return true;
 }
 
@@ -72,6 +74,8 @@ void PlayerSocial::RemoveFromSocialList(ObjectGuid const& friendGuid, SocialFlag
     if (itr == m_playerSocialMap.end())                     // not exist
         return;
 
+    sSocialMgr.RemoveSocialLister(friendGuid, m_playerGUID, itr->second.Flags & flag);
+
     itr->second.Flags &= ~flag;
 
     if (!itr->second.Flags)
@@ -249,21 +253,21 @@ void SocialMgr::BroadcastToFriendListers(MasterPlayer *player, WorldPacket *pack
     bool allowTwoSideWhoList = sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
 
     std::shared_lock<std::shared_mutex> guard(_socialMapLock);
-    for (auto const& itr : m_socialMap)
+    auto const listers = m_friendListers.find(guid);
+    if (listers == m_friendListers.end())
+        return;
+
+    for (auto const& listerGuid : listers->second)
     {
-        auto const itr2 = itr.second.m_playerSocialMap.find(guid);
-        if (itr2 != itr.second.m_playerSocialMap.end() && (itr2->second.Flags & SOCIAL_FLAG_FRIEND))
-        {
-            MasterPlayer* pFriend = ObjectAccessor::FindMasterPlayer(itr.first);
-
-            // PLAYER see his team only and PLAYER can't see MODERATOR, GAME MASTER, ADMINISTRATOR characters
-            // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
-            if (pFriend &&
-                    (pFriend->GetSession()->GetSecurity() > SEC_PLAYER ||
-                     ((pFriend->GetTeam() == team || allowTwoSideWhoList) && security <= gmLevelInWhoList)) &&
-                    player->IsVisibleGloballyFor(pFriend))
-                pFriend->GetSession()->SendPacket(packet);
-        }
+        MasterPlayer* pFriend = ObjectAccessor::FindMasterPlayer(listerGuid);
+
+        // PLAYER see his team only and PLAYER can't see MODERATOR, GAME MASTER, ADMINISTRATOR characters
+        // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
+        if (pFriend &&
+                (pFriend->GetSession()->GetSecurity() > SEC_PLAYER ||
+                 ((pFriend->GetTeam() == team || allowTwoSideWhoList) && security <= gmLevelInWhoList)) &&
+                player->IsVisibleGloballyFor(pFriend))
+            pFriend->GetSession()->SendPacket(packet);
     }
 }
 
@@ -302,6 +306,7 @@ PlayerSocial *SocialMgr::LoadFromDB(QueryResult *result, ObjectGuid const& guid)
             continue;
 
         social->m_playerSocialMap[friendGuid] = FriendInfo(flags);
+        IndexSocialLister(friendGuid, guid, flags);
 
         if (flags & SOCIAL_FLAG_IGNORED)
             ignoreCounter++;
@@ -315,5 +320,57 @@ PlayerSocial *SocialMgr::LoadFromDB(QueryResult *result, ObjectGuid const& guid)
 void SocialMgr::RemovePlayerSocial(ObjectGuid const& guid)
 {
     std::unique_lock<std::shared_mutex> guard(_socialMapLock);
-    m_socialMap.erase(guid);
+    auto const itr = m_socialMap.find(guid);
+    if (itr == m_socialMap.end())
+        return;
+
+    for (auto const& entry : itr->second.m_playerSocialMap)
+        UnindexSocialLister(entry.first, guid, entry.second.Flags);
+
+    m_socialMap.erase(itr);
+}
+
+void SocialMgr::AddSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags)
+{
+    if (!(flags & (SOCIAL_FLAG_FRIEND | SOCIAL_FLAG_IGNORED)))
+        return;
+
+    std::unique_lock<std::shared_mutex> guard(_socialMapLock);
+    IndexSocialLister(socialGuid, listerGuid, flags);
+}
+
+void SocialMgr::RemoveSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags)
+{
+    if (!(flags & (SOCIAL_FLAG_FRIEND | SOCIAL_FLAG_IGNORED)))
+        return;
+
+    std::unique_lock<std::shared_mutex> guard(_socialMapLock);
+    UnindexSocialLister(socialGuid, listerGuid, flags);
+}
+
+void SocialMgr::IndexSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags)
+{
+    if (flags & SOCIAL_FLAG_FRIEND)
+        m_friendListers[socialGuid].insert(listerGuid);
+    if (flags & SOCIAL_FLAG_IGNORED)
+        m_ignorers[socialGuid].insert(listerGuid);
+}
+
+void SocialMgr::UnindexSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags)
+{
+    if (flags & SOCIAL_FLAG_FRIEND)
+        EraseLister(m_friendListers, socialGuid, listerGuid);
+    if (flags & SOCIAL_FLAG_IGNORED)
+        EraseLister(m_ignorers, socialGuid, listerGuid);
+}
+
+void SocialMgr::EraseLister(SocialListersMap& listersMap, ObjectGuid const& socialGuid, ObjectGuid const& listerGuid)
+{
+    auto const listers = listersMap.find(socialGuid);
+    if (listers == listersMap.end())
+        return;
+
+    listers->second.erase(listerGuid);
+    if (listers->second.empty())
+        listersMap.erase(listers);
 }
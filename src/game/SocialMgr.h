@@ -133,6 +133,7 @@ class PlayerSocial
 
 class SocialMgr
 {
+    friend class PlayerSocial;
     public:
         // Misc
         void RemovePlayerSocial(ObjectGuid const& guid);
@@ -143,13 +144,40 @@ class SocialMgr
         void SendFriendStatus(MasterPlayer *player, FriendsResult result, ObjectGuid const& friendGuid, bool broadcast);
         void BroadcastToFriendListers(MasterPlayer *player, WorldPacket *packet);
 
+        // calls visitor with the guid of every loaded player ignoring this one
+        template <typename Visitor>
+        void VisitIgnorers(ObjectGuid const& guid, Visitor const& visitor)
+        {
+            std::shared_lock<std::shared_mutex> guard(_socialMapLock);
+            auto const ignorers = m_ignorers.find(guid);
+            if (ignorers == m_ignorers.end())
+                return;
+
+            for (auto const& ignorerGuid : ignorers->second)
+                visitor(ignorerGuid);
+        }
+
         // Loading
         PlayerSocial *LoadFromDB(QueryResult *result, ObjectGuid const& guid);
 
     private:
+        typedef std::unordered_map<ObjectGuid, ObjectGuidSet> SocialListersMap;
+
+        // keep the reverse indexes in sync with the friend and ignore flags of a social list entry
+        void AddSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags);
+        void RemoveSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags);
+        void IndexSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags);
+        void UnindexSocialLister(ObjectGuid const& socialGuid, ObjectGuid const& listerGuid, uint32 flags);
+        static void EraseLister(SocialListersMap& listersMap, ObjectGuid const& socialGuid, ObjectGuid const& listerGuid);
+
         typedef std::map<ObjectGuid, PlayerSocial> SocialMap;
         SocialMap m_socialMap;
 
+        // friend guid -> guids of the loaded players having him in their friend list
+        SocialListersMap m_friendListers;
+        // ignored guid -> guids of the loaded players having him in their ignore list
+        SocialListersMap m_ignorers;
+
         std::shared_mutex _socialMapLock;
 };
 
@@ -0,0 +1,434 @@
+#include "WhoListDirectory.h"
+#include "Player.h"
+#include "World.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "ObjectMgr.h"
+#include "GuildMgr.h"
+#include "Util.h"
+
+WhoListDirectory sWhoListDirectory;
+
+uint32 WhoListDirectory::GetShardIndex(Player* player)
+{
+    return player->GetTeam() == HORDE ? SHARD_HORDE : SHARD_ALLIANCE;
+}
+
+void WhoListDirectory::SetGuild(Entry& entry, uint32 guildId)
+{
+    entry.guildId = guildId;
+    entry.guildName = guildId ? sGuildMgr.GetGuildNameById(guildId) : "";
+    entry.wguildName.clear();
+    if (Utf8toWStr(entry.guildName, entry.wguildName))
+        wstrToLower(entry.wguildName);
+}
+
+WhoListDirectory::Shard* WhoListDirectory::FindShard(Player* player)
+{
+    std::lock_guard<std::mutex> guard(m_playerShardsLock);
+    auto itr = m_playerShards.find(player->GetObjectGuid());
+    return itr != m_playerShards.end() ? &m_shards[itr->second] : nullptr;
+}
+
+void WhoListDirectory::AddPlayer(Player* player)
+{
+    Entry entry;
+    entry.player = player;
+    entry.name = player->GetName();
+    if (!Utf8toWStr(entry.name, entry.wname))
+        return;
+    wstrToLower(entry.wname);
+    SetGuild(entry, player->GetGuildId());
+    entry.level = std::min<uint32>(player->GetLevel(), PLAYER_STRONG_MAX_LEVEL);
+    entry.zoneId = player->GetCachedZoneId();
+
+    uint32 shardIndex = GetShardIndex(player);
+    {
+        std::lock_guard<std::mutex> guard(m_playerShardsLock);
+        if (!m_playerShards.emplace(player->GetObjectGuid(), shardIndex).second)
+            return;
+    }
+
+    Shard& shard = m_shards[shardIndex];
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto result = shard.entries.emplace(player->GetObjectGuid(), std::move(entry));
+    if (!result.second)
+        return;
+
+    Entry* added = &result.first->second;
+    shard.levels[added->level].insert(added);
+    shard.zones[added->zoneId].insert(added);
+    for (size_t i = 0; i < added->wname.size(); ++i)
+        shard.nameSuffixes.emplace(added->wname.substr(i), added);
+}
+
+void WhoListDirectory::RemovePlayer(Player* player)
+{
+    Shard* shardPtr;
+    {
+        std::lock_guard<std::mutex> guard(m_playerShardsLock);
+        auto itr = m_playerShards.find(player->GetObjectGuid());
+        if (itr == m_playerShards.end())
+            return;
+
+        shardPtr = &m_shards[itr->second];
+        m_playerShards.erase(itr);
+    }
+
+    Shard& shard = *shardPtr;
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto itr = shard.entries.find(player->GetObjectGuid());
+    if (itr == shard.entries.end())
+        return;
+
+    Entry* entry = &itr->second;
+    shard.levels[entry->level].erase(entry);
+
+    auto zone = shard.zones.find(entry->zoneId);
+    if (zone != shard.zones.end())
+    {
+        zone->second.erase(entry);
+        if (zone->second.empty())
+            shard.zones.erase(zone);
+    }
+
+    for (size_t i = 0; i < entry->wname.size(); ++i)
+    {
+        auto bounds = shard.nameSuffixes.equal_range(entry->wname.substr(i));
+        for (auto suffix = bounds.first; suffix != bounds.second; ++suffix)
+        {
+            if (suffix->second == entry)
+            {
+                shard.nameSuffixes.erase(suffix);
+                break;
+            }
+        }
+    }
+
+    shard.entries.erase(itr);
+}
+
+void WhoListDirectory::UpdateLevel(Player* player)
+{
+    Shard* shardPtr = FindShard(player);
+    if (!shardPtr)
+        return;
+
+    Shard& shard = *shardPtr;
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto itr = shard.entries.find(player->GetObjectGuid());
+    if (itr == shard.entries.end())
+        return;
+
+    Entry* entry = &itr->second;
+    uint32 level = std::min<uint32>(player->GetLevel(), PLAYER_STRONG_MAX_LEVEL);
+    if (entry->level == level)
+        return;
+
+    shard.levels[entry->level].erase(entry);
+    entry->level = level;
+    shard.levels[entry->level].insert(entry);
+}
+
+void WhoListDirectory::UpdateZone(Player* player)
+{
+    Shard* shardPtr = FindShard(player);
+    if (!shardPtr)
+        return;
+
+    Shard& shard = *shardPtr;
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto itr = shard.entries.find(player->GetObjectGuid());
+    if (itr == shard.entries.end())
+        return;
+
+    Entry* entry = &itr->second;
+    uint32 zoneId = player->GetCachedZoneId();
+    if (entry->zoneId == zoneId)
+        return;
+
+    auto zone = shard.zones.find(entry->zoneId);
+    if (zone != shard.zones.end())
+    {
+        zone->second.erase(entry);
+        if (zone->second.empty())
+            shard.zones.erase(zone);
+    }
+
+    entry->zoneId = zoneId;
+    shard.zones[entry->zoneId].insert(entry);
+}
+
+void WhoListDirectory::UpdateGuild(Player* player)
+{
+    Shard* shardPtr = FindShard(player);
+    if (!shardPtr)
+        return;
+
+    Shard& shard = *shardPtr;
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto itr = shard.entries.find(player->GetObjectGuid());
+    if (itr != shard.entries.end() && itr->second.guildId != player->GetGuildId())
+        SetGuild(itr->second, player->GetGuildId());
+}
+
+void WhoListDirectory::UpdateTeam(Player* player)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_playerShardsLock);
+        auto itr = m_playerShards.find(player->GetObjectGuid());
+        if (itr == m_playerShards.end() || itr->second == GetShardIndex(player))
+            return;
+    }
+
+    RemovePlayer(player);
+    AddPlayer(player);
+}
+
+void WhoListDirectory::RenameGuild(uint32 guildId, std::string const& name)
+{
+    std::wstring wname;
+    if (Utf8toWStr(name, wname))
+        wstrToLower(wname);
+
+    for (auto& shard : m_shards)
+    {
+        std::unique_lock<std::shared_mutex> guard(shard.lock);
+        for (auto& itr : shard.entries)
+        {
+            if (itr.second.guildId != guildId)
+                continue;
+
+            itr.second.guildName = name;
+            itr.second.wguildName = wname;
+        }
+    }
+}
+
+void WhoListDirectory::SelectCandidates(Shard& shard, WhoListQuery const& query, std::vector<Entry*>& candidates)
+{
+    // the smallest of the level, zone and name lookups is scanned, every filter is checked afterwards
+    size_t best = shard.entries.size();
+    enum { SOURCE_ALL, SOURCE_LEVEL, SOURCE_ZONE, SOURCE_NAME } source = SOURCE_ALL;
+
+    uint32 levelMax = std::min<uint32>(query.level_max, PLAYER_STRONG_MAX_LEVEL);
+    if (query.level_min > levelMax)
+        return;
+
+    size_t count = 0;
+    for (uint32 level = query.level_min; level <= levelMax; ++level)
+        count += shard.levels[level].size();
+    if (count < best)
+    {
+        best = count;
+        source = SOURCE_LEVEL;
+    }
+
+    std::unordered_set<uint32> zoneIds(query.zoneids, query.zoneids + query.zones_count);
+    if (!zoneIds.empty())
+    {
+        count = 0;
+        for (const auto zoneId : zoneIds)
+        {
+            auto zone = shard.zones.find(zoneId);
+            if (zone != shard.zones.end())
+                count += zone->second.size();
+        }
+
+        if (count < best)
+        {
+            best = count;
+            source = SOURCE_ZONE;
+        }
+    }
+
+    auto nameBegin = shard.nameSuffixes.end();
+    auto nameEnd = shard.nameSuffixes.end();
+    if (!query.wplayer_name.empty())
+    {
+        // every suffix starting with the searched text is a name containing it
+        count = 0;
+        nameBegin = shard.nameSuffixes.lower_bound(query.wplayer_name);
+        for (nameEnd = nameBegin; nameEnd != shard.nameSuffixes.end() && count <= best; ++nameEnd, ++count)
+            if (nameEnd->first.compare(0, query.wplayer_name.size(), query.wplayer_name) != 0)
+                break;
+
+        if (count < best)
+        {
+            best = count;
+            source = SOURCE_NAME;
+        }
+    }
+
+    candidates.reserve(best);
+    switch (source)
+    {
+        case SOURCE_ALL:
+            for (auto& itr : shard.entries)
+                candidates.push_back(&itr.second);
+            break;
+        case SOURCE_LEVEL:
+            for (uint32 level = query.level_min; level <= levelMax; ++level)
+                candidates.insert(candidates.end(), shard.levels[level].begin(), shard.levels[level].end());
+            break;
+        case SOURCE_ZONE:
+            for (const auto zoneId : zoneIds)
+            {
+                auto zone = shard.zones.find(zoneId);
+                if (zone != shard.zones.end())
+                    candidates.insert(candidates.end(), zone->second.begin(), zone->second.end());
+            }
+            break;
+        case SOURCE_NAME:
+            for (auto itr = nameBegin; itr != nameEnd; ++itr)
+                candidates.push_back(itr->second);
+            // a name containing the text twice has two matching suffixes
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            break;
+    }
+}
+
+uint32 WhoListDirectory::BuildWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data)
+{
+    Player* searcher = session->GetPlayer();
+    uint32 clientcount = 0;
+    Team team = searcher->GetTeam();
+    AccountTypes security = session->GetSecurity();
+    bool allowTwoSideWhoList = sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
+    AccountTypes gmLevelInWhoList = (AccountTypes)sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST);
+
+    const uint32 zone = searcher->GetCachedZoneId();
+    const bool notInBattleground = !((zone == 2597) || (zone == 3277) || (zone == 3358));
+
+    std::vector<Entry*> candidates;
+
+    // own team first
+    uint32 ownShard = GetShardIndex(searcher);
+    for (uint32 s = 0; s < MAX_SHARDS; ++s)
+    {
+        uint32 shardIndex = (ownShard + s) % MAX_SHARDS;
+
+        // player can see member of other team only if CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST
+        if (shardIndex != ownShard && security == SEC_PLAYER && !allowTwoSideWhoList)
+            continue;
+
+        Shard& shard = m_shards[shardIndex];
+        std::shared_lock<std::shared_mutex> guard(shard.lock);
+
+        candidates.clear();
+        SelectCandidates(shard, query, candidates);
+
+        for (const auto entry : candidates)
+        {
+            Player* pPlayer = entry->player;
+
+            if (security == SEC_PLAYER)
+            {
+                if (pPlayer->GetTeam() != team && !allowTwoSideWhoList)
+                    continue;
+
+                // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
+                if (pPlayer->GetSession()->GetSecurity() > gmLevelInWhoList)
+                    continue;
+
+                if (pPlayer->HasGMDisabledSocials())
+                    continue;
+            }
+
+            // do not process players which are not in world
+            if (!pPlayer->IsInWorld())
+                continue;
+
+            // check if target's level is in level range
+            if (entry->level < query.level_min || entry->level > query.level_max)
+                continue;
+
+            // check if target is globally visible for player
+            if (!pPlayer->IsVisibleGloballyFor(searcher))
+                continue;
+
+            // check if class matches classmask
+            uint32 class_ = pPlayer->GetClass();
+            if (!(query.classmask & (1 << class_)))
+                continue;
+
+            // check if race matches racemask
+            uint32 race = pPlayer->GetRace();
+            if (!(query.racemask & (1 << race)))
+                continue;
+
+            if (!(query.wplayer_name.empty() || entry->wname.find(query.wplayer_name) != std::wstring::npos))
+                continue;
+
+            if (!(query.wguild_name.empty() || entry->wguildName.find(query.wguild_name) != std::wstring::npos))
+                continue;
+
+            uint32 pzoneid = entry->zoneId;
+
+            bool z_show = true;
+            for (uint32 i = 0; i < query.zones_count; ++i)
+            {
+                if (query.zoneids[i] == pzoneid)
+                {
+                    // World of Warcraft Client Patch 1.7.0 (2005-09-13)
+                    // Using the / who command while in a Battleground instance will now only display players in your instance.
+                    z_show = (zone != pzoneid) || notInBattleground || (searcher->GetInstanceId() == pPlayer->GetInstanceId());
+                    break;
+                }
+
+                z_show = false;
+            }
+            if (!z_show)
+                continue;
+
+            bool s_show = true;
+            std::string aname;
+            bool areaNameLoaded = false;
+            for (uint32 i = 0; i < query.str_count; ++i)
+            {
+                if (!query.str[i].empty())
+                {
+                    if (!areaNameLoaded)
+                    {
+                        if (const auto *areaEntry = AreaEntry::GetById(pzoneid))
+                        {
+                            aname = areaEntry->Name;
+                            sObjectMgr.GetAreaLocaleString(areaEntry->Id, session->GetSessionDbLocaleIndex(), &aname);
+                        }
+                        areaNameLoaded = true;
+                    }
+
+                    if (entry->wguildName.find(query.str[i]) != std::wstring::npos ||
+                            entry->wname.find(query.str[i]) != std::wstring::npos ||
+                            Utf8FitTo(aname, query.str[i]))
+                    {
+                        s_show = true;
+                        break;
+                    }
+                    s_show = false;
+                }
+            }
+            if (!s_show)
+                continue;
+
+            data << entry->name;                                // player name
+            data << entry->guildName;                           // guild name
+            data << uint32(entry->level);                       // player level
+            data << uint32(class_);                             // player class
+            data << uint32(race);                               // player race
+            data << uint32(pzoneid);                            // player zone id
+
+            // 50 is maximum player count sent to client
+            if ((++clientcount) == 49)
+                return clientcount;
+        }
+    }
+
+    return clientcount;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common.h"
+#include "ObjectGuid.h"
+#include "DBCEnums.h"
+
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+class Player;
+class WorldPacket;
+class WorldSession;
+
+struct WhoListQuery
+{
+    uint32 level_min, level_max, racemask, classmask, zones_count, str_count;
+    uint32 zoneids[10];                                     // 10 is client limit
+    std::wstring str[4];                                    // 4 is client limit
+    std::wstring wplayer_name, wguild_name;
+};
+
+/// Online players as seen by /who, with their lowercased player and guild names, bucketed
+/// by zone and level and with an index over every suffix of the names, so that substring
+/// searches on the name are prefix lookups. Kept up to date when players log in or out and
+/// when their level, zone, guild or team changes. One shard per team, each with its own lock
+/// as updates come from the map threads while /who runs from the async tasks.
+class WhoListDirectory
+{
+    public:
+        void AddPlayer(Player* player);
+        void RemovePlayer(Player* player);
+
+        void UpdateLevel(Player* player);
+        void UpdateZone(Player* player);
+        void UpdateGuild(Player* player);
+        // moves the player to the shard of its new team
+        void UpdateTeam(Player* player);
+        // also called when a guild is registered, its members joined before its name could be found
+        void RenameGuild(uint32 guildId, std::string const& name);
+
+        // appends the matching players to the SMSG_WHO packet, returns how many were listed
+        uint32 BuildWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data);
+
+    private:
+        struct Entry
+        {
+            Player* player;
+            std::string name;
+            std::wstring wname;
+            uint32 guildId;
+            std::string guildName;
+            std::wstring wguildName;
+            uint32 level;
+            uint32 zoneId;
+        };
+        typedef std::unordered_set<Entry*> EntrySet;
+
+        struct Shard
+        {
+            std::shared_mutex lock;
+            std::unordered_map<ObjectGuid, Entry> entries;
+            std::unordered_map<uint32, EntrySet> zones;
+            EntrySet levels[PLAYER_STRONG_MAX_LEVEL + 1];
+            std::multimap<std::wstring, Entry*> nameSuffixes;
+        };
+
+        enum { SHARD_ALLIANCE, SHARD_HORDE, MAX_SHARDS };
+
+        static uint32 GetShardIndex(Player* player);
+        static void SetGuild(Entry& entry, uint32 guildId);
+        void SelectCandidates(Shard& shard, WhoListQuery const& query, std::vector<Entry*>& candidates);
+        // the shard the player was added to, its team may have changed since
+        Shard* FindShard(Player* player);
+
+        Shard m_shards[MAX_SHARDS];
+        std::unordered_map<ObjectGuid, uint32> m_playerShards;
+        std::mutex m_playerShardsLock;
+};
+
+extern WhoListDirectory sWhoListDirectory;
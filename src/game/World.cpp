@@ -165,6 +165,7 @@ World::World():
     m_maxQueuedSessionCount = 0;
     m_MaintenanceTimeChecker = 0;
     m_anticrashRearmTimer = 0;
+    m_priorityQueuePositionTimer = 0;
 
     m_defaultDbcLocale = LOCALE_enUS;
     m_availableDbcLocaleMask = 0;
@@ -386,18 +387,7 @@ void World::AddSession_(WorldSession* s)
 int32 World::GetQueuedSessionPos(WorldSession* sess)
 {
     if (getConfig(CONFIG_BOOL_ENABLE_PRIORITY_QUEUE))
-    {
-        uint32 position = 1;
-
-        uint32 index = sess->GetQueueIndex();
-
-        for (const auto& elem : m_priorityQueue[index])
-        {
-            if (elem.second == sess)
-                return position;
-            ++position;
-        }
-    }
+        return m_priorityQueue[sess->GetQueueIndex()].GetPosition(sess);
     else
     {
         uint32 position = 1;
@@ -426,10 +416,9 @@ void World::AddQueuedSession(WorldSession* sess)
 {
     sess->SetInQueue(true);
 
+    uint32 position;
     if (getConfig(CONFIG_BOOL_ENABLE_PRIORITY_QUEUE))
     {
-        static uint32 idxMarker = 0; // use in future to collect latest search and start there next search instead of iterating whole queue.
-
         uint32 priority = sess->GetBasePriority();
         uint32 index = sess->GetQueueIndex();
 
@@ -445,18 +434,13 @@ void World::AddQueuedSession(WorldSession* sess)
             }
         }
 
-        auto itr = m_priorityQueue[index].begin();
-        for (; itr != m_priorityQueue[index].end(); ++itr)
-        {
-            if (itr->first < priority)
-                break;
-        }
-
-        m_priorityQueue[index].insert(itr, std::make_pair(priority, sess));
-        //m_priorityQueue[index].push_back(std::make_pair(priority, sess));
+        position = m_priorityQueue[index].Add(sess, priority);
     }
     else
+    {
         m_QueuedSessions.push_back(sess);
+        position = m_QueuedSessions.size();
+    }
 
     // [-ZERO] Possible wrong
     // The 1st SMSG_AUTH_RESPONSE needs to contain other info too.
@@ -465,7 +449,7 @@ void World::AddQueuedSession(WorldSession* sess)
     packet << uint32(0);                                    // BillingTimeRemaining
     packet << uint8(0);                                     // BillingPlanFlags
     packet << uint32(0);                                    // BillingTimeRested
-    packet << uint32(GetQueuedSessionPos(sess));            // position in queue
+    packet << uint32(position);                             // position in queue
     sess->SendPacket(&packet);
 
     //sess->SendAuthWaitQue (GetQueuePos (sess));
@@ -481,44 +465,10 @@ bool World::RemoveQueuedSession(WorldSession* sess)
     //we have to copy most of OG queue over because it wont allow to do runtime container ifs with different iterator traits.
     if (getConfig(CONFIG_BOOL_ENABLE_PRIORITY_QUEUE))
     {
-        uint32 index = sess->GetQueueIndex();
-        auto itr = m_priorityQueue[index].begin();
-
-        bool found = false;
-
-        for (; itr != m_priorityQueue[index].end(); ++itr, ++position)
-        {
-            if (itr->second == sess)
-            {
-                sess->SetInQueue(false);
-                found = true;
-                itr = m_priorityQueue[index].erase(itr);
-                break;
-            }
-        }
-
-        if (!found && sessions)
-            --sessions;
-
-
-        //always return here for now.
-        return found;
-
-        // accept first in queue
-        if ((!m_playerLimit || (int32)sessions < m_playerLimit) && !m_priorityQueue[index].empty())
-        {
-            WorldSession* pop_sess = m_priorityQueue[index].begin()->second;
-            pop_sess->SetInQueue(false);
-            pop_sess->m_idleTime = WorldTimer::getMSTime();
-            pop_sess->SendAuthWaitQue(0);
-            m_priorityQueue[index].erase(m_priorityQueue[index].begin());
-
-            itr = m_priorityQueue[index].begin();
-            position = 1;
-        }
-
-        for (; itr != m_priorityQueue[index].end(); ++itr, ++position)
-            itr->second->SendAuthWaitQue(position);
+        // the sessions behind get their new position with the next UpdateSessions
+        bool found = m_priorityQueue[sess->GetQueueIndex()].Remove(sess);
+        if (found)
+            sess->SetInQueue(false);
 
         return found;
     }
@@ -1341,6 +1291,7 @@ void World::LoadConfigSettingsFromFile(bool reload)
     setConfig(CONFIG_UINT32_PACKET_BCAST_THREADS,                  "Network.PacketBroadcast.Threads", 0);
     setConfig(CONFIG_UINT32_PACKET_BCAST_FREQUENCY,                "Network.PacketBroadcast.Frequency", 50);
     setConfig(CONFIG_UINT32_PBCAST_DIFF_LOWER_VISIBILITY_DISTANCE, "Network.PacketBroadcast.ReduceVisDistance.DiffAbove", 0);
+    setConfigMinMax(CONFIG_UINT32_CHANNEL_BCAST_THREADS,           "Network.ChannelBroadcast.Threads", 0, 0, 20);
 
     // PvP options
     setConfig(CONFIG_BOOL_ACCURATE_PVP_EQUIP_REQUIREMENTS, "PvP.AccurateEquipRequirements", true);
@@ -1366,6 +1317,7 @@ void World::LoadConfigSettingsFromFile(bool reload)
     setConfig(CONFIG_BOOL_ENABLE_DYNAMIC_VISIBILITIES, "DynamicVisibility.Enable", false);
 
     setConfig(CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK, "PriorityQueue.PriorityPerTick", 1);
+    setConfig(CONFIG_UINT32_PRIORITY_QUEUE_POSITION_UPDATE_INTERVAL, "PriorityQueue.PositionUpdateInterval", 1000);
     setConfig(CONFIG_UINT32_PRIORITY_QUEUE_DONATOR_SETTINGS, "PriorityQueue.DonatorSettings", 0);
     setConfig(CONFIG_UINT32_PRIORITY_QUEUE_DONATOR_PRIORITY, "PriorityQueue.DonatorPriority", 0);
     setConfig(CONFIG_UINT32_PRIORITY_QUEUE_WESTERN_PRIORITY, "PriorityQueue.WesternPriority", 0);
@@ -2321,7 +2273,7 @@ void World::SetInitialWorldSettings()
         std::make_unique<MovementBroadcaster>(sWorld.getConfig(CONFIG_UINT32_PACKET_BCAST_THREADS),
                                               std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_PACKET_BCAST_FREQUENCY)));
 
-    m_ChannelBroadcaster = std::make_unique<ChannelBroadcaster>();
+    m_ChannelBroadcaster = std::make_unique<ChannelBroadcaster>(sWorld.getConfig(CONFIG_UINT32_CHANNEL_BCAST_THREADS));
     m_charDbWorkerThread.reset(new std::thread(&charactersDatabaseWorkerThread));
     m_autoPDumpThread = std::thread(&World::AutoPDumpWorker, this);
     m_asyncPacketsThread = std::thread(&World::ProcessAsyncPackets, this);
@@ -2956,8 +2908,8 @@ void World::SendHardcoreMessage(WorldPacket* packet, WorldSession* self)
 void World::KickAll()
 {
     m_QueuedSessions.clear();                               // prevent send queue update packet and login queued sessions
-    m_priorityQueue[0].clear();
-    m_priorityQueue[1].clear();
+    m_priorityQueue[0].Clear();
+    m_priorityQueue[1].Clear();
 
     // session not removed at kick and will removed in next update tick
     for (const auto& itr : m_sessions)
@@ -3334,23 +3286,13 @@ void World::UpdateSessions(uint32 diff)
             for (uint32 i = 0; i < acceptNow && !m_priorityQueue[RegionalPopIndex].empty(); ++i)
             {
                 // accept first in queue
-                WorldSession* pop_sess = m_priorityQueue[RegionalPopIndex].front().second;
+                WorldSession* pop_sess = m_priorityQueue[RegionalPopIndex].PopFront();
                 pop_sess->SetInQueue(false);
                 pop_sess->m_idleTime = WorldTimer::getMSTime();
                 pop_sess->SendAuthWaitQue(0);
-                m_priorityQueue[RegionalPopIndex].pop_front();
             }
 
-            for (auto& elem : m_priorityQueue[RegionalPopIndex])
-            {
-                elem.first += diff * getConfig(CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK);
-            }
-
-            int position = 1;
-            for (auto iter = m_priorityQueue[RegionalPopIndex].begin(); iter != m_priorityQueue[RegionalPopIndex].end(); ++iter, ++position)
-            {
-                iter->second->SendAuthWaitQue(position);
-            }
+            m_priorityQueue[RegionalPopIndex].Age(diff * getConfig(CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK));
         }
     }
 
@@ -3369,26 +3311,25 @@ void World::UpdateSessions(uint32 diff)
             for (uint32 i = 0; i < acceptNow && !m_priorityQueue[NonRegionalPopIndex].empty(); ++i)
             {
                 // accept first in queue
-                WorldSession* pop_sess = m_priorityQueue[NonRegionalPopIndex].front().second;
+                WorldSession* pop_sess = m_priorityQueue[NonRegionalPopIndex].PopFront();
                 pop_sess->SetInQueue(false);
                 pop_sess->m_idleTime = WorldTimer::getMSTime();
                 pop_sess->SendAuthWaitQue(0);
-                m_priorityQueue[NonRegionalPopIndex].pop_front();
             }
 
-            for (auto& elem : m_priorityQueue[NonRegionalPopIndex])
-            {
-                elem.first += diff * getConfig(CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK);
-            }
-
-            int position = 1;
-            for (auto iter = m_priorityQueue[NonRegionalPopIndex].begin(); iter != m_priorityQueue[NonRegionalPopIndex].end(); ++iter, ++position)
-            {
-                iter->second->SendAuthWaitQue(position);
-            }
+            m_priorityQueue[NonRegionalPopIndex].Age(diff * getConfig(CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK));
         }
     }
 
+    // only the sessions whose position changed get a packet, at most once per interval
+    m_priorityQueuePositionTimer += diff;
+    if (m_priorityQueuePositionTimer >= getConfig(CONFIG_UINT32_PRIORITY_QUEUE_POSITION_UPDATE_INTERVAL))
+    {
+        m_priorityQueuePositionTimer = 0;
+        m_priorityQueue[RegionalPopIndex].SendPositions();
+        m_priorityQueue[NonRegionalPopIndex].SendPositions();
+    }
+
 
     /*
     uint32 queuedSessions = getConfig(CONFIG_BOOL_ENABLE_PRIORITY_QUEUE) ? m_priorityQueue.size() : m_QueuedSessions.size();
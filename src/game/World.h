@@ -36,6 +36,8 @@
 #include "WorldPacket.h"
 #include "Opcodes.h"
 #include "Utilities/robin_hood.h"
+#include "LatencyHistogram.h"
+#include "LoginQueue.h"
 
 //#include "Creature.h"
 
@@ -126,6 +128,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_ANTIFLOOD_SANCTION,
     CONFIG_UINT32_PACKET_BCAST_THREADS,
     CONFIG_UINT32_PACKET_BCAST_FREQUENCY,
+    CONFIG_UINT32_CHANNEL_BCAST_THREADS,
     CONFIG_UINT32_MAILSPAM_EXPIRE_SECS,
     CONFIG_UINT32_MAILSPAM_MAX_MAILS,
     CONFIG_UINT32_MAILSPAM_LEVEL,
@@ -403,6 +406,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_DIFF_HC_PROTECTION,
     CONFIG_UINT32_LOGIN_REGION_QUEUE_LEVEL_THRESHOLD,
     CONFIG_UINT32_PRIORITY_QUEUE_PRIORITY_PER_TICK,
+    CONFIG_UINT32_PRIORITY_QUEUE_POSITION_UPDATE_INTERVAL,
     CONFIG_UINT32_PRIORITY_QUEUE_DONATOR_SETTINGS,
     CONFIG_UINT32_PRIORITY_QUEUE_DONATOR_PRIORITY,
     CONFIG_UINT32_PRIORITY_QUEUE_WESTERN_PRIORITY,
@@ -925,6 +929,15 @@ class World
 
         uint32 GetLastDiff() const { return m_lastDiff; }
 
+        /// Character login timings, from the login request to the query holder callback and to the player being in world
+        void RecordPlayerLogin(uint32 loadMs, uint32 totalMs)
+        {
+            m_loginLoadTime.Add(uint64(loadMs) * 1000);
+            m_loginTotalTime.Add(uint64(totalMs) * 1000);
+        }
+        LatencyHistogram const& GetLoginLoadTime() const { return m_loginLoadTime; }
+        LatencyHistogram const& GetLoginTotalTime() const { return m_loginTotalTime; }
+
         /// Get the active session server limit (or security level limitations)
         uint32 GetPlayerAmountLimit() const { return m_playerLimit >= 0 ? m_playerLimit : 0; }
         AccountTypes GetPlayerSecurityLimit() const { return m_playerLimit <= 0 ? AccountTypes(-m_playerLimit) : SEC_PLAYER; }
@@ -1297,6 +1310,8 @@ class World
 
         uint32 m_diffThresholdHits = 0;
         uint32 m_lastDiff = 0;
+        LatencyHistogram m_loginLoadTime;
+        LatencyHistogram m_loginTotalTime;
         SessionMap m_sessions;
         SessionSet m_disconnectedSessions;
         robin_hood::unordered_map<uint32 /*accountId*/, time_t /*last logout*/> m_accountsLastLogout;
@@ -1348,7 +1363,8 @@ class World
 
         //higher is first in the map, higher points -> higher priority.
         //Priority is built from multiple factors, acc reg date, char levels etc etc.
-        std::deque<std::pair<uint32, WorldSession*>> m_priorityQueue[2];
+        LoginQueue m_priorityQueue[2];
+        uint32 m_priorityQueuePositionTimer;
 
         std::unordered_map<uint32, uint32> m_Ipconnections; // binary IP, count
 
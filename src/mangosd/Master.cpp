@@ -46,6 +46,7 @@
 #include "CliRunnable.h"
 #include "Util.h"
 #include "MassMailMgr.h"
+#include "Logging/DatabaseLogger.hpp"
 #include "DBCStores.h"
 #include "re2/re2.h"
 
@@ -199,6 +200,8 @@ int Master::Run()
     LoginDatabase.AllowAsyncTransactions();
     LogsDatabase.AllowAsyncTransactions();
 
+    sDBLogger.Start();
+
     ///- Catch termination signals
     _HookSignals();
 
@@ -307,6 +310,9 @@ int Master::Run()
     sLog.outString("Sending queued mail...");
     sMassMailMgr.Update(true);
 
+    sLog.outString("Flushing database logs...");
+    sDBLogger.Stop();
+
     ///- Wait for DB delay threads to end
     sLog.outString("Closing database connections...");
     CharacterDatabase.StopServer();
@@ -389,6 +395,7 @@ bool StartDB(std::string name, DatabaseType& database)
     std::string dbstring = sConfig.GetStringDefault((name + "Database.Info").c_str(), "");
     int nConnections = sConfig.GetIntDefault((name + "Database.Connections").c_str(), 1);
     int nAsyncConnections = sConfig.GetIntDefault((name + "Database.WorkerThreads").c_str(), 1);
+    int nWriteShards = sConfig.GetIntDefault((name + "Database.WriteShards").c_str(), 0);
     if (dbstring.empty())
     {
         sLog.outError("%s database not specified in configuration file", name.c_str());
@@ -429,7 +436,7 @@ bool StartDB(std::string name, DatabaseType& database)
     }
 
     ///- Initialise the world database
-    if (!database.Initialize(name.c_str(), dbstring.c_str(), nConnections, nAsyncConnections))
+    if (!database.Initialize(name.c_str(), dbstring.c_str(), nConnections, nAsyncConnections, nWriteShards))
     {
         sLog.outError("Cannot connect to world database %s", name.c_str());
         return false;
@@ -27,12 +27,15 @@
 #include "Auth/Hmac.h"
 #include "Auth/base32.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Config/Config.h"
 #include "Log.h"
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
 #include "PatchHandler.h"
+#include "SRP6Workers.h"
+#include "BanIndex.h"
 #include "Util.h"
 #include "re2/re2.h"
 
@@ -164,28 +167,178 @@ typedef struct AuthHandler
 
 #define AUTH_TOTAL_COMMANDS sizeof(table) / sizeof(AuthHandler)
 
+/// v = g^x mod N for an account without v and s in the database
+struct SRP6VerifierTask
+{
+    BigNumber g, x, N;
+    BigNumber v;
+
+    void Execute() { v = g.ModExp(x, N); }
+};
+
+/// S = (A * v^u)^b mod N, the shared secret of the logon proof
+struct SRP6ProofTask
+{
+    sAuthLogonProof_C_1_11 lp;
+    PINData pinData;
+    BigNumber A, u, v, b, N;
+    BigNumber S;
+
+    void Execute() { S = (A * (v.ModExp(u, N))).ModExp(b, N); }
+};
+
 std::array<uint8, 16> VersionChallenge = { { 0xBA, 0xA3, 0x1E, 0x99, 0xA0, 0x0B, 0x21, 0x57, 0xFC, 0x37, 0x3F, 0xB3, 0x69, 0xCD, 0xD2, 0xF1 } };
 
 static std::unordered_map<std::string, std::pair<std::string, uint32>> keyCache;
 
+enum AuthChallengeQueryIndex
+{
+    AUTH_CHALLENGE_QUERY_IP_BANNED,
+    AUTH_CHALLENGE_QUERY_THROTTLE,
+    AUTH_CHALLENGE_QUERY_ACCOUNT,
+    MAX_AUTH_CHALLENGE_QUERY
+};
+
+enum AuthSecurityQueryIndex
+{
+    AUTH_SECURITY_QUERY_COINS,
+    AUTH_SECURITY_QUERY_BANNED,
+    AUTH_SECURITY_QUERY_TWOFACTOR,
+    MAX_AUTH_SECURITY_QUERY
+};
+
+enum AuthGeoLockQueryIndex
+{
+    AUTH_GEOLOCK_QUERY_CURRENT,
+    AUTH_GEOLOCK_QUERY_PREVIOUS,
+    MAX_AUTH_GEOLOCK_QUERY
+};
+
+class AuthQueryHolder : public SqlQueryHolder
+{
+    public:
+        explicit AuthQueryHolder(uint64 serialId = 0) : SqlQueryHolder(serialId)
+        {
+            // logon queries never depend on each other
+            SetParallel(true);
+        }
+        // results are owned by the holder
+        ~AuthQueryHolder() { DeleteAllResults(); }
+};
+
+// Sockets waiting for database results are resumed by id, they may be closed and gone by then.
+// Only used from the reactor thread, which also processes the LoginDatabase result queue.
+static std::unordered_map<uint32, AuthSocket*> authSockets;
+static uint32 nextAuthSocketId = 0;
+static uint32 pendingAuthQueries = 0;
+
+bool AuthSocket::HasPendingQueries()
+{
+    return pendingAuthQueries != 0;
+}
+
+/// Runs the holder's queries on the LoginDatabase workers, the socket stops reading until Handler is called
+template<bool (AuthSocket::*Handler)(SqlQueryHolder*)>
+bool AuthSocket::DelayQueries(SqlQueryHolder* holder)
+{
+    _workPending = true;
+    ++pendingAuthQueries;
+
+    if (LoginDatabase.DelayQueryHolderUnsafe(&AuthSocket::ResumeAfterQueries<Handler>, holder, _socketId))
+        return true;
+
+    --pendingAuthQueries;
+    _workPending = false;
+    delete holder;
+    return false;
+}
+
+template<bool (AuthSocket::*Handler)(SqlQueryHolder*)>
+void AuthSocket::ResumeAfterQueries(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 socketId)
+{
+    --pendingAuthQueries;
+
+    AuthSocket* socket = ResumeSocket(socketId);
+    if (!socket)
+    {
+        delete holder;
+        return;
+    }
+
+    bool result = (socket->*Handler)(holder);
+    delete holder;
+
+    socket->ContinueAfterResume(result);
+}
+
+/// Runs the task on the SRP6 crypto workers, the socket stops reading until Handler is called.
+/// The task is shared with the worker and must not reference the socket, which may be closed meanwhile.
+template<class Task, bool (AuthSocket::*Handler)(Task&)>
+bool AuthSocket::DelayCrypto(SRP6Stage stage, std::shared_ptr<Task> task)
+{
+    uint32 socketId = _socketId;
+    if (sSRP6Workers.Post(stage, [task]() { task->Execute(); }, [task, socketId]() { ResumeAfterCrypto<Task, Handler>(*task, socketId); }))
+    {
+        _workPending = true;
+        return true;
+    }
+
+    // no workers or too much work queued already
+    sSRP6Workers.Execute(stage, [&task]() { task->Execute(); });
+    return (this->*Handler)(*task);
+}
+
+template<class Task, bool (AuthSocket::*Handler)(Task&)>
+void AuthSocket::ResumeAfterCrypto(Task& task, uint32 socketId)
+{
+    if (AuthSocket* socket = ResumeSocket(socketId))
+        socket->ContinueAfterResume((socket->*Handler)(task));
+}
+
+AuthSocket* AuthSocket::ResumeSocket(uint32 socketId)
+{
+    auto itr = authSockets.find(socketId);
+    if (itr == authSockets.end())
+        return nullptr;
+
+    itr->second->_workPending = false;
+    return itr->second;
+}
+
+void AuthSocket::ContinueAfterResume(bool handlerResult)
+{
+    if (!handlerResult)
+    {
+        DEBUG_LOG("[Auth] Delayed handler failed for %s", get_remote_address().c_str());
+        close_connection();
+        return;
+    }
+
+    // process what the client sent in the meantime
+    if (!_workPending && recv_len())
+        OnRead();
+}
+
 /// Constructor - set the N and g values for SRP6
-AuthSocket::AuthSocket() : promptPin(false), gridSeed(0), _geoUnlockPIN(0), _accountId(0), _lastRealmListRequest(0)
+AuthSocket::AuthSocket() : _socketId(++nextAuthSocketId), _workPending(false), promptPin(false),
+    _pendingAccountId(0), _securityRank(0), _clientLocalIp(0), gridSeed(0), _geoUnlockPIN(0), _accountId(0), _lastRealmListRequest(0)
 {
-    N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
-    g.SetDword(7);
+    N = sSRP6Workers.GetN();
+    g = sSRP6Workers.GetG();
     _status = STATUS_CHALLENGE;
 
     _accountDefaultSecurityLevel = SEC_PLAYER;
 
     _build = 0;
-    patch_ = ACE_INVALID_HANDLE;
+    patchOffset_ = 0;
+
+    authSockets[_socketId] = this;
 }
 
 /// Close patch file descriptor before leaving
 AuthSocket::~AuthSocket()
 {
-    if (patch_ != ACE_INVALID_HANDLE)
-        ACE_OS::close(patch_);
+    authSockets.erase(_socketId);
 }
 
 AccountTypes AuthSocket::GetSecurityOn(uint32 realmId) const
@@ -250,6 +403,10 @@ void AuthSocket::OnRead()
     uint8 _cmd;
     while (1)
     {
+        // waiting for the database, the rest stays buffered until the handler resumes
+        if (_workPending)
+            return;
+
         if (sConfig.GetBoolDefault("Proxy.PassIp", false))
         {
             if (!_proxyIpReceived)
@@ -305,8 +462,8 @@ void AuthSocket::OnRead()
     }
 }
 
-/// Make the SRP6 calculation from hash in dB
-void AuthSocket::_SetVSFields(const std::string& rI)
+/// Make the SRP6 calculation from hash in dB, the verifier itself is computed by the crypto workers
+bool AuthSocket::_SetVSFields(const std::string& rI)
 {
     s.SetRand(s_BYTE_SIZE * 8);
 
@@ -325,9 +482,19 @@ void AuthSocket::_SetVSFields(const std::string& rI)
     sha.UpdateData(s.AsByteArray());
     sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
     sha.Finalize();
-    BigNumber x;
-    x.SetBinary(sha.GetDigest(), sha.GetLength());
-    v = g.ModExp(x, N);
+
+    std::shared_ptr<SRP6VerifierTask> task = std::make_shared<SRP6VerifierTask>();
+    task->x.SetBinary(sha.GetDigest(), sha.GetLength());
+    task->g = g;
+    task->N = N;
+
+    return DelayCrypto<SRP6VerifierTask, &AuthSocket::_HandleVSFields>(SRP6_STAGE_VERIFIER, task);
+}
+
+bool AuthSocket::_HandleVSFields(SRP6VerifierTask& task)
+{
+    v = task.v;
+
     // No SQL injection (username escaped)
     const char *v_hex, *s_hex;
     v_hex = v.AsHexStr();
@@ -335,6 +502,8 @@ void AuthSocket::_SetVSFields(const std::string& rI)
     LoginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, _safelogin.c_str() );
     OPENSSL_free((void*)v_hex);
     OPENSSL_free((void*)s_hex);
+
+    return _QueryLogonChallengeSecurity();
 }
 
 void AuthSocket::SendProof(Sha1Hash sha)
@@ -390,14 +559,17 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
+    _clientLocalIp = ch->ip;
 
     memcpy(&_os, ch->os, sizeof(_os));
     memcpy(&_platform, ch->platform, sizeof(_platform));
 
+    _localizationName.resize(4);
+    for(int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4-i-1];
+
     ///- Normalize account name
 
     // Escape the user login to avoid further SQL injection
@@ -405,284 +577,320 @@ bool AuthSocket::_HandleLogonChallenge()
     _safelogin = _login;
     LoginDatabase.escape_string(_safelogin);
 
-    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-    pkt << (uint8) 0x00;
-
-    // Whether to continue handling the logon after prechecks or not
-    bool handle_logon{ true };
-
     // Temporary restrict build 7070 to CH realms!
 
     if (_build == 7070 && sConfig.GetBoolDefault("Network.CN", false))
     {
-        pkt << (uint8)WOW_FAIL_VERSION_INVALID;
         BASIC_LOG("[AuthChallenge] ip '%s' tries to login with forbidden build number!", get_remote_address().c_str());
+        SendLogonChallengeError(WOW_FAIL_VERSION_INVALID);
+        return true;
+    }
+
+    ///- Banned and throttled addresses are rejected from memory when the ban index is enabled
+    if (sBanIndex.IsEnabled())
+    {
+        if (sBanIndex.IsIpBanned(get_remote_address()))
+        {
+            SendIpBanned();
+            return true;
+        }
 
-        handle_logon = false;
+        if (AUTH_THROTTLE_COUNT > 0 && IsThrottled(sBanIndex.GetRecentLogins(get_remote_address())))
+            return true;
     }
 
-    ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
     std::string address = get_remote_address();
     LoginDatabase.escape_string(address);
-    std::unique_ptr<QueryResult> result (LoginDatabase.PQuery("SELECT unbandate FROM ip_banned WHERE "
-    //    permanent                    still banned
-        "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", address.c_str()));
-    if (result)
+
+    AuthQueryHolder* holder = new AuthQueryHolder();
+    holder->SetSize(MAX_AUTH_CHALLENGE_QUERY);
+
+    if (!sBanIndex.IsEnabled())
     {
-        pkt << (uint8)WOW_FAIL_DB_BUSY;
-        BASIC_LOG("[AuthChallenge] Banned ip '%s' tries to login with account '%s'!", get_remote_address().c_str(), _login.c_str());
+        ///- Verify that this IP is not in the ip_banned table
+        holder->SetPQuery(AUTH_CHALLENGE_QUERY_IP_BANNED, "SELECT unbandate FROM ip_banned WHERE "
+        //    permanent                    still banned
+            "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", address.c_str());
+
+        // Throttle the number of successful connections to different accounts from a single IP within a certain timeframe
+        if (AUTH_THROTTLE_COUNT > 0)
+            holder->SetPQuery(AUTH_CHALLENGE_QUERY_THROTTLE, "SELECT COUNT(id) FROM account WHERE last_ip = '%s' AND last_login > NOW() - '%d'", address.c_str(), AUTH_THROTTLE_DURATION);
+    }
+
+    ///- Get the account details from the account table
+    // No SQL injection (escaped user name)
+    holder->SetPQuery(AUTH_CHALLENGE_QUERY_ACCOUNT, "SELECT sha_pass_hash,id,locked,last_ip,v,s,security,email_verif,geolock_pin,email,UNIX_TIMESTAMP(joindate),rank,current_realm,active FROM account WHERE username = '%s'", _safelogin.c_str());
 
-        handle_logon = false;
+    return DelayQueries<&AuthSocket::_HandleLogonChallengeAccount>(holder);
+}
+
+/// Logon Challenge, second step: ban, throttle and account checks
+bool AuthSocket::_HandleLogonChallengeAccount(SqlQueryHolder* holder)
+{
+    if (holder->GetResult(AUTH_CHALLENGE_QUERY_IP_BANNED))
+    {
+        SendIpBanned();
+        return true;
     }
 
-    // Throttle the number of successful connections to different accounts from a single IP within a certain timeframe
-    const auto throttleCount{ 15 };
-    const auto throttleDuration{ 300 };
-    if (handle_logon && throttleCount > 0)
+    if (QueryResult* result = holder->GetResult(AUTH_CHALLENGE_QUERY_THROTTLE))
+        if (IsThrottled(result->Fetch()[0].GetInt32()))
+            return true;
+
+    QueryResult* result = holder->GetResult(AUTH_CHALLENGE_QUERY_ACCOUNT);
+    if (!result) // no account
     {
-        result.reset(LoginDatabase.PQuery("SELECT COUNT(id) FROM account WHERE last_ip = '%s' AND last_login > NOW() - '%d'", address.c_str(), throttleDuration));
-        if (result)
-        {
-            const auto connections{ result->Fetch()[0].GetInt32() + 1 }; // Include this connection in the throttle?
+        SendLogonChallengeError(WOW_FAIL_UNKNOWN_ACCOUNT);
+        return true;
+    }
 
-            if (connections >= throttleCount)
-            {
-                pkt << (uint8)WOW_FAIL_DB_BUSY;
-                BASIC_LOG("[AuthChallenge] Too many successful login attempts from '%s' (%d) within last %d seconds (limit %d)", address.c_str(), connections, throttleDuration, throttleCount);
+    Field* fields = result->Fetch();
 
-                handle_logon = false;
-            }
-        }
+    // Prevent login if the user's email address has not been verified
+    bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
+    int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
+    int32 forcePinAccountRank = sConfig.GetIntDefault("ForcePinAccountRank", 1);
+    bool verified = fields[7].GetBool();
+
+    // Prevent login if the user's join date is bigger than the timestamp in configuration
+    if (requireEmailSince > 0)
+    {
+        uint32 t = fields[10].GetUInt32();
+        requireVerification = requireVerification && (t >= static_cast<uint32>(requireEmailSince));
     }
 
-    if (handle_logon)
+    if (requireVerification && !verified)
     {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
-        result.reset(LoginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,v,s,security,email_verif,geolock_pin,email,UNIX_TIMESTAMP(joindate),rank,current_realm,active FROM account WHERE username = '%s'",_safelogin.c_str ()));
+        BASIC_LOG("[AuthChallenge] Account '%s' ('%s) and local IP %u 'email address requires email verification - rejecting login", _login.c_str(), get_remote_address().c_str(), _clientLocalIp);
+        SendLogonChallengeError(WOW_FAIL_PARENTCONTROL);
+        return true;
+    }
 
-        if (result)
-        {
-            Field* fields = result->Fetch();
+    lockFlags = (LockFlag)fields[2].GetUInt32();
+    securityInfo = fields[6].GetCppString();
+    _lastIP = fields[3].GetString();
+    _geoUnlockPIN = fields[8].GetUInt32();
+    _email = fields[9].GetCppString();
 
-            // Prevent login if the user's email address has not been verified
-            bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
-            int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
-            int32 forcePinAccountRank = sConfig.GetIntDefault("ForcePinAccountRank", 1);
-            bool verified = (*result)[7].GetBool();
-            
-            // Prevent login if the user's join date is bigger than the timestamp in configuration
-            if (requireEmailSince > 0)
-            {
-                uint32 t = (*result)[10].GetUInt32();
-                requireVerification = requireVerification && (t >= static_cast<uint32>(requireEmailSince));
-            }
+    _joindateStamp = fields[10].GetUInt32();
 
-            if (requireVerification && !verified)
-            {
-                BASIC_LOG("[AuthChallenge] Account '%s' ('%s) and local IP %u 'email address requires email verification - rejecting login", _login.c_str(), get_remote_address().c_str(), ch->ip);
-                pkt << (uint8)WOW_FAIL_PARENTCONTROL;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }
+    _shaPassHash = fields[0].GetCppString();
+    _databaseV = fields[4].GetCppString();
+    _databaseS = fields[5].GetCppString();
 
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            lockFlags = (LockFlag)(*result)[2].GetUInt32();
-            securityInfo = (*result)[6].GetCppString();
-            _lastIP = fields[3].GetString();
-            _geoUnlockPIN = fields[8].GetUInt32();
-            _email = fields[9].GetCppString();
+    _securityRank = fields[11].GetUInt8();
+    if (_securityRank >= forcePinAccountRank)
+    {
+        if (!(lockFlags & ALWAYS_ENFORCE))
+            lockFlags = (LockFlag)(uint32(lockFlags) | ALWAYS_ENFORCE);
 
-            _joindateStamp = fields[10].GetUInt32();
+        if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
+            lockFlags = (LockFlag)(uint32(lockFlags) | FIXED_PIN);
+    }
 
-            uint8 securityRank = fields[11].GetUInt8();
-            if (securityRank >= forcePinAccountRank)
-            {
-                if (!(lockFlags & ALWAYS_ENFORCE))
-                    lockFlags = (LockFlag)(uint32(lockFlags) | ALWAYS_ENFORCE);
+    uint8 current_realm = fields[12].GetUInt8();
+    uint8 active = fields[13].GetUInt8();
 
-                if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
-                    lockFlags = (LockFlag)(uint32(lockFlags) | FIXED_PIN);
-            }
+    if (!active)
+    {
+        SendLogonChallengeError(WOW_FAIL_INCORRECT_PASSWORD);
+        return true;
+    }
 
-            uint8 current_realm = fields[12].GetUInt8();
-            uint8 active = fields[13].GetUInt8();
+    /* if (current_realm)
+    {
+        SendLogonChallengeError(WOW_FAIL_ALREADY_ONLINE);
+        return true;
+    }*/
 
-            if (!active)
-            {
-                pkt << (uint8)WOW_FAIL_INCORRECT_PASSWORD;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }
+    _pendingAccountId = fields[1].GetUInt32();
 
-			/* if (current_realm)
-            {
-                pkt << (uint8)WOW_FAIL_ALREADY_ONLINE;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }*/
+    DEBUG_LOG("database authentication values: v='%s' s='%s'", _databaseV.c_str(), _databaseS.c_str());
 
-            uint32 account_id = fields[1].GetUInt32();
+    ///- Don't calculate (v, s) if there are already some in the database
+    // multiply with 2, bytes are stored as hexstring
+    if (_databaseV.size() != s_BYTE_SIZE*2 || _databaseS.size() != s_BYTE_SIZE*2)
+        return _SetVSFields(_shaPassHash);
 
-            // Block login to account with negative coins balance. Requested by Bowser.
-            if (QueryResult* coinsResult = LoginDatabase.PQuery("SELECT `coins` FROM `shop_coins` WHERE `id` = %u && `coins` < 0", account_id))
-            {
-                delete coinsResult;
-                pkt << (uint8)WOW_FAIL_NO_TIME;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }
+    s.SetHexStr(_databaseS.c_str());
+    v.SetHexStr(_databaseV.c_str());
 
-            if (lockFlags & IP_LOCK)
-            {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), _lastIP.c_str());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
+    return _QueryLogonChallengeSecurity();
+}
 
-                if (_lastIP != get_remote_address())
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
+bool AuthSocket::_QueryLogonChallengeSecurity()
+{
+    int32 forcePinAccountRank = sConfig.GetIntDefault("ForcePinAccountRank", 1);
 
-                    // account is IP locked and the player does not have 2FA enabled
-                    if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
+    // on the account's serial queue, after the 2FA exception writes of a previous logon
+    AuthQueryHolder* securityHolder = new AuthQueryHolder(MakeSqlSerialId(SQL_SERIAL_ACCOUNT, _pendingAccountId));
+    securityHolder->SetSize(MAX_AUTH_SECURITY_QUERY);
 
-                    locked = true;
-                }
-                else
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
-                }
-            }
-            else
-            {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
-            }
+    // Block login to account with negative coins balance. Requested by Bowser.
+    securityHolder->SetPQuery(AUTH_SECURITY_QUERY_COINS, "SELECT `coins` FROM `shop_coins` WHERE `id` = %u && `coins` < 0", _pendingAccountId);
 
-            if (!locked || (locked && (lockFlags & FIXED_PIN || lockFlags & TOTP)))
-            {
-                ///- If the account is banned, reject the logon attempt
-                std::unique_ptr<QueryResult> banresult(LoginDatabase.PQuery("SELECT bandate,unbandate FROM account_banned WHERE "
-                    "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate) LIMIT 1", account_id));
-                if (banresult)
-                {
-                    if((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
-                    }
-                }
-                else
-                {
-                    ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = fields[0].GetCppString();
+    ///- If the account is banned, reject the logon attempt
+    if (!sBanIndex.IsEnabled())
+        securityHolder->SetPQuery(AUTH_SECURITY_QUERY_BANNED, "SELECT bandate,unbandate FROM account_banned WHERE "
+            "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate) LIMIT 1", _pendingAccountId);
 
-                    ///- Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = fields[4].GetCppString();
-                    std::string databaseS = fields[5].GetCppString();
+    //force 2FA for staff accounts.
+    if (_securityRank >= forcePinAccountRank || lockFlags == FIXED_PIN)
+    {
+        std::string address = get_remote_address();
+        LoginDatabase.escape_string(address);
 
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+        securityHolder->SetPQuery(AUTH_SECURITY_QUERY_TWOFACTOR, "SELECT expires_at FROM `account_twofactor_allowed` WHERE `ip_address` = '%s' AND `account_id` = %u", address.c_str(), _pendingAccountId);
+    }
 
-                    // multiply with 2, bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE*2 || databaseS.size() != s_BYTE_SIZE*2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+    return DelayQueries<&AuthSocket::_HandleLogonChallengeSecurity>(securityHolder);
+}
 
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
+/// Logon Challenge, last step: coins, IP lock, account ban and SRP6 challenge
+bool AuthSocket::_HandleLogonChallengeSecurity(SqlQueryHolder* holder)
+{
+    uint32 account_id = _pendingAccountId;
 
-                    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+    if (holder->GetResult(AUTH_SECURITY_QUERY_COINS))
+    {
+        SendLogonChallengeError(WOW_FAIL_NO_TIME);
+        return true;
+    }
 
-                    ///- Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+    ByteBuffer pkt;
+    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    pkt << (uint8) 0x00;
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32)); // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(g.AsByteArray());
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32));
-                    pkt.append(s.AsByteArray()); // 32 bytes
-                    pkt.append(VersionChallenge.data(), VersionChallenge.size());
+    ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+    bool locked = false;
+    if (lockFlags & IP_LOCK)
+    {
+        DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), _lastIP.c_str());
+        DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
 
-                    // figure out whether we need to display the PIN grid
-                    promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
+        if (_lastIP != get_remote_address())
+        {
+            DEBUG_LOG("[AuthChallenge] Account IP differs");
 
-                    if ((!locked && ((lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || _geoUnlockPIN)
-                    {
-                        promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
-                    }
+            // account is IP locked and the player does not have 2FA enabled
+            if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
 
-                    //force 2FA for staff accounts.
-                    if (securityRank >= forcePinAccountRank || lockFlags == FIXED_PIN)
-                    {
-                        std::string address = get_remote_address();
-                        LoginDatabase.escape_string(address);
+            locked = true;
+        }
+        else
+        {
+            DEBUG_LOG("[AuthChallenge] Account IP matches");
+        }
+    }
+    else
+    {
+        DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+    }
 
+    if (!locked || (locked && (lockFlags & FIXED_PIN || lockFlags & TOTP)))
+    {
+        uint64 bandate = 0, unbandate = 0;
+        bool banned = false;
+        if (sBanIndex.IsEnabled())
+            banned = sBanIndex.FindAccountBan(account_id, bandate, unbandate);
+        else if (QueryResult* banresult = holder->GetResult(AUTH_SECURITY_QUERY_BANNED))
+        {
+            banned = true;
+            bandate = (*banresult)[0].GetUInt64();
+            unbandate = (*banresult)[1].GetUInt64();
+        }
 
-                        result.reset(LoginDatabase.PQuery("SELECT expires_at FROM `account_twofactor_allowed` WHERE `ip_address` = '%s' AND `account_id` = %u", address.c_str(), account_id));
-
-                        if (result)
-                        {
-                            auto fields = result->Fetch();
-                            uint64 expiresAt = fields[0].GetUInt64();
-                            if (static_cast<time_t>(expiresAt) < time(nullptr)) // expired.
-                            {
-                                LoginDatabase.DirectPExecute("DELETE FROM `account_twofactor_allowed` WHERE `ip_address` = '%s' AND `account_id` = %u", address.c_str(), account_id);
-                                promptPin = true;
-                            }
-                            else
-                                promptPin = false;
-                        }
-                        else
-                            promptPin = true;
-                    }
+        if (banned)
+        {
+            if (bandate == unbandate)
+            {
+                pkt << (uint8) WOW_FAIL_BANNED;
+                BASIC_LOG("[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
+            }
+            else
+            {
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                BASIC_LOG("[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
+            }
+        }
+        else
+        {
+            // s and v are known since the account step, b and g^b mod N are precomputed by the crypto workers
+            BigNumber gmod;
+            sSRP6Workers.TakeEphemeral(b, gmod);
+            B = ((v * 3) + gmod) % N;
 
-                    if (promptPin)
-                    {
-                        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", _login.c_str(), get_remote_address().c_str());
+            MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
 
-                        uint32 gridSeedPkt = gridSeed = static_cast<uint32>(rand32());
-                        EndianConvert(gridSeedPkt);
-                        serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
+            ///- Fill the response packet with the result
+            pkt << uint8(WOW_SUCCESS);
 
-                        pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
-                        pkt << gridSeedPkt;
-                        pkt.append(serverSecuritySalt.AsByteArray(16).data(), 16);
-                    }
-                    else
+            // B may be calculated < 32B so we force minimal length to 32B
+            pkt.append(B.AsByteArray(32)); // 32 bytes
+            pkt << uint8(1);
+            pkt.append(g.AsByteArray());
+            pkt << uint8(32);
+            pkt.append(N.AsByteArray(32));
+            pkt.append(s.AsByteArray()); // 32 bytes
+            pkt.append(VersionChallenge.data(), VersionChallenge.size());
+
+            // figure out whether we need to display the PIN grid
+            promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
+
+            if ((!locked && ((lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || _geoUnlockPIN)
+            {
+                promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
+            }
+
+            //force 2FA for staff accounts.
+            if (_securityRank >= sConfig.GetIntDefault("ForcePinAccountRank", 1) || lockFlags == FIXED_PIN)
+            {
+                if (QueryResult* result = holder->GetResult(AUTH_SECURITY_QUERY_TWOFACTOR))
+                {
+                    auto fields = result->Fetch();
+                    uint64 expiresAt = fields[0].GetUInt64();
+                    if (static_cast<time_t>(expiresAt) < time(nullptr)) // expired.
                     {
-                        pkt << uint8(0);
+                        std::string address = get_remote_address();
+                        LoginDatabase.escape_string(address);
+                        LoginDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_ACCOUNT, account_id));
+                        LoginDatabase.PExecute("DELETE FROM `account_twofactor_allowed` WHERE `ip_address` = '%s' AND `account_id` = %u", address.c_str(), account_id);
+                        LoginDatabase.CommitTransaction();
+                        promptPin = true;
                     }
+                    else
+                        promptPin = false;
+                }
+                else
+                    promptPin = true;
+            }
 
-                    _localizationName.resize(4);
-                    for(int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
-
-                    LoadAccountSecurityLevels(account_id);
-                    BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' is using '%c%c%c%c' locale (%u)", _login.c_str (), get_remote_address().c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
+            if (promptPin)
+            {
+                BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", _login.c_str(), get_remote_address().c_str());
 
-                    _accountId = account_id;
+                uint32 gridSeedPkt = gridSeed = static_cast<uint32>(rand32());
+                EndianConvert(gridSeedPkt);
+                serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
 
-                    ///- All good, await client's proof
-                    _status = STATUS_LOGON_PROOF;
-                }
+                pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
+                pkt << gridSeedPkt;
+                pkt.append(serverSecuritySalt.AsByteArray(16).data(), 16);
             }
-        }
-        else // no account
-        {
-            pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
+            else
+            {
+                pkt << uint8(0);
+            }
+
+            _accountDefaultSecurityLevel = AccountTypes(_securityRank);
+            BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' is using '%s' locale (%u)", _login.c_str (), get_remote_address().c_str(), _localizationName.c_str(), GetLocaleByName(_localizationName));
+
+            _accountId = account_id;
+
+            ///- All good, await client's proof
+            _status = STATUS_LOGON_PROOF;
         }
     }
 
@@ -690,18 +898,43 @@ bool AuthSocket::_HandleLogonChallenge()
     return true;
 }
 
+void AuthSocket::SendIpBanned()
+{
+    BASIC_LOG("[AuthChallenge] Banned ip '%s' tries to login with account '%s'!", get_remote_address().c_str(), _login.c_str());
+    SendLogonChallengeError(WOW_FAIL_DB_BUSY);
+}
+
+bool AuthSocket::IsThrottled(int32 recentLogins)
+{
+    const auto connections{ recentLogins + 1 }; // Include this connection in the throttle?
+
+    if (connections < AUTH_THROTTLE_COUNT)
+        return false;
+
+    BASIC_LOG("[AuthChallenge] Too many successful login attempts from '%s' (%d) within last %d seconds (limit %d)", get_remote_address().c_str(), connections, AUTH_THROTTLE_DURATION, AUTH_THROTTLE_COUNT);
+    SendLogonChallengeError(WOW_FAIL_DB_BUSY);
+    return true;
+}
+
+void AuthSocket::SendLogonChallengeError(uint8 error)
+{
+    uint8 data[3] = { CMD_AUTH_LOGON_CHALLENGE, 0x00, error };
+    send((char const*)data, sizeof(data));
+}
+
 /// Logon Proof command handler
 bool AuthSocket::_HandleLogonProof()
 {
     DEBUG_LOG("Entering _HandleLogonProof");
 
-    sAuthLogonProof_C_1_11 lp;
+    std::shared_ptr<SRP6ProofTask> task = std::make_shared<SRP6ProofTask>();
+    sAuthLogonProof_C_1_11& lp = task->lp;
     
     ///- Read the packet
     if (!recv((char *)&lp, sizeof(sAuthLogonProof_C_1_11)))
         return false;  
 
-    PINData pinData;
+    PINData& pinData = task->pinData;
 
     if (lp.securityFlags)
     {
@@ -718,7 +951,7 @@ bool AuthSocket::_HandleLogonProof()
     /// <ul><li> If the client has no valid version
     if (!valid_version)
     {
-        if (this->patch_ != ACE_INVALID_HANDLE)
+        if (patch_)
             return false;
 
         ///- Check if we have the apropriate patch on the disk
@@ -737,13 +970,11 @@ bool AuthSocket::_HandleLogonProof()
         else
             snprintf(tmp, 256, "%s/twpatch.mpq", sConfig.GetStringDefault("PatchesDir", "./patches").c_str());
 
-        char filename[PATH_MAX];
-        if (ACE_OS::realpath(tmp, filename) != nullptr)
-        {
-            patch_ = ACE_OS::open(filename, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
-        }
+        // opened once and shared by all downloads, with its MD5 already known
+        patch_ = PatchCache::instance()->GetPatch(tmp);
+        patchOffset_ = 0;
 
-        if (patch_ == ACE_INVALID_HANDLE)
+        if (!patch_)
         {
             // no patch found
             ByteBuffer pkt;
@@ -758,20 +989,8 @@ bool AuthSocket::_HandleLogonProof()
 
         XFER_INIT xferh;
 
-        ACE_OFF_T file_size = ACE_OS::filesize(this->patch_);
-
-        if (file_size == -1)
-        {
-            close_connection();
-            return false;
-        }
-
-        if (!PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5))
-        {
-            // calculate patch md5, happens if patch was added while realmd was running
-            PatchCache::instance()->LoadPatchMD5(tmp);
-            PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5);
-        }
+        ACE_OFF_T file_size = patch_->size;
+        memcpy(xferh.md5, patch_->md5, MD5_DIGEST_LENGTH);
 
         uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_UPDATE};
         send((const char*)data, sizeof(data));
@@ -801,10 +1020,24 @@ bool AuthSocket::_HandleLogonProof()
     Sha1Hash sha;
     sha.UpdateBigNumbers(&A, &B, nullptr);
     sha.Finalize();
-    BigNumber u;
-    u.SetBinary(sha.GetDigest(), 20);
-    BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
+    task->A = A;
+    task->u.SetBinary(sha.GetDigest(), 20);
+    task->v = v;
+    task->b = b;
+    task->N = N;
+
+    return DelayCrypto<SRP6ProofTask, &AuthSocket::_HandleLogonProofSession>(SRP6_STAGE_PROOF, task);
+}
 
+/// Logon Proof, session key and password check once S is known
+bool AuthSocket::_HandleLogonProofSession(SRP6ProofTask& task)
+{
+    sAuthLogonProof_C_1_11 const& lp = task.lp;
+    PINData& pinData = task.pinData;
+    BigNumber& A = task.A;
+    BigNumber& S = task.S;
+
+    Sha1Hash sha;
     uint8 t[32];
     uint8 t1[16];
     uint8 vK[40];
@@ -888,7 +1121,9 @@ bool AuthSocket::_HandleLogonProof()
                 //add IP to exception table for 30 days.
                 std::string address = get_remote_address();
                 LoginDatabase.escape_string(address);
-                LoginDatabase.DirectPExecute("INSERT INTO `account_twofactor_allowed`(`ip_address`, `account_id`, `expires_at`) VALUES ('%s', '%u', '%llu')", address.c_str(), _accountId, time(nullptr) + (60 * 60 * 24 * 30)); // 30 days
+                LoginDatabase.BeginTransaction(MakeSqlSerialId(SQL_SERIAL_ACCOUNT, _accountId));
+                LoginDatabase.PExecute("INSERT INTO `account_twofactor_allowed`(`ip_address`, `account_id`, `expires_at`) VALUES ('%s', '%u', '%llu')", address.c_str(), _accountId, time(nullptr) + (60 * 60 * 24 * 30)); // 30 days
+                LoginDatabase.CommitTransaction();
             }
             BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' PIN result: %u", _login.c_str(), get_remote_address().c_str(), pinResult);
         }
@@ -927,6 +1162,10 @@ bool AuthSocket::_HandleLogonProof()
             return true;
         }
 
+        // kept for the final proof, sent once the database work is done
+        _proofA = A;
+        _proofM = M;
+
         // Geolocking checks must be done after an otherwise successful login to prevent lockout attacks
         if (_geoUnlockPIN) // remove the PIN to unlock the account since login succeeded
         {
@@ -937,125 +1176,200 @@ bool AuthSocket::_HandleLogonProof()
                 sLog.outError("Unable to remove geolock PIN for %s - account has not been unlocked", _safelogin.c_str());
             }
         }
-        else if (GeographicalLockCheck())
+        else if (NeedGeographicalLockCheck())
         {
-            BASIC_LOG("Account '%s' (%u) using IP '%s' has been geolocked", _login.c_str(), _accountId, get_remote_address().c_str()); // todo, add additional logging info
+            AuthQueryHolder* holder = new AuthQueryHolder();
+            holder->SetSize(MAX_AUTH_GEOLOCK_QUERY);
+            holder->SetPQuery(AUTH_GEOLOCK_QUERY_CURRENT,
+                "SELECT INET_ATON('%s') AS ip, network_start_integer, geoname_id, registered_country_geoname_id "
+                "FROM geoip "
+                "WHERE network_last_integer >= INET_ATON('%s') "
+                "ORDER BY network_last_integer ASC LIMIT 1",
+                get_remote_address().c_str(), get_remote_address().c_str());
+            holder->SetPQuery(AUTH_GEOLOCK_QUERY_PREVIOUS,
+                "SELECT INET_ATON('%s') AS ip, network_start_integer, geoname_id, registered_country_geoname_id "
+                "FROM geoip "
+                "WHERE network_last_integer >= INET_ATON('%s') "
+                "ORDER BY network_last_integer ASC LIMIT 1",
+                _lastIP.c_str(), _lastIP.c_str());
+
+            return DelayQueries<&AuthSocket::_HandleLogonProofGeoLock>(holder);
+        }
 
-            auto pin = urand(100000, 999999); // check rand32_max
-            auto result = LoginDatabase.PExecute("UPDATE account SET geolock_pin = %u WHERE username = '%s'", pin, _safelogin.c_str());
+        return _CompleteLogonProof();
+    }
+    else
+    {
+        // 1.x not react incorrectly at 4-byte message use 3 as real error
+        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
+        send(data, sizeof(data));
 
-            if (!result)
-            {
-                sLog.outError("Unable to write geolock PIN for %s - account has not been locked", _safelogin.c_str());
+        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' tried to login with wrong password!", _login.c_str (), get_remote_address().c_str());
 
-                char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_DB_BUSY };
-                send(data, sizeof(data));
-                return true;
-            }
-#ifdef USE_SENDGRID
-            if (sConfig.GetBoolDefault("SendMail", false))
-            {
-                auto mail = std::make_unique<SendgridMail>
-                (
-                    sConfig.GetStringDefault("SendGridKey", ""),
-                    sConfig.GetStringDefault("GeolockGUID", "")
-                );
-
-                mail->recipient(_email);
-                mail->from(sConfig.GetStringDefault("MailFrom", ""));
-                mail->substitution("%username%", _login);
-                mail->substitution("%unlock_pin%", std::to_string(pin));
-                mail->substitution("%originating_ip%", get_remote_address());
-
-                MailerService::get_global_mailer()->send(std::move(mail),
-                    [](SendgridMail::Result res)
-                    {
-                        DEBUG_LOG("Mail result: %d", res);
-                    }
-                );
-            }
-#endif
-            char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_PARENTCONTROL };
-            send(data, sizeof(data));
-            return true;
-        }
+        uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
+        if (MaxWrongPassCount > 0)
+        {
+            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+            // both go through the account's serial queue so that the select sees the increment
+            uint64 serialId = MakeSqlSerialId(SQL_SERIAL_ACCOUNT, _accountId);
+            LoginDatabase.BeginTransaction(serialId);
+            LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'",_safelogin.c_str());
+            LoginDatabase.CommitTransaction();
 
-        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' successfully authenticated", _login.c_str(), get_remote_address().c_str());
+            AuthQueryHolder* holder = new AuthQueryHolder(serialId);
+            holder->SetSize(1);
+            holder->SetPQuery(0, "SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str());
 
-        ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
-        // No SQL injection (escaped user name) and IP address as received by socket
-        const char* K_hex = K.AsHexStr();
-        const char* os = reinterpret_cast<char *>(&_os); // no injection as there are only two possible values
-        const char* platform = reinterpret_cast<char*>(&_platform); // no injection as there are only two possible values
-        LoginDatabase.DirectPExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0, os = '%s', platform = '%s' WHERE username = '%s'",
-            K_hex, get_remote_address().c_str(), GetLocaleByName(_localizationName), os, platform, _safelogin.c_str() );
-        
+            return DelayQueries<&AuthSocket::_HandleLogonProofFailed>(holder);
+        }
+    }
 
-        keyCache[_safelogin] = { K_hex, _accountId };
+    return true;
+}
 
-        OPENSSL_free((void*)K_hex);
+/// Logon Proof, geolocation of the previous and the current address
+bool AuthSocket::_HandleLogonProofGeoLock(SqlQueryHolder* holder)
+{
+    if (!GeographicalLockCheck(holder->GetResult(AUTH_GEOLOCK_QUERY_CURRENT), holder->GetResult(AUTH_GEOLOCK_QUERY_PREVIOUS)))
+        return _CompleteLogonProof();
 
+    BASIC_LOG("Account '%s' (%u) using IP '%s' has been geolocked", _login.c_str(), _accountId, get_remote_address().c_str()); // todo, add additional logging info
 
-        
-        LoginDatabase.PExecute("INSERT INTO `account_ip_logins` (`account_id`, `account_ip`, `login_count`) VALUES (%u, '%s', 1) ON DUPLICATE KEY UPDATE `login_count` = `login_count` + 1",
-            _accountId, get_remote_address().c_str());
+    auto pin = urand(100000, 999999); // check rand32_max
+    auto result = LoginDatabase.PExecute("UPDATE account SET geolock_pin = %u WHERE username = '%s'", pin, _safelogin.c_str());
 
+    if (!result)
+    {
+        sLog.outError("Unable to write geolock PIN for %s - account has not been locked", _safelogin.c_str());
 
-        ///- Finish SRP6 and send the final result to the client
-        sha.Initialize();
-        sha.UpdateBigNumbers(&A, &M, &K, nullptr);
-        sha.Finalize();
+        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_DB_BUSY };
+        send(data, sizeof(data));
+        return true;
+    }
+#ifdef USE_SENDGRID
+    if (sConfig.GetBoolDefault("SendMail", false))
+    {
+        auto mail = std::make_unique<SendgridMail>
+        (
+            sConfig.GetStringDefault("SendGridKey", ""),
+            sConfig.GetStringDefault("GeolockGUID", "")
+        );
 
-        SendProof(sha);
+        mail->recipient(_email);
+        mail->from(sConfig.GetStringDefault("MailFrom", ""));
+        mail->substitution("%username%", _login);
+        mail->substitution("%unlock_pin%", std::to_string(pin));
+        mail->substitution("%originating_ip%", get_remote_address());
 
-        ///- Set _status to authed!
-        _status = STATUS_AUTHED;
+        MailerService::get_global_mailer()->send(std::move(mail),
+            [](SendgridMail::Result res)
+            {
+                DEBUG_LOG("Mail result: %d", res);
+            }
+        );
     }
-    else
+#endif
+    char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_PARENTCONTROL };
+    send(data, sizeof(data));
+    return true;
+}
+
+/// Logon Proof, successful login
+bool AuthSocket::_CompleteLogonProof()
+{
+    BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' successfully authenticated", _login.c_str(), get_remote_address().c_str());
+
+    ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
+    // No SQL injection (escaped user name) and IP address as received by socket
+    // Goes through the account's serial queue: the check below and the realm list queries of this account run after it
+    uint64 serialId = MakeSqlSerialId(SQL_SERIAL_ACCOUNT, _accountId);
+    const char* K_hex = K.AsHexStr();
+    const char* os = reinterpret_cast<char *>(&_os); // no injection as there are only two possible values
+    const char* platform = reinterpret_cast<char*>(&_platform); // no injection as there are only two possible values
+    LoginDatabase.BeginTransaction(serialId);
+    LoginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0, os = '%s', platform = '%s' WHERE username = '%s'",
+        K_hex, get_remote_address().c_str(), GetLocaleByName(_localizationName), os, platform, _safelogin.c_str() );
+    LoginDatabase.PExecute("INSERT INTO `account_ip_logins` (`account_id`, `account_ip`, `login_count`) VALUES (%u, '%s', 1) ON DUPLICATE KEY UPDATE `login_count` = `login_count` + 1",
+        _accountId, get_remote_address().c_str());
+    LoginDatabase.CommitTransaction();
+
+    // the world server reads the session key as soon as the client has the proof,
+    // so the proof is only sent once the key is committed
+    AuthQueryHolder* holder = new AuthQueryHolder(serialId);
+    holder->SetSize(1);
+    holder->SetPQuery(0, "SELECT 1 FROM account WHERE id = %u AND sessionkey = '%s'", _accountId, K_hex);
+
+    OPENSSL_free((void*)K_hex);
+
+    return DelayQueries<&AuthSocket::_HandleLogonProofSessionKey>(holder);
+}
+
+/// Logon Proof, the session key is committed
+bool AuthSocket::_HandleLogonProofSessionKey(SqlQueryHolder* holder)
+{
+    if (!holder->GetResult(0))
     {
-        // 1.x not react incorrectly at 4-byte message use 3 as real error
-        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
+        sLog.outError("[AuthChallenge] Unable to save the session key of account '%s' (%u)", _login.c_str(), _accountId);
+
+        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_DB_BUSY };
         send(data, sizeof(data));
+        return true;
+    }
 
-        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' tried to login with wrong password!", _login.c_str (), get_remote_address().c_str());
+    const char* K_hex = K.AsHexStr();
+    keyCache[_safelogin] = { K_hex, _accountId };
+    OPENSSL_free((void*)K_hex);
 
-        uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
-        if (MaxWrongPassCount > 0)
-        {
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'",_safelogin.c_str());
+    sBanIndex.AddLogin(get_remote_address(), _accountId);
 
-            std::unique_ptr<QueryResult> loginfail(LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()));
-            if(loginfail)
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+    ///- Finish SRP6 and send the final result to the client
+    Sha1Hash sha;
+    sha.UpdateBigNumbers(&_proofA, &_proofM, &K, nullptr);
+    sha.Finalize();
 
-                if (failed_logins >= MaxWrongPassCount)
-                {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+    SendProof(sha);
 
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO account_banned (id, bandate, unbandate, bannedby, banreason, active, realm) "
-                            "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
-                            acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            _login.c_str(), get_remote_address().c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = get_remote_address();
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                            current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
-                            current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
-                }
-            }
+    ///- Set _status to authed!
+    _status = STATUS_AUTHED;
+    return true;
+}
+
+/// Logon Proof, wrong password: ban the account or the IP once failed_logins reaches WrongPass.MaxCount
+bool AuthSocket::_HandleLogonProofFailed(SqlQueryHolder* holder)
+{
+    QueryResult* loginfail = holder->GetResult(0);
+    if (!loginfail)
+        return true;
+
+    uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
+    Field* fields = loginfail->Fetch();
+    uint32 failed_logins = fields[1].GetUInt32();
+
+    if (failed_logins >= MaxWrongPassCount)
+    {
+        uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+        bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+
+        if (WrongPassBanType)
+        {
+            uint32 acc_id = fields[0].GetUInt32();
+            LoginDatabase.PExecute("INSERT INTO account_banned (id, bandate, unbandate, bannedby, banreason, active, realm) "
+                "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
+                acc_id, WrongPassBanTime);
+            sBanIndex.AddAccountBan(acc_id, time(nullptr), time(nullptr) + WrongPassBanTime);
+            BASIC_LOG("[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
+                _login.c_str(), get_remote_address().c_str(), WrongPassBanTime, failed_logins);
+        }
+        else
+        {
+            sBanIndex.AddIpBan(get_remote_address(), time(nullptr), time(nullptr) + WrongPassBanTime);
+
+            std::string current_ip = get_remote_address();
+            LoginDatabase.escape_string(current_ip);
+            LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                current_ip.c_str(), WrongPassBanTime);
+            BASIC_LOG("[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
+                current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
         }
     }
 
@@ -1213,71 +1527,40 @@ bool AuthSocket::_HandleRealmList()
     ///- Update realm list if need
     sRealmList.UpdateIfNeed();
 
-    ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
-    ByteBuffer pkt;
-    LoadRealmlist(pkt);
-
-    ByteBuffer hdr;
-    hdr << (uint8) CMD_REALM_LIST;
-    hdr << (uint16)pkt.size();
-    hdr.append(pkt);
-
-    send((char const*)hdr.contents(), hdr.size());
+    // character counts on every realm at once, behind the account's pending writes
+    AuthQueryHolder* holder = new AuthQueryHolder(MakeSqlSerialId(SQL_SERIAL_ACCOUNT, _accountId));
+    holder->SetSize(1);
+    holder->SetPQuery(0, "SELECT `realmid`, `numchars` FROM `realmcharacters` WHERE `acctid` = '%u'", _accountId);
 
-    return true;
+    return DelayQueries<&AuthSocket::_HandleRealmListCharacters>(holder);
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer& pkt)
+/// Realm List, patch the cached packet with the account's character counts and realm access
+bool AuthSocket::_HandleRealmListCharacters(SqlQueryHolder* holder)
 {
-    pkt << uint32(0); // unused value
-    pkt << uint8(sRealmList.size());
+    ByteBuffer pkt(sRealmList.GetPacket());
+    std::vector<RealmPacketSlot> const& slots = sRealmList.GetPacketSlots();
 
-    for (const auto& i : sRealmList)
-    {
-        uint8 AmountOfCharacters;
+    // Show offline state for unsupported client builds and locked realms (1.x clients not support locked state show)
+    for (const auto& slot : slots)
+        if (slot.build != _build || slot.allowedSecurityLevel > GetSecurityOn(slot.realmId))
+            pkt.put<uint8>(slot.flagsPos, uint8(slot.realmflags | REALM_FLAG_OFFLINE));
 
-        // No SQL injection. id of realm is controlled by the database.
-        std::unique_ptr<QueryResult> result(LoginDatabase.PQuery("SELECT `numchars` FROM `realmcharacters` WHERE `realmid` = '%d' AND `acctid`='%u'", i.second.m_ID, _accountId));
-        if (result)
+    if (QueryResult* result = holder->GetResult(0))
+    {
+        do
         {
             Field* fields = result->Fetch();
-            AmountOfCharacters = fields[0].GetUInt8();
-        }
-        else
-            AmountOfCharacters = 0;
-
-        bool ok_build = i.second.realmBuildInfo.build == _build;
-
-        RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(_build) : nullptr;
-        if (!buildInfo)
-            buildInfo = &i.second.realmBuildInfo;
-
-        RealmFlags realmflags = i.second.realmflags;
-
-        // 1.x clients not support explicitly REALM_FLAG_SPECIFYBUILD, so manually form similar name as show in more recent clients
-        std::string name = i.first;
-        if (realmflags & REALM_FLAG_SPECIFYBUILD)
-        {
-            char buf[20];
-            snprintf(buf, 20, " (%u,%u,%u)", buildInfo->major_version, buildInfo->minor_version, buildInfo->bugfix_version);
-            name += buf;
-        }
-
-        // Show offline state for unsupported client builds and locked realms (1.x clients not support locked state show)
-        if (!ok_build || (i.second.allowedSecurityLevel > GetSecurityOn(i.second.m_ID)))
-            realmflags = RealmFlags(realmflags | REALM_FLAG_OFFLINE);
-
-        pkt << uint32(i.second.icon); // realm type
-        pkt << uint8(realmflags); // realmflags
-        pkt << name; // name
-        pkt << i.second.address; // address
-        pkt << float(i.second.populationLevel);
-        pkt << uint8(AmountOfCharacters);
-        pkt << uint8(i.second.timezone); // realm category
-        pkt << uint8(0x00); // 1.12.1 empty
+            uint32 realmId = fields[0].GetUInt32();
+            for (const auto& slot : slots)
+                if (slot.realmId == realmId)
+                    pkt.put<uint8>(slot.charactersPos, fields[1].GetUInt8());
+        } while (result->NextRow());
     }
 
-    pkt << uint16(0x0002); // unused value (why 2?)
+    send((char const*)pkt.contents(), pkt.size());
+
+    return true;
 }
 
 /// Resume patch transfer
@@ -1293,25 +1576,13 @@ bool AuthSocket::_HandleXferResume()
     uint64 start_pos;
     recv((char*)&start_pos, 8);
 
-    if (patch_ == ACE_INVALID_HANDLE)
+    if (!patch_ || start_pos >= (uint64)patch_->size)
     {
         close_connection();
         return false;
     }
 
-    ACE_OFF_T file_size = ACE_OS::filesize(patch_);
-
-    if (file_size == -1 || start_pos >= (uint64)file_size)
-    {
-        close_connection();
-        return false;
-    }
-
-    if (ACE_OS::lseek(patch_, start_pos, SEEK_SET) == -1)
-    {
-        close_connection();
-        return false;
-    }
+    patchOffset_ = start_pos;
 
     InitPatch();
 
@@ -1425,9 +1696,9 @@ bool AuthSocket::ValidateToken(std::string const& secretString, PINData& data)
 
 void AuthSocket::InitPatch()
 {
-    PatchHandler* handler = new PatchHandler(ACE_OS::dup(get_handle()), patch_);
+    PatchHandler* handler = new PatchHandler(ACE_OS::dup(get_handle()), std::move(patch_), patchOffset_);
 
-    patch_ = ACE_INVALID_HANDLE;
+    patch_.reset();
 
     if (handler->open() == -1)
     {
@@ -1436,21 +1707,7 @@ void AuthSocket::InitPatch()
     }
 }
 
-void AuthSocket::LoadAccountSecurityLevels(uint32 accountId)
-{
-    std::unique_ptr<QueryResult> result(LoginDatabase.PQuery("SELECT rank FROM account WHERE id = %u", accountId));
-    if (!result)
-        return;
-
-    do
-    {
-        Field *fields = result->Fetch();
-        AccountTypes security = AccountTypes(fields[0].GetUInt32());
-        _accountDefaultSecurityLevel = security;
-    } while (result->NextRow());
-}
-
-bool AuthSocket::GeographicalLockCheck()
+bool AuthSocket::NeedGeographicalLockCheck() const
 {
     if (!sConfig.GetBoolDefault("GeoLocking"), false)
     {
@@ -1467,22 +1724,11 @@ bool AuthSocket::GeographicalLockCheck()
         return false;
     }
 
-    auto result = std::unique_ptr<QueryResult>(LoginDatabase.PQuery(
-        "SELECT INET_ATON('%s') AS ip, network_start_integer, geoname_id, registered_country_geoname_id "
-        "FROM geoip "
-        "WHERE network_last_integer >= INET_ATON('%s') "
-        "ORDER BY network_last_integer ASC LIMIT 1",
-        get_remote_address().c_str(), get_remote_address().c_str())
-        );
-
-    auto result_prev = std::unique_ptr<QueryResult>(LoginDatabase.PQuery(
-        "SELECT INET_ATON('%s') AS ip, network_start_integer, geoname_id, registered_country_geoname_id "
-        "FROM geoip "
-        "WHERE network_last_integer >= INET_ATON('%s') "
-        "ORDER BY network_last_integer ASC LIMIT 1",
-        _lastIP.c_str(), _lastIP.c_str())
-        );
+    return true;
+}
 
+bool AuthSocket::GeographicalLockCheck(QueryResult* result, QueryResult* result_prev)
+{
     if (!result && !result_prev)
     {
         return false;
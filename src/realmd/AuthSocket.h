@@ -32,6 +32,19 @@
 #include "ByteBuffer.h"
 
 #include "BufferedSocket.h"
+#include "PatchHandler.h"
+#include "SRP6Workers.h"
+
+#include <memory>
+
+class QueryResult;
+class SqlQueryHolder;
+struct SRP6VerifierTask;
+struct SRP6ProofTask;
+
+// Throttle the number of successful connections to different accounts from a single IP within a certain timeframe
+static constexpr int32 AUTH_THROTTLE_COUNT = 15;
+static constexpr int32 AUTH_THROTTLE_DURATION = 300;
 
 struct PINData
 {
@@ -65,22 +78,34 @@ class AuthSocket: public BufferedSocket
         void OnAccept();
         void OnRead();
         void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer &pkt);
         bool VerifyPinData(uint32 pin, const PINData& clientData);
         bool ValidateToken(std::string const& secretString, PINData& data);
 
         bool _HandleLogonChallenge();
+        bool _HandleLogonChallengeAccount(SqlQueryHolder* holder);
+        bool _HandleLogonChallengeSecurity(SqlQueryHolder* holder);
+        bool _QueryLogonChallengeSecurity();
         bool _HandleLogonProof();
+        bool _HandleLogonProofSession(SRP6ProofTask& task);
+        bool _HandleLogonProofGeoLock(SqlQueryHolder* holder);
+        bool _HandleLogonProofFailed(SqlQueryHolder* holder);
+        bool _CompleteLogonProof();
+        bool _HandleLogonProofSessionKey(SqlQueryHolder* holder);
         bool _HandleReconnectChallenge();
         bool _HandleReconnectProof();
         bool _HandleRealmList();
+        bool _HandleRealmListCharacters(SqlQueryHolder* holder);
         //data transfer handle for patch
 
         bool _HandleXferResume();
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
-        void _SetVSFields(const std::string& rI);
+        bool _SetVSFields(const std::string& rI);
+        bool _HandleVSFields(SRP6VerifierTask& task);
+
+        // true while some socket waits for LoginDatabase results, the main loop then polls the reactor faster
+        static bool HasPendingQueries();
 
 
         struct ProxyV1Header
@@ -105,11 +130,35 @@ class AuthSocket: public BufferedSocket
         };
 
         bool VerifyVersion(uint8 const* a, int32 aLength, uint8 const* versionProof, bool isReconnect);
+        void SendLogonChallengeError(uint8 error);
+        void SendIpBanned();
+        bool IsThrottled(int32 recentLogins);
+
+        // Database work never blocks the reactor: the handler queues a query holder and returns,
+        // the socket stops processing input until Handler runs with the results.
+        template<bool (AuthSocket::*Handler)(SqlQueryHolder*)>
+        bool DelayQueries(SqlQueryHolder* holder);
+        template<bool (AuthSocket::*Handler)(SqlQueryHolder*)>
+        static void ResumeAfterQueries(QueryResult* dummy, SqlQueryHolder* holder, uint32 socketId);
+
+        // Same for the SRP6 exponentiations, run by the crypto workers
+        template<class Task, bool (AuthSocket::*Handler)(Task&)>
+        bool DelayCrypto(SRP6Stage stage, std::shared_ptr<Task> task);
+        template<class Task, bool (AuthSocket::*Handler)(Task&)>
+        static void ResumeAfterCrypto(Task& task, uint32 socketId);
+
+        // nullptr when the socket was closed while waiting
+        static AuthSocket* ResumeSocket(uint32 socketId);
+        void ContinueAfterResume(bool handlerResult);
+
+        uint32 _socketId;
+        bool _workPending;
 
         BigNumber N, s, g, v;
         BigNumber b, B;
         BigNumber K;
         BigNumber _reconnectProof;
+        BigNumber _proofA, _proofM;
 
         bool promptPin;
 
@@ -123,6 +172,14 @@ class AuthSocket: public BufferedSocket
 
         uint32 _joindateStamp = 0;
 
+        // account row, kept between the logon challenge steps
+        uint32 _pendingAccountId;
+        uint8 _securityRank;
+        uint32 _clientLocalIp;
+        std::string _shaPassHash;
+        std::string _databaseV;
+        std::string _databaseS;
+
         BigNumber serverSecuritySalt;
         LockFlag lockFlags;
         uint32 gridSeed;
@@ -145,14 +202,15 @@ class AuthSocket: public BufferedSocket
         uint16 _build;
 
         AccountTypes GetSecurityOn(uint32 realmId) const;
-        void LoadAccountSecurityLevels(uint32 accountId);
-        bool GeographicalLockCheck();
+        bool NeedGeographicalLockCheck() const;
+        bool GeographicalLockCheck(QueryResult* result, QueryResult* result_prev);
 
         AccountTypes _accountDefaultSecurityLevel;
         typedef std::map<uint32, AccountTypes> AccountSecurityMap;
         AccountSecurityMap _accountSecurityOnRealm;
 
-        ACE_HANDLE patch_;
+        PatchCache::PatchFilePtr patch_;
+        uint64 patchOffset_;
 
         void InitPatch();
 };
@@ -0,0 +1,274 @@
+#include "BanIndex.h"
+#include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
+#include "Log.h"
+
+#include <algorithm>
+
+BanIndex sBanIndex;
+
+#define BAN_INDEX_IP_QUERY \
+    "SELECT ip, bandate, unbandate FROM ip_banned WHERE unbandate = bandate OR unbandate > UNIX_TIMESTAMP()"
+#define BAN_INDEX_ACCOUNT_QUERY \
+    "SELECT id, bandate, unbandate FROM account_banned WHERE active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)"
+
+void BanIndex::Initialize(uint32 refreshInterval, uint32 throttleWindow)
+{
+    m_refreshInterval = refreshInterval;
+    m_throttleWindow = throttleWindow;
+    if (!m_refreshInterval)
+        return;
+
+    Load(LoginDatabase.Query(BAN_INDEX_IP_QUERY), LoginDatabase.Query(BAN_INDEX_ACCOUNT_QUERY));
+
+    // logins from before the restart still count for the throttle
+    if (m_throttleWindow)
+    {
+        if (QueryResult* result = LoginDatabase.PQuery("SELECT last_ip, id, UNIX_TIMESTAMP(last_login) FROM account WHERE last_login > NOW() - INTERVAL %u SECOND", m_throttleWindow))
+        {
+            do
+            {
+                Field* fields = result->Fetch();
+                m_recentLogins[fields[0].GetCppString()].push_back({ fields[1].GetUInt32(), time_t(fields[2].GetUInt64()) });
+            } while (result->NextRow());
+            delete result;
+        }
+    }
+
+    m_nextRefresh = time(nullptr) + m_refreshInterval;
+    sLog.outString("Ban index: %u banned IPs, %u banned IP ranges, %u banned accounts.", uint32(m_ipBans.size()), uint32(m_rangeBans.size()), uint32(m_accountBans.size()));
+}
+
+void BanIndex::UpdateIfNeed()
+{
+    time_t now = time(nullptr);
+    if (!m_refreshInterval || m_refreshing || m_nextRefresh > now)
+        return;
+
+    m_nextRefresh = now + m_refreshInterval;
+
+    // drop the addresses that have not logged in for a while
+    for (auto itr = m_recentLogins.begin(); itr != m_recentLogins.end();)
+    {
+        PruneLogins(itr->second, now);
+        if (itr->second.empty())
+            itr = m_recentLogins.erase(itr);
+        else
+            ++itr;
+    }
+
+    SqlQueryHolder* holder = new SqlQueryHolder();
+    holder->SetSize(2);
+    holder->SetQuery(0, BAN_INDEX_IP_QUERY);
+    holder->SetQuery(1, BAN_INDEX_ACCOUNT_QUERY);
+
+    // the current index keeps being used until the result is processed by the main loop
+    m_refreshing = LoginDatabase.DelayQueryHolderUnsafe(this, &BanIndex::Refresh, holder);
+    if (!m_refreshing)
+        delete holder;
+}
+
+void BanIndex::Refresh(QueryResult* /*dummy*/, SqlQueryHolder* holder)
+{
+    m_refreshing = false;
+    Load(holder->GetResult(0), holder->GetResult(1));
+    delete holder;
+}
+
+void BanIndex::Load(QueryResult* ipBans, QueryResult* accountBans)
+{
+    m_ipBans.clear();
+    m_rangeBans.clear();
+    m_accountBans.clear();
+
+    if (ipBans)
+    {
+        do
+        {
+            Field* fields = ipBans->Fetch();
+            InsertIpBan(fields[0].GetCppString(), { fields[1].GetUInt64(), fields[2].GetUInt64() });
+        } while (ipBans->NextRow());
+        delete ipBans;
+    }
+
+    if (accountBans)
+    {
+        do
+        {
+            Field* fields = accountBans->Fetch();
+            InsertAccountBan(fields[0].GetUInt32(), { fields[1].GetUInt64(), fields[2].GetUInt64() });
+        } while (accountBans->NextRow());
+        delete accountBans;
+    }
+
+    MergePendingBans();
+}
+
+void BanIndex::MergePendingBans()
+{
+    uint64 now = time(nullptr);
+
+    // a pending ban is dropped once the snapshot has a ban lasting at least as long,
+    // the database clock may differ from ours by a second
+    auto covers = [](BanEntry const& loaded, BanEntry const& pending)
+    {
+        return loaded.bandate == loaded.unbandate || loaded.unbandate + 1 >= pending.unbandate;
+    };
+
+    for (auto itr = m_pendingIpBans.begin(); itr != m_pendingIpBans.end();)
+    {
+        auto loaded = m_ipBans.find(itr->first);
+        if (!itr->second.IsActive(now) || (loaded != m_ipBans.end() && covers(loaded->second, itr->second)))
+            itr = m_pendingIpBans.erase(itr);
+        else
+        {
+            InsertIpBan(itr->first, itr->second);
+            ++itr;
+        }
+    }
+
+    for (auto itr = m_pendingAccountBans.begin(); itr != m_pendingAccountBans.end();)
+    {
+        auto loaded = m_accountBans.find(itr->first);
+        if (!itr->second.IsActive(now) || (loaded != m_accountBans.end() && covers(loaded->second, itr->second)))
+            itr = m_pendingAccountBans.erase(itr);
+        else
+        {
+            InsertAccountBan(itr->first, itr->second);
+            ++itr;
+        }
+    }
+}
+
+bool BanIndex::IsIpBanned(std::string const& ip) const
+{
+    uint64 now = time(nullptr);
+
+    auto itr = m_ipBans.find(ip);
+    if (itr != m_ipBans.end() && itr->second.IsActive(now))
+        return true;
+
+    if (m_rangeBans.empty())
+        return false;
+
+    uint32 address, mask;
+    if (!ParseIPv4(ip, address, mask))
+        return false;
+
+    for (auto const& range : m_rangeBans)
+        if ((address & range.mask) == range.network && range.IsActive(now))
+            return true;
+
+    return false;
+}
+
+bool BanIndex::FindAccountBan(uint32 accountId, uint64& bandate, uint64& unbandate) const
+{
+    auto itr = m_accountBans.find(accountId);
+    if (itr == m_accountBans.end() || !itr->second.IsActive(time(nullptr)))
+        return false;
+
+    bandate = itr->second.bandate;
+    unbandate = itr->second.unbandate;
+    return true;
+}
+
+uint32 BanIndex::GetRecentLogins(std::string const& ip)
+{
+    auto itr = m_recentLogins.find(ip);
+    if (itr == m_recentLogins.end())
+        return 0;
+
+    PruneLogins(itr->second, time(nullptr));
+    return itr->second.size();
+}
+
+void BanIndex::AddIpBan(std::string const& ip, uint64 bandate, uint64 unbandate)
+{
+    BanEntry entry = { bandate, unbandate };
+
+    m_pendingIpBans[ip] = entry;
+    InsertIpBan(ip, entry);
+}
+
+void BanIndex::AddAccountBan(uint32 accountId, uint64 bandate, uint64 unbandate)
+{
+    BanEntry entry = { bandate, unbandate };
+
+    m_pendingAccountBans[accountId] = entry;
+    InsertAccountBan(accountId, entry);
+}
+
+void BanIndex::InsertIpBan(std::string const& ip, BanEntry const& entry)
+{
+    if (ip.find('/') != std::string::npos)
+    {
+        RangeBanEntry range;
+        static_cast<BanEntry&>(range) = entry;
+        if (!ParseIPv4(ip, range.network, range.mask))
+        {
+            sLog.outError("Ban index: invalid IP range '%s' in ip_banned.", ip.c_str());
+            return;
+        }
+
+        range.network &= range.mask;
+        m_rangeBans.push_back(range);
+        return;
+    }
+
+    // keep the longest ban of an address
+    auto result = m_ipBans.emplace(ip, entry);
+    BanEntry& existing = result.first->second;
+    if (!result.second && existing.bandate != existing.unbandate && (entry.bandate == entry.unbandate || entry.unbandate > existing.unbandate))
+        existing = entry;
+}
+
+void BanIndex::InsertAccountBan(uint32 accountId, BanEntry const& entry)
+{
+    auto result = m_accountBans.emplace(accountId, entry);
+    BanEntry& existing = result.first->second;
+    if (!result.second && existing.bandate != existing.unbandate && (entry.bandate == entry.unbandate || entry.unbandate > existing.unbandate))
+        existing = entry;
+}
+
+void BanIndex::AddLogin(std::string const& ip, uint32 accountId)
+{
+    if (!m_throttleWindow)
+        return;
+
+    std::vector<RecentLogin>& logins = m_recentLogins[ip];
+    for (auto& login : logins)
+    {
+        if (login.accountId == accountId)
+        {
+            login.time = time(nullptr);
+            return;
+        }
+    }
+
+    logins.push_back({ accountId, time(nullptr) });
+}
+
+void BanIndex::PruneLogins(std::vector<RecentLogin>& logins, time_t now) const
+{
+    logins.erase(std::remove_if(logins.begin(), logins.end(), [this, now](RecentLogin const& login)
+    {
+        return login.time + time_t(m_throttleWindow) <= now;
+    }), logins.end());
+}
+
+bool BanIndex::ParseIPv4(std::string const& text, uint32& address, uint32& mask)
+{
+    uint32 a, b, c, d, bits = 32;
+    char tail;
+    int count = sscanf(text.c_str(), "%u.%u.%u.%u/%u%c", &a, &b, &c, &d, &bits, &tail);
+    if (count != 4 && count != 5)
+        return false;
+
+    if (a > 255 || b > 255 || c > 255 || d > 255 || bits > 32)
+        return false;
+
+    address = (a << 24) | (b << 16) | (c << 8) | d;
+    mask = bits ? 0xFFFFFFFF << (32 - bits) : 0;
+    return true;
+}
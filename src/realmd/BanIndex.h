@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Common.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class QueryResult;
+class SqlQueryHolder;
+
+/// In memory copy of ip_banned and account_banned, plus the recent successful logons per IP
+/// used for throttling. Refreshed from the database every interval, bans issued by realmd
+/// itself are added right away and kept over the refreshes until a snapshot contains them,
+/// since their insert is asynchronous. Only used from the reactor thread.
+class BanIndex
+{
+    public:
+        BanIndex() : m_refreshInterval(0), m_throttleWindow(0), m_nextRefresh(0), m_refreshing(false) {}
+
+        // loads everything synchronously, an interval of 0 leaves the index disabled
+        void Initialize(uint32 refreshInterval, uint32 throttleWindow);
+        void UpdateIfNeed();
+
+        bool IsEnabled() const { return m_refreshInterval != 0; }
+
+        bool IsIpBanned(std::string const& ip) const;
+        bool FindAccountBan(uint32 accountId, uint64& bandate, uint64& unbandate) const;
+        // accounts that successfully logged in from this IP within the throttle window
+        uint32 GetRecentLogins(std::string const& ip);
+
+        // bans issued by realmd, not yet in the database
+        void AddIpBan(std::string const& ip, uint64 bandate, uint64 unbandate);
+        void AddAccountBan(uint32 accountId, uint64 bandate, uint64 unbandate);
+        void AddLogin(std::string const& ip, uint32 accountId);
+
+    private:
+        struct BanEntry
+        {
+            uint64 bandate;
+            uint64 unbandate;
+
+            bool IsActive(uint64 now) const { return bandate == unbandate || unbandate > now; }
+        };
+
+        struct RangeBanEntry : BanEntry
+        {
+            uint32 network;
+            uint32 mask;
+        };
+
+        struct RecentLogin
+        {
+            uint32 accountId;
+            time_t time;
+        };
+
+        typedef std::unordered_map<std::string, BanEntry> IpBanMap;
+        typedef std::vector<RangeBanEntry> RangeBanList;
+        typedef std::unordered_map<uint32, BanEntry> AccountBanMap;
+
+        void Refresh(QueryResult* dummy, SqlQueryHolder* holder);
+        void Load(QueryResult* ipBans, QueryResult* accountBans);
+        // merges the bans issued by realmd that the snapshot does not contain yet
+        void MergePendingBans();
+        void InsertIpBan(std::string const& ip, BanEntry const& entry);
+        void InsertAccountBan(uint32 accountId, BanEntry const& entry);
+        void PruneLogins(std::vector<RecentLogin>& logins, time_t now) const;
+
+        // "a.b.c.d" or "a.b.c.d/bits"
+        static bool ParseIPv4(std::string const& text, uint32& address, uint32& mask);
+
+        uint32 m_refreshInterval;
+        uint32 m_throttleWindow;
+        time_t m_nextRefresh;
+        bool m_refreshing;
+
+        IpBanMap m_ipBans;
+        RangeBanList m_rangeBans;
+        AccountBanMap m_accountBans;
+        IpBanMap m_pendingIpBans;
+        AccountBanMap m_pendingAccountBans;
+        std::unordered_map<std::string, std::vector<RecentLogin>> m_recentLogins;
+};
+
+extern BanIndex sBanIndex;
@@ -30,6 +30,8 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "SRP6Workers.h"
+#include "BanIndex.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "Util.h"
@@ -96,9 +98,9 @@ bool stopEvent = false;                                     ///< Setting it to t
 
 DatabaseType LoginDatabase;                                 ///< Accessor to the realm server database
 
-int32 PatchHandlerKBytesDownloadLimit = 1024 * 1024; // 1024 Mb/second
+std::atomic<int32_t> PatchHandlerKBytesDownloadLimit(1024 * 1024); // 1024 Mb/second
 
-uint64_t MaxDataPerSecond = 1024 * 1024 * 1024; // ^
+std::atomic<uint64_t> MaxDataPerSecond(1024 * 1024 * 1024); // ^
 
 /// Print out the usage string for this program on the console.
 void usage(const char *prog)
@@ -312,6 +314,13 @@ extern int main(int argc, char **argv)
     LoginDatabase.Execute("DELETE FROM ip_banned WHERE unbandate<=UNIX_TIMESTAMP() AND unbandate<>bandate");
     LoginDatabase.CommitTransaction();
 
+    ///- Load the bans after the expired ones are cleaned up
+    sBanIndex.Initialize(sConfig.GetIntDefault("BanIndex.RefreshInterval", 60), AUTH_THROTTLE_DURATION);
+
+    ///- Start the crypto workers before accepting any logon
+    sSRP6Workers.Start(sConfig.GetIntDefault("SRP6.WorkerThreads", 2), sConfig.GetIntDefault("SRP6.MaxQueued", 1024),
+        sConfig.GetIntDefault("SRP6.EphemeralStock", 256));
+
     ///- Launch the listening network socket
     ACE_Acceptor<AuthSocket, ACE_SOCK_Acceptor> acceptor;
 
@@ -379,13 +388,15 @@ extern int main(int argc, char **argv)
     while (!stopEvent)
     {
         // dont move this outside the loop, the reactor will modify it
-        ACE_Time_Value interval(0, 100000);
-        auto start = std::chrono::high_resolution_clock::now();
+        // sockets waiting for the database are resumed from here, don't make them wait the full interval
+        ACE_Time_Value interval(0, AuthSocket::HasPendingQueries() || sSRP6Workers.HasPending() ? 2000 : 100000);
 
         if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
             break;
 
-        sPatchLimiter.Update(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count());
+        LoginDatabase.ProcessResultQueue();
+        sSRP6Workers.ProcessCompleted();
+        sBanIndex.UpdateIfNeed();
 
         if( (++loopCounter) == numLoops )
         {
@@ -393,9 +404,12 @@ extern int main(int argc, char **argv)
             DETAIL_LOG("Ping MySQL to keep connection alive");
             LoginDatabase.Ping();
 			UpdateConfigVariables();
+            sSRP6Workers.LogStats();
         }
     }
 
+    sSRP6Workers.Stop();
+
     ///- Wait for the delay thread to exit
     LoginDatabase.HaltDelayThread();
 
@@ -469,7 +483,9 @@ bool StartDB()
         return false;
     }
 
-    if(!LoginDatabase.Initialize("Login", dbstring.c_str()))
+    int nConnections = sConfig.GetIntDefault("LoginDatabase.Connections", 1);
+    int nWorkers = sConfig.GetIntDefault("LoginDatabase.WorkerThreads", 4);
+    if(!LoginDatabase.Initialize("Login", dbstring.c_str(), nConnections, nWorkers))
     {
         sLog.outError("Cannot connect to database");
         return false;
@@ -505,7 +521,7 @@ void UpdateConfigVariables()
 
 				if (PatchHandlerKBytesDownloadLimit != kBytes)
 				{
-					sLog.outString("Changing download speed limit from %d kB. to %d kB.", PatchHandlerKBytesDownloadLimit, kBytes);
+					sLog.outString("Changing download speed limit from %d kB. to %d kB.", PatchHandlerKBytesDownloadLimit.load(), kBytes);
 					PatchHandlerKBytesDownloadLimit = kBytes;
 				}
 			}
@@ -514,7 +530,7 @@ void UpdateConfigVariables()
             case ConfigId::HardSpeedLimit:
             {
                 int32 kBytes = atoi(Value.c_str());
-                MaxDataPerSecond = (uint64_t)kBytes * 1024;
+                MaxDataPerSecond = kBytes > 0 ? (uint64_t)kBytes * 1024 : 0;
             }break;
 
 			default:
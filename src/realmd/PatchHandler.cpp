@@ -38,6 +38,12 @@
 #include <ace/OS_NS_dirent.h>
 #include <ace/OS_NS_errno.h>
 #include <ace/OS_NS_unistd.h>
+#include <ace/OS_NS_stdio.h>
+#include <ace/OS_NS_sys_stat.h>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
 
 #include <ace/os_include/netinet/os_tcp.h>
@@ -57,12 +63,15 @@
 
 PatchLimiter sPatchLimiter;
 
-extern int32 PatchHandlerKBytesDownloadLimit;
 
-struct Chunk
+struct ChunkHeader
 {
     ACE_UINT8 cmd;
     ACE_UINT16 data_size;
+};
+
+struct Chunk : ChunkHeader
+{
     ACE_UINT8 data[4096]; // 4096 - page size on most arch
 };
 
@@ -72,25 +81,20 @@ struct Chunk
 #pragma pack(pop)
 #endif
 
-PatchHandler::PatchHandler(ACE_HANDLE socket, ACE_HANDLE patch)
+PatchHandler::PatchHandler(ACE_HANDLE socket, PatchCache::PatchFilePtr patch, uint64 offset) :
+    patch_(std::move(patch)), offset_(offset)
 {
     reactor(nullptr);
     set_handle(socket);
-    patch_fd_ = patch;
-
-	LastUpdateMs = WorldTimer::getMSTime();
-	SecondLimitBytes = PatchHandlerKBytesDownloadLimit * 1024;
 }
 
 PatchHandler::~PatchHandler()
 {
-    if(patch_fd_ != ACE_INVALID_HANDLE)
-        ACE_OS::close(patch_fd_);
 }
 
 int PatchHandler::open(void*)
 {
-    if(get_handle() == ACE_INVALID_HANDLE || patch_fd_ == ACE_INVALID_HANDLE)
+    if(get_handle() == ACE_INVALID_HANDLE || !patch_)
         return -1;
 
     int nodelay = 0;
@@ -124,72 +128,69 @@ int PatchHandler::svc(void)
     // Seems client have problems with too fast sends.
     ACE_OS::sleep(1);
 
-    int flags = MSG_NOSIGNAL;
+    PatchLimiter::Registration registration(sPatchLimiter);
+    PatchTokenBucket bucket;
 
-    Chunk data;
-    data.cmd = CMD_XFER_DATA;
-
-    ssize_t r;
-
-    while((r = ACE_OS::read(patch_fd_, data.data, sizeof(data.data))) > 0)
+    while (offset_ < uint64(patch_->size))
     {
-        data.data_size = (ACE_UINT16)r;
+        uint32 size = uint32(std::min<uint64>(patch_->size - offset_, sizeof(Chunk::data)));
 
-        auto size = ((size_t)r) + sizeof(data) - sizeof(data.data);
-        while (!sPatchLimiter.IsAllowed(size))
-        {
-            ACE_Time_Value SleepValue;
-            SleepValue.set_msec(100u);
-            ACE_OS::sleep(SleepValue);
-        }
+        sPatchLimiter.Acquire(bucket, size + sizeof(ChunkHeader));
 
-		ssize_t sendedBytes = peer().send((const char*)&data,
-			size,
-			flags);
+        if (!SendChunk(size))
+            return -1;
 
-		if (sendedBytes == -1)
-		{
-			return -1;
-		}
+        offset_ += size;
+    }
 
+    return 0;
+}
 
-		SecondLimitBytes -= sendedBytes;
+bool PatchHandler::SendChunk(uint32 size)
+{
+#if defined(__linux__)
+    // header from memory, data straight from the page cache
+    ChunkHeader header;
+    header.cmd = CMD_XFER_DATA;
+    header.data_size = (ACE_UINT16)size;
 
-		if (SecondLimitBytes <= 0)
-		{
-			// check for time limit now
-			uint32 Diff = 0;
-			do 
-			{
-				uint32 CurrentTime = WorldTimer::getMSTime();
-				Diff = CurrentTime - LastUpdateMs;
-				if (Diff > 1000)
-				{
-					SecondLimitBytes = PatchHandlerKBytesDownloadLimit * 1024;
-					LastUpdateMs = CurrentTime;
-				}
-				else
-				{
-					ACE_Time_Value SleepValue;
-					SleepValue.set_msec(100u);
-					ACE_OS::sleep(SleepValue);
-				}
-			} while (Diff < 1000);
-		}
-    }
+    if (peer().send((const char*)&header, sizeof(header), MSG_NOSIGNAL | MSG_MORE) != ssize_t(sizeof(header)))
+        return false;
 
-    if(r == -1)
+    off_t offset = off_t(offset_);
+    while (size)
     {
-        return -1;
+        ssize_t sent = sendfile(get_handle(), patch_->fd, &offset, size);
+        if (sent == -1 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return false;
+
+        size -= uint32(sent);
     }
 
-    return 0;
+    return true;
+#else
+    Chunk data;
+    data.cmd = CMD_XFER_DATA;
+    data.data_size = (ACE_UINT16)size;
+
+    if (ACE_OS::pread(patch_->fd, data.data, size, ACE_OFF_T(offset_)) != ssize_t(size))
+        return false;
+
+    size_t total = sizeof(ChunkHeader) + size;
+    return peer().send_n((const char*)&data, total, MSG_NOSIGNAL) == ssize_t(total);
+#endif
+}
+
+PatchCache::PatchFile::~PatchFile()
+{
+    if (fd != ACE_INVALID_HANDLE)
+        ACE_OS::close(fd);
 }
 
 PatchCache::~PatchCache()
 {
-    for (Patches::iterator i = patches_.begin (); i != patches_.end (); i++)
-        delete i->second;
 }
 
 PatchCache::PatchCache()
@@ -206,47 +207,111 @@ PatchCache* PatchCache::instance()
     return &MaNGOS::Singleton<PatchCache, PatchCacheLock>::Instance();
 }
 
-void PatchCache::LoadPatchMD5(const char* szFileName)
+PatchCache::PatchFilePtr PatchCache::GetPatch(const char* path)
 {
-    // Try to open the patch file
-    std::string path = szFileName;
-    FILE* pPatch = fopen(path.c_str(), "rb");
-    DEBUG_LOG("Loading patch info from file %s", path.c_str());
+    char resolved[PATH_MAX];
+    if (ACE_OS::realpath(path, resolved) == nullptr)
+        return nullptr;
 
-    if(!pPatch)
-        return;
+    ACE_stat st;
+    if (ACE_OS::stat(resolved, &st) == -1)
+        return nullptr;
+
+    std::lock_guard<std::mutex> guard(lock_);
+
+    PatchFilePtr& patch = patches_[resolved];
+
+    // a replaced patch gets a new handle, downloads in progress finish with the old one
+    if (!patch || patch->mtime != st.st_mtime || patch->size != ACE_OFF_T(st.st_size))
+        patch = LoadPatch(resolved, st.st_mtime);
+
+    return patch;
+}
+
+PatchCache::PatchFilePtr PatchCache::LoadPatch(const char* path, time_t mtime)
+{
+    DEBUG_LOG("Loading patch info from file %s", path);
+
+    PatchFilePtr patch = std::make_shared<PatchFile>();
+    patch->fd = ACE_OS::open(path, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
+    if (patch->fd == ACE_INVALID_HANDLE)
+        return nullptr;
+
+    patch->size = ACE_OS::filesize(patch->fd);
+    patch->mtime = mtime;
+    if (patch->size == -1)
+        return nullptr;
+
+    if (ReadMD5Cache(path, *patch))
+        return patch;
 
     // Calculate the MD5 hash
     MD5_CTX ctx;
     MD5_Init(&ctx);
 
-    const size_t check_chunk_size = 4*1024;
-
-    ACE_UINT8 buf[check_chunk_size];
+    const size_t check_chunk_size = 64*1024;
 
-    while(!feof (pPatch))
+    std::vector<ACE_UINT8> buf(check_chunk_size);
+    ACE_OFF_T offset = 0;
+    while (offset < patch->size)
     {
-        size_t read = fread(buf, 1, check_chunk_size, pPatch);
-        MD5_Update(&ctx, buf, read);
+        ssize_t read = ACE_OS::pread(patch->fd, buf.data(), check_chunk_size, offset);
+        if (read <= 0)
+            return nullptr;
+
+        MD5_Update(&ctx, buf.data(), read);
+        offset += read;
     }
 
-    fclose(pPatch);
+    MD5_Final(patch->md5, &ctx);
 
-    // Store the result in the internal patch hash map
-    patches_[path] = new PATCH_INFO;
-    MD5_Final((ACE_UINT8 *) & patches_[path]->md5, &ctx);
+    WriteMD5Cache(path, *patch);
+    return patch;
 }
 
-bool PatchCache::GetHash(const char * pat, ACE_UINT8 mymd5[MD5_DIGEST_LENGTH])
+// single line: <size> <mtime> <md5 as hex>
+bool PatchCache::ReadMD5Cache(std::string const& path, PatchFile& patch)
 {
-    for (Patches::iterator i = patches_.begin (); i != patches_.end (); i++)
-        if (!stricmp(pat, i->first.c_str ()))
-        {
-            memcpy(mymd5, i->second->md5, MD5_DIGEST_LENGTH);
-            return true;
-        }
+    FILE* file = ACE_OS::fopen((path + ".md5").c_str(), "r");
+    if (!file)
+        return false;
+
+    unsigned long long size, mtime;
+    char hex[MD5_DIGEST_LENGTH * 2 + 1];
+    bool valid = fscanf(file, "%llu %llu %32s", &size, &mtime, hex) == 3 &&
+        size == (unsigned long long)patch.size && mtime == (unsigned long long)patch.mtime && strlen(hex) == MD5_DIGEST_LENGTH * 2;
+    ACE_OS::fclose(file);
+
+    if (!valid)
+        return false;
+
+    for (int i = 0; i < MD5_DIGEST_LENGTH; ++i)
+    {
+        unsigned int byte;
+        if (sscanf(&hex[i * 2], "%2x", &byte) != 1)
+            return false;
+
+        patch.md5[i] = ACE_UINT8(byte);
+    }
+
+    return true;
+}
+
+void PatchCache::WriteMD5Cache(std::string const& path, PatchFile const& patch)
+{
+    FILE* file = ACE_OS::fopen((path + ".md5").c_str(), "w");
+    if (!file)
+    {
+        DEBUG_LOG("Can not write the MD5 cache of %s", path.c_str());
+        return;
+    }
+
+    fprintf(file, "%llu %llu ", (unsigned long long)patch.size, (unsigned long long)patch.mtime);
+    for (int i = 0; i < MD5_DIGEST_LENGTH; ++i)
+        fprintf(file, "%02x", patch.md5[i]);
+    fprintf(file, "\n");
 
-    return false;
+    ACE_OS::fclose(file);
 }
 
 #ifdef WIN32
@@ -278,7 +343,7 @@ void PatchCache::LoadPatchesInfo()
 
 		if (clearFilename.extension().compare("mpq"))
 		{
-			LoadPatchMD5(strClearFilename.c_str());
+			GetPatch(strClearFilename.c_str());
 		}
 	}
 #else
@@ -301,7 +366,7 @@ void PatchCache::LoadPatchesInfo()
         if (!memcmp(&dp->d_name[l - 4], ".mpq", 4))
         {
             fullpath = path + dp->d_name;
-            LoadPatchMD5(fullpath.c_str());
+            GetPatch(fullpath.c_str());
 }
 	}
 
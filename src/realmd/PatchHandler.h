@@ -34,13 +34,14 @@
 #include <ace/SOCK_Stream.h>
 #include <ace/Message_Block.h>
 #include <map>
-#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include <openssl/bn.h>
 #include <openssl/md5.h>
 
 /**
- * @brief Caches MD5 hash of client patches present on the server
+ * @brief Keeps client patches present on the server open, with their MD5 hash
  */
 class PatchCache
 {
@@ -50,30 +51,34 @@ class PatchCache
 
         static PatchCache* instance();
 
-        struct PATCH_INFO
+        /// Opened once and shared by every download of the patch, read with positional reads only
+        struct PatchFile
         {
+            PatchFile() : fd(ACE_INVALID_HANDLE), size(0), mtime(0) {}
+            ~PatchFile();
+
+            ACE_HANDLE fd;
+            ACE_OFF_T size;
+            time_t mtime;
             ACE_UINT8 md5[MD5_DIGEST_LENGTH];
         };
 
-        typedef std::map<std::string, PATCH_INFO*> Patches;
-
-        Patches::const_iterator begin() const
-        {
-            return patches_.begin();
-        }
-
-        Patches::const_iterator end() const
-        {
-            return patches_.end();
-        }
+        typedef std::shared_ptr<PatchFile> PatchFilePtr;
 
-        void LoadPatchMD5(const char*);
-        bool GetHash(const char * pat, ACE_UINT8 mymd5[MD5_DIGEST_LENGTH]);
+        // nullptr when the patch does not exist, reloaded when the file changed on disk
+        PatchFilePtr GetPatch(const char* path);
 
     private:
         void LoadPatchesInfo();
-        Patches patches_;
+        PatchFilePtr LoadPatch(const char* path, time_t mtime);
+
+        // <patch>.md5 next to the patch saves reading the whole file at every start
+        static bool ReadMD5Cache(std::string const& path, PatchFile& patch);
+        static void WriteMD5Cache(std::string const& path, PatchFile const& patch);
 
+        typedef std::map<std::string, PatchFilePtr> Patches;
+        Patches patches_;
+        std::mutex lock_;
 };
 
 class PatchHandler: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
@@ -82,7 +87,7 @@ class PatchHandler: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
         typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> Base;
 
     public:
-        PatchHandler(ACE_HANDLE socket, ACE_HANDLE patch);
+        PatchHandler(ACE_HANDLE socket, PatchCache::PatchFilePtr patch, uint64 offset);
         virtual ~PatchHandler();
 
         int open(void* = 0);
@@ -91,9 +96,10 @@ class PatchHandler: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
         virtual int svc(void);
 
     private:
-        ACE_HANDLE patch_fd_;
-		int32 SecondLimitBytes = 0;
-		uint32 LastUpdateMs = 0;
+        bool SendChunk(uint32 size);
+
+        PatchCache::PatchFilePtr patch_;
+        uint64 offset_;
 };
 
 #endif /* _BK_PATCHHANDLER_H__ */
@@ -1,38 +1,83 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <stdint.h>
+#include <thread>
 
-#include "Database/DatabaseEnv.h"
+extern std::atomic<uint64_t> MaxDataPerSecond;              // all patch downloads together, 0 = unlimited
+extern std::atomic<int32_t> PatchHandlerKBytesDownloadLimit; // a single patch download, <= 0 = unlimited
 
-extern uint64_t MaxDataPerSecond;
+/// Send budget of one patch download
+struct PatchTokenBucket
+{
+	double tokens = 0.0;
+	std::chrono::steady_clock::time_point lastRefill = std::chrono::steady_clock::now();
+};
 
+/// Shares the patch bandwidth evenly between the running downloads.
+/// Each download refills its own bucket at min(per download limit, total limit / downloads)
+/// and sleeps exactly as long as it needs for its next chunk, instead of polling a global budget.
 class PatchLimiter
 {
 public:
+	class Registration
+	{
+	public:
+		explicit Registration(PatchLimiter& limiter) : m_limiter(limiter) { ++m_limiter.activeDownloads; }
+		~Registration() { --m_limiter.activeDownloads; }
+
+	private:
+		PatchLimiter& m_limiter;
+	};
 
-	void Update(uint32_t diff)
+	uint32_t GetActiveDownloads() const { return activeDownloads.load(std::memory_order_relaxed); }
+
+	// blocks the calling download thread until it may send bytes
+	void Acquire(PatchTokenBucket& bucket, uint32_t bytes)
 	{
-		if (timeDiff < diff)
+		while (true)
 		{
-			timeDiff = 1000;
-			totalCurrentBandwidth.store(0, std::memory_order_seq_cst);
+			double rate = GetRate();
+			if (rate <= 0.0)
+				return;
+
+			auto now = std::chrono::steady_clock::now();
+			double elapsed = std::chrono::duration<double>(now - bucket.lastRefill).count();
+			bucket.lastRefill = now;
+
+			// bursts of at most 100ms worth of data, but always enough for one chunk
+			double burst = std::max(rate / 10.0, double(bytes));
+			bucket.tokens = std::min(bucket.tokens + rate * elapsed, burst);
+
+			if (bucket.tokens >= bytes)
+			{
+				bucket.tokens -= bytes;
+				return;
+			}
+
+			std::this_thread::sleep_for(std::chrono::duration<double>((bytes - bucket.tokens) / rate));
 		}
-		else
-			timeDiff -= diff;
 	}
 
-	bool IsAllowed(uint32_t bytes)
+private:
+	// bytes per second for one download, 0 when unlimited
+	double GetRate() const
 	{
-		if (totalCurrentBandwidth.load(std::memory_order_relaxed) >= MaxDataPerSecond)
-			return false;
+		double rate = 0.0;
 
-		totalCurrentBandwidth.fetch_add(bytes, std::memory_order_relaxed);
-		return true;
+		uint64_t total = MaxDataPerSecond.load(std::memory_order_relaxed);
+		if (total)
+			rate = double(total) / std::max<uint32_t>(GetActiveDownloads(), 1);
+
+		int32_t kBytes = PatchHandlerKBytesDownloadLimit.load(std::memory_order_relaxed);
+		if (kBytes > 0 && (rate <= 0.0 || rate > kBytes * 1024.0))
+			rate = kBytes * 1024.0;
+
+		return rate;
 	}
 
-private:
-	std::atomic_uint64_t totalCurrentBandwidth;
-	uint32_t timeDiff = 1000;
+	std::atomic<uint32_t> activeDownloads{0};
 };
 
-extern PatchLimiter sPatchLimiter;
\ No newline at end of file
+extern PatchLimiter sPatchLimiter;
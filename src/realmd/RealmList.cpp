@@ -29,6 +29,7 @@
 #include "Util.h"                                           // for Tokens typedef
 #include "Policies/SingletonImp.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Config/Config.h"
 
 RealmList sRealmList;
@@ -55,7 +56,14 @@ RealmBuildInfo const* FindBuildInfo(uint16 _build)
     return nullptr;
 }
 
-RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(nullptr))
+#define REALMLIST_QUERY \
+    /*      0   1       2       3       4   5           6 */ \
+    "SELECT id, name, address, port, icon, realmflags, timezone, " \
+    /* 7                    8 */ \
+    "allowedSecurityLevel, population FROM realmlist " \
+    "WHERE (realmflags & 1) = 0 ORDER BY name"
+
+RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(nullptr)), m_updating(false)
 {
 }
 
@@ -96,28 +104,33 @@ void RealmList::UpdateRealm( uint32 ID, const std::string& name, const std::stri
 void RealmList::UpdateIfNeed()
 {
     // maybe disabled or updated recently
-    if(!m_UpdateInterval || m_NextUpdateTime > time(nullptr))
+    if(!m_UpdateInterval || m_updating || m_NextUpdateTime > time(nullptr))
         return;
 
     m_NextUpdateTime = time(nullptr) + m_UpdateInterval;
 
+    // the current list keeps being served until the result is processed by the main loop
+    m_updating = LoginDatabase.AsyncQueryUnsafe(this, &RealmList::UpdateRealmsCallback, REALMLIST_QUERY);
+}
+
+void RealmList::UpdateRealmsCallback(QueryResult* result)
+{
+    m_updating = false;
+
     // Clears Realm list
     m_realms.clear();
 
-    // Get the content of the realmlist table in the database
-    UpdateRealms(false);
+    LoadRealms(result, false);
 }
 
 void RealmList::UpdateRealms(bool init)
 {
-    DETAIL_LOG("Updating Realm List...");
+    LoadRealms(LoginDatabase.Query(REALMLIST_QUERY), init);
+}
 
-    QueryResult *result = LoginDatabase.Query(
-        //      0   1       2       3       4   5           6
-        "SELECT id, name, address, port, icon, realmflags, timezone, "
-        // 7                    8        
-        "allowedSecurityLevel, population FROM realmlist "
-        "WHERE (realmflags & 1) = 0 ORDER BY name");
+void RealmList::LoadRealms(QueryResult* result, bool init)
+{
+    DETAIL_LOG("Updating Realm List...");
 
     // Auth config can't be reloaded. Make sure you use a valid address.
     static const std::string overrideAddrStr = sConfig.GetStringDefault("HostAddressOverride", "0.0.0.0");
@@ -151,4 +164,55 @@ void RealmList::UpdateRealms(bool init)
         } while( result->NextRow() );
         delete result;
     }
+
+    BuildPacket();
+}
+
+/// Serialize the realm list once per update, only the flags and the character count differ between clients
+void RealmList::BuildPacket()
+{
+    m_packet.clear();
+    m_packetSlots.clear();
+
+    m_packet << uint8(CMD_REALM_LIST);
+    m_packet << uint16(0);                                  // size, set below
+    m_packet << uint32(0);                                  // unused value
+    m_packet << uint8(m_realms.size());
+
+    for (const auto& i : m_realms)
+    {
+        Realm const& realm = i.second;
+
+        // 1.x clients not support explicitly REALM_FLAG_SPECIFYBUILD, so manually form similar name as show in more recent clients
+        // accepted client builds all share the realm's build info, the name is the same for everyone
+        std::string name = i.first;
+        if (realm.realmflags & REALM_FLAG_SPECIFYBUILD)
+        {
+            char buf[20];
+            snprintf(buf, 20, " (%u,%u,%u)", realm.realmBuildInfo.major_version, realm.realmBuildInfo.minor_version, realm.realmBuildInfo.bugfix_version);
+            name += buf;
+        }
+
+        RealmPacketSlot slot;
+        slot.realmId = realm.m_ID;
+        slot.build = realm.realmBuildInfo.build;
+        slot.allowedSecurityLevel = realm.allowedSecurityLevel;
+        slot.realmflags = realm.realmflags;
+
+        m_packet << uint32(realm.icon); // realm type
+        slot.flagsPos = m_packet.wpos();
+        m_packet << uint8(realm.realmflags); // realmflags
+        m_packet << name; // name
+        m_packet << realm.address; // address
+        m_packet << float(realm.populationLevel);
+        slot.charactersPos = m_packet.wpos();
+        m_packet << uint8(0); // characters
+        m_packet << uint8(realm.timezone); // realm category
+        m_packet << uint8(0x00); // 1.12.1 empty
+
+        m_packetSlots.push_back(slot);
+    }
+
+    m_packet << uint16(0x0002); // unused value (why 2?)
+    m_packet.put<uint16>(1, uint16(m_packet.size() - 3));
 }
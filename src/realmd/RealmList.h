@@ -27,8 +27,11 @@
 #define _REALMLIST_H
 
 #include "Common.h"
+#include "ByteBuffer.h"
 #include <array>
 
+class QueryResult;
+
 struct RealmBuildInfo
 {
     int build;
@@ -57,6 +60,17 @@ struct Realm
     RealmBuildInfo realmBuildInfo;                          // build info for show version in list
 };
 
+/// Client dependent fields of a realm in the cached realm list packet
+struct RealmPacketSlot
+{
+    uint32 realmId;
+    uint32 build;
+    AccountTypes allowedSecurityLevel;
+    RealmFlags realmflags;
+    size_t flagsPos;                                        // patched with REALM_FLAG_OFFLINE for unsupported builds and locked realms
+    size_t charactersPos;                                   // account's character count, 0 in the cached packet
+};
+
 /// Storage object for the list of realms on the server
 class RealmList
 {
@@ -73,13 +87,24 @@ class RealmList
         RealmMap::const_iterator begin() const { return m_realms.begin(); }
         RealmMap::const_iterator end() const { return m_realms.end(); }
         uint32 size() const { return m_realms.size(); }
+
+        // CMD_REALM_LIST packet including its header, rebuilt whenever the realms are reloaded
+        ByteBuffer const& GetPacket() const { return m_packet; }
+        std::vector<RealmPacketSlot> const& GetPacketSlots() const { return m_packetSlots; }
     private:
         void UpdateRealms(bool init);
+        void UpdateRealmsCallback(QueryResult* result);
+        void LoadRealms(QueryResult* result, bool init);
+        void BuildPacket();
         void UpdateRealm( uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, RealmFlags realmflags, uint8 timezone, AccountTypes allowedSecurityLevel, float popu);
     private:
         RealmMap m_realms;                                  ///< Internal map of realms
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
+        bool     m_updating;                                ///< reload query is queued
+
+        ByteBuffer m_packet;
+        std::vector<RealmPacketSlot> m_packetSlots;
 };
 
 extern RealmList sRealmList;
@@ -0,0 +1,192 @@
+#include "SRP6Workers.h"
+#include "Log.h"
+
+SRP6Workers sSRP6Workers;
+
+static char const* SRP6StageNames[MAX_SRP6_STAGE] =
+{
+    "ephemeral",
+    "verifier",
+    "proof",
+    "queue wait",
+};
+
+SRP6Workers::SRP6Workers() : m_running(false), m_maxQueued(0), m_ephemeralStock(0), m_pending(0),
+    m_ephemeralHits(0), m_ephemeralMisses(0), m_queueFull(0)
+{
+    m_N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+    m_g.SetDword(7);
+}
+
+void SRP6Workers::Start(uint32 threads, uint32 maxQueued, uint32 ephemeralStock)
+{
+    if (m_running || !threads)
+        return;
+
+    m_maxQueued = maxQueued;
+    m_ephemeralStock = ephemeralStock;
+    m_ephemerals.reserve(ephemeralStock);
+    m_running = true;
+
+    for (uint32 i = 0; i < threads; ++i)
+        m_threads.emplace_back(&SRP6Workers::WorkerThread, this);
+}
+
+void SRP6Workers::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_running)
+            return;
+
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+
+    // sockets are going away with the reactor, nobody waits for these anymore
+    m_queue.clear();
+}
+
+bool SRP6Workers::Post(SRP6Stage stage, Callback&& work, Callback&& complete)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_running)
+            return false;
+
+        if (m_queue.size() >= m_maxQueued)
+        {
+            ++m_queueFull;
+            return false;
+        }
+
+        m_queue.push_back({ stage, std::move(work), std::move(complete), std::chrono::steady_clock::now() });
+        ++m_pending;
+    }
+
+    m_wake.notify_one();
+    return true;
+}
+
+void SRP6Workers::Execute(SRP6Stage stage, Callback const& work)
+{
+    LatencyTimer timer;
+    work();
+    Record(stage, timer.Stop());
+}
+
+void SRP6Workers::ProcessCompleted()
+{
+    Callback complete;
+    while (m_completed.next(complete))
+    {
+        --m_pending;
+        complete();
+    }
+}
+
+void SRP6Workers::TakeEphemeral(BigNumber& b, BigNumber& gb)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_ephemerals.empty())
+        {
+            b = m_ephemerals.back().b;
+            gb = m_ephemerals.back().gb;
+            m_ephemerals.pop_back();
+            ++m_ephemeralHits;
+
+            // below the stock now, an idle worker refills it
+            m_wake.notify_one();
+            return;
+        }
+    }
+
+    ++m_ephemeralMisses;
+
+    LatencyTimer timer;
+    b.SetRand(19 * 8);
+    gb = m_g.ModExp(b, m_N);
+    Record(SRP6_STAGE_EPHEMERAL, timer.Stop());
+}
+
+void SRP6Workers::WorkerThread()
+{
+    // own copies, BigNumber operations are not meant to share operands across threads
+    BigNumber N = m_N;
+    BigNumber g = m_g;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    while (true)
+    {
+        m_wake.wait(guard, [this]
+        {
+            return !m_running || !m_queue.empty() || m_ephemerals.size() < m_ephemeralStock;
+        });
+
+        if (!m_running)
+            return;
+
+        if (m_queue.empty())
+        {
+            // idle, top up the ephemeral stock
+            guard.unlock();
+
+            LatencyTimer timer;
+            Ephemeral ephemeral;
+            ephemeral.b.SetRand(19 * 8);
+            ephemeral.gb = g.ModExp(ephemeral.b, N);
+            Record(SRP6_STAGE_EPHEMERAL, timer.Stop());
+
+            guard.lock();
+            if (m_ephemerals.size() < m_ephemeralStock)
+                m_ephemerals.push_back(std::move(ephemeral));
+            continue;
+        }
+
+        Task task = std::move(m_queue.front());
+        m_queue.pop_front();
+        guard.unlock();
+
+        Record(SRP6_STAGE_QUEUE_WAIT, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - task.queuedAt).count());
+        Execute(task.stage, task.work);
+        m_completed.add(task.complete);
+
+        guard.lock();
+    }
+}
+
+void SRP6Workers::Record(SRP6Stage stage, uint64 us)
+{
+    SRP6StageStats& stats = m_stats[stage];
+    stats.count.fetch_add(1, std::memory_order_relaxed);
+    stats.totalUs.fetch_add(us, std::memory_order_relaxed);
+    stats.latency.Add(us);
+}
+
+void SRP6Workers::LogStats()
+{
+    for (uint32 i = 0; i < MAX_SRP6_STAGE; ++i)
+    {
+        SRP6StageStats const& stats = m_stats[i];
+        uint64 count = stats.count.load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+
+        BASIC_LOG("SRP6 %s: " UI64FMTD " runs, avg " UI64FMTD " us, p50 " UI64FMTD " us, p99 " UI64FMTD " us", SRP6StageNames[i],
+            count, stats.totalUs.load(std::memory_order_relaxed) / count, stats.latency.Percentile(50.0f), stats.latency.Percentile(99.0f));
+    }
+
+    uint32 stock;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        stock = m_ephemerals.size();
+    }
+
+    BASIC_LOG("SRP6 ephemeral stock %u/%u, " UI64FMTD " taken, " UI64FMTD " computed in place, " UI64FMTD " posts refused (queue full)",
+        stock, m_ephemeralStock, m_ephemeralHits.load(), m_ephemeralMisses.load(), m_queueFull.load());
+}
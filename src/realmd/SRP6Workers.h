@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+#include "LatencyHistogram.h"
+#include "LockedQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum SRP6Stage
+{
+    SRP6_STAGE_EPHEMERAL,                                   // b and g^b mod N of the logon challenge
+    SRP6_STAGE_VERIFIER,                                    // v = g^x mod N, accounts without v and s in the database
+    SRP6_STAGE_PROOF,                                       // S = (A * v^u)^b mod N of the logon proof
+    SRP6_STAGE_QUEUE_WAIT,                                  // posted to picked up by a worker
+    MAX_SRP6_STAGE
+};
+
+struct SRP6StageStats
+{
+    std::atomic<uint64> count{0};
+    std::atomic<uint64> totalUs{0};
+    LatencyHistogram latency;
+};
+
+/// Runs the SRP6 modular exponentiations away from the reactor thread.
+/// Work is executed by a bounded pool of crypto threads, its completion is called back
+/// from ProcessCompleted in the main loop. Idle workers keep a stock of ephemeral
+/// (b, g^b mod N) pairs so that the logon challenge does not need any exponentiation.
+class SRP6Workers
+{
+    public:
+        typedef std::function<void()> Callback;
+
+        SRP6Workers();
+        ~SRP6Workers() { Stop(); }
+
+        void Start(uint32 threads, uint32 maxQueued, uint32 ephemeralStock);
+        void Stop();
+
+        BigNumber const& GetN() const { return m_N; }
+        BigNumber const& GetG() const { return m_g; }
+
+        // false when there are no workers or the queue is full, the caller then runs the work itself
+        bool Post(SRP6Stage stage, Callback&& work, Callback&& complete);
+        // runs work on the calling thread, timed like the posted ones
+        void Execute(SRP6Stage stage, Callback const& work);
+
+        void ProcessCompleted();
+        bool HasPending() const { return m_pending.load(std::memory_order_relaxed) != 0; }
+
+        // a precomputed pair when available, computed in place otherwise
+        void TakeEphemeral(BigNumber& b, BigNumber& gb);
+
+        void LogStats();
+
+    private:
+        struct Task
+        {
+            SRP6Stage stage;
+            Callback work;
+            Callback complete;
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+
+        struct Ephemeral
+        {
+            BigNumber b;
+            BigNumber gb;
+        };
+
+        void WorkerThread();
+        void Record(SRP6Stage stage, uint64 us);
+
+        BigNumber m_N;
+        BigNumber m_g;
+
+        std::vector<std::thread> m_threads;
+        bool m_running;
+        uint32 m_maxQueued;
+        uint32 m_ephemeralStock;
+
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        std::deque<Task> m_queue;
+        std::vector<Ephemeral> m_ephemerals;
+
+        LockedQueue<Callback, std::mutex> m_completed;
+        std::atomic<uint32> m_pending;
+
+        SRP6StageStats m_stats[MAX_SRP6_STAGE];
+        std::atomic<uint64> m_ephemeralHits;
+        std::atomic<uint64> m_ephemeralMisses;
+        std::atomic<uint64> m_queueFull;
+};
+
+extern SRP6Workers sSRP6Workers;
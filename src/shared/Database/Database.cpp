@@ -23,6 +23,7 @@
 #include "DatabaseEnv.h"
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
+#include "Timer.h"
 
 #include <ctime>
 #include <iostream>
@@ -126,21 +127,55 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id )
     //get prepared statement object
     if (SqlPreparedStatement * pStmt = GetStmt(nIndex))
     {
+        SqlStatementStats* stats = m_db.GetStatementStats().GetPreparedStats(nIndex, m_db);
+        LatencyTimer timer;
+
         //bind parameters
         pStmt->bind(id);
         //execute statement
-        return pStmt->execute();
+        bool result = pStmt->execute();
+
+        if (stats)
+            m_db.GetStatementStats().Record(stats, timer.Stop(), 0, id);
+
+        return result;
     }
     return false;
 }
 
+QueryResult* SqlConnection::QueryWithStats(const char* sql)
+{
+    SqlStatementStats* stats = m_db.GetStatementStats().GetRawStats(sql);
+    LatencyTimer timer;
+
+    QueryResult* result = Query(sql);
+
+    if (stats)
+        m_db.GetStatementStats().Record(stats, timer.Stop(), result ? result->GetRowCount() : 0, sql);
+
+    return result;
+}
+
+bool SqlConnection::ExecuteWithStats(const char* sql)
+{
+    SqlStatementStats* stats = m_db.GetStatementStats().GetRawStats(sql);
+    LatencyTimer timer;
+
+    bool result = Execute(sql);
+
+    if (stats)
+        m_db.GetStatementStats().Record(stats, timer.Stop(), 0, sql);
+
+    return result;
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char* name, const char *infoString, int nConns /*= 1*/, int nWorkers /*= 1*/)
+bool Database::Initialize(const char* name, const char *infoString, int nConns /*= 1*/, int nWorkers /*= 1*/, int nShards /*= 0*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -154,6 +189,8 @@ bool Database::Initialize(const char* name, const char *infoString, int nConns /
 
     m_pingIntervallms = sConfig.GetIntDefault ("MaxPingTime", 30) * (MINUTE * 1000);
 
+    m_statementStats.Initialize(sConfig.GetBoolDefault("Database.StatementStats", true), sConfig.GetIntDefault("Database.SlowQueryMs", 100));
+
     //create DB connections
 
     //setup connection pool size
@@ -189,6 +226,13 @@ bool Database::Initialize(const char* name, const char *infoString, int nConns /
         if (!InitDelayThread(name,infoString))
             return false;
 
+    if (nShards > MAX_CONNECTION_POOL_SIZE)
+        nShards = MAX_CONNECTION_POOL_SIZE;
+
+    for (int i = 0; i < nShards; ++i)
+        if (!InitSerialShard(name, infoString))
+            return false;
+
     return true;
 }
 
@@ -235,8 +279,35 @@ bool Database::InitDelayThread(const char* Name, std::string const& infoString)
     return true;
 }
 
+bool Database::InitSerialShard(const char* Name, std::string const& infoString)
+{
+    SqlConnection* threadConnection = CreateConnection();
+    if (!threadConnection->Initialize(infoString.c_str()))
+    {
+        delete threadConnection;
+        return false;
+    }
+
+    std::shared_ptr<SqlDelayThread> tbody = std::make_shared<SqlDelayThread>(Name, this, threadConnection, false);
+    m_serialShards.emplace_back(tbody);
+    m_serialShardThreads.emplace_back([tbody](){
+        tbody->run();
+    });
+
+    return true;
+}
+
 void Database::HaltDelayThread()
 {
+    for (const auto& shard : m_serialShards)
+        shard->Stop();
+
+    for (auto& thread : m_serialShardThreads)
+        thread.join();
+
+    m_serialShards.clear();
+    m_serialShardThreads.clear();
+
     if (m_delayThreads.empty() || m_threadsBodies.empty())
         return;
 
@@ -483,7 +554,7 @@ bool Database::DirectPExecute(const char * format,...)
     return DirectExecute(szQuery);
 }
 
-bool Database::BeginTransaction(uint32 serialId)
+bool Database::BeginTransaction(uint64 serialId)
 {
     if (!m_pAsyncConn)
     {
@@ -507,7 +578,7 @@ bool Database::InTransaction()
     return m_TransStorage->get() != nullptr;
 }
 
-uint32 Database::GetTransactionSerialId()
+uint64 Database::GetTransactionSerialId()
 {
     if (SqlTransaction *trans = m_TransStorage->get())
         return trans->GetSerialId();
@@ -583,8 +654,22 @@ bool Database::RollbackTransaction()
     return true;
 }
 
+void Database::AddToDelayQueue(SqlOperation* op)
+{
+    op->SetQueuedTime(WorldTimer::getMSTime());
+    m_delayQueue->add(op);
+}
+
 void Database::AddToSerialDelayQueue(SqlOperation *op)
 {
+    if (op->GetSerialId() != 0 && !m_serialShards.empty())
+    {
+        // Fibonacci hashing, so that sequential guids and the key space bits spread evenly
+        uint64 hash = op->GetSerialId() * UI64LIT(0x9E3779B97F4A7C15);
+        m_serialShards[(hash >> 32) % m_serialShards.size()]->addSerialOperation(op);
+        return;
+    }
+
     if (op->GetSerialId() == 0 || m_numAsyncWorkers == 0)
     {
         AddToDelayQueue(op);
@@ -605,9 +690,21 @@ bool Database::HasAsyncQuery()
     for (uint32 i = 0; i < m_numAsyncWorkers && !hasQuery; ++i)
         hasQuery = m_threadsBodies[i]->HasAsyncQuery();
 
+    for (size_t i = 0; i < m_serialShards.size() && !hasQuery; ++i)
+        hasQuery = m_serialShards[i]->HasAsyncQuery();
+
     return hasQuery;
 }
 
+void Database::GetSerialShardStats(std::vector<SqlDelayThreadStats>& stats) const
+{
+    stats.clear();
+    stats.reserve(m_serialShards.size());
+
+    for (const auto& shard : m_serialShards)
+        stats.push_back(shard->GetStats());
+}
+
 bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params)
 {
     if (!m_pAsyncConn)
@@ -692,7 +789,7 @@ Database::TransHelper::~TransHelper()
     reset();
 }
 
-SqlTransaction * Database::TransHelper::init(uint32 serialId)
+SqlTransaction * Database::TransHelper::init(uint64 serialId)
 {
     MANGOS_ASSERT(!m_pTrans);   //if we will get a nested transaction request - we MUST fix code!!!
     m_pTrans = new SqlTransaction(serialId);
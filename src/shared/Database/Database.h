@@ -27,6 +27,7 @@
 #include "Policies/ThreadingModel.h"
 #include <ace/TSS_T.h>
 #include "SqlPreparedStatement.h"
+#include "SqlStats.h"
 #include <memory>
 #include <thread>
 #include <optional>
@@ -41,6 +42,21 @@ class Database;
 
 #define MAX_QUERY_LEN   (32*1024)
 
+// Serial ids keep async operations sharing the same key in order. The low 32 bits
+// hold the entity id and the high bits its key space, so that a guild and a
+// character with the same low id are distinct keys.
+enum SqlSerialKeyType
+{
+    SQL_SERIAL_CHARACTER    = 0,                            // guid low, what BeginTransaction(GetGUIDLow()) passes
+    SQL_SERIAL_ACCOUNT      = 1,
+    SQL_SERIAL_GUILD        = 2,
+};
+
+inline uint64 MakeSqlSerialId(SqlSerialKeyType type, uint32 id)
+{
+    return id ? (uint64(type) << 32) | id : 0;
+}
+
 using SqlQueue = LockedQueue<SqlOperation*, std::mutex>;
 
 //
@@ -73,6 +89,10 @@ class SqlConnection
         //methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
 
+        //same as Query/Execute, but accounted in the owning Database statement statistics
+        QueryResult* QueryWithStats(const char* sql);
+        bool ExecuteWithStats(const char* sql);
+
         //SqlConnection object lock
         class Lock
         {
@@ -122,9 +142,11 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* name, const char *infoString, int nConns = 1, int nWorkers = 1);
+        virtual bool Initialize(const char* name, const char *infoString, int nConns = 1, int nWorkers = 1, int nShards = 0);
         //start worker thread for async DB request execution
         virtual bool InitDelayThread(const char* Name, std::string const& infoString);
+        //start worker thread dedicated to serial operations hashed onto it
+        bool InitSerialShard(const char* Name, std::string const& infoString);
         //stop worker thread
         virtual void HaltDelayThread();
 
@@ -132,7 +154,7 @@ class Database
         inline QueryResult* Query(const char *sql)
         {
             SqlConnection::Lock guard(getQueryConnection());
-            return guard->Query(sql);
+            return guard->QueryWithStats(sql);
         }
 
         inline QueryNamedResult* QueryNamed(const char *sql)
@@ -150,7 +172,7 @@ class Database
                 return false;
 
             SqlConnection::Lock guard(m_pAsyncConn);
-            return guard->Execute(sql);
+            return guard->ExecuteWithStats(sql);
         }
 
         bool DirectPExecute(const char *format,...) ATTR_PRINTF(2,3);
@@ -231,9 +253,9 @@ class Database
         // Writes SQL commands to a LOG file (see mangosd.conf "LogSQL")
         bool PExecuteLog(const char *format,...) ATTR_PRINTF(2,3);
 
-        bool BeginTransaction(uint32 serialId = 0);
+        bool BeginTransaction(uint64 serialId = 0);
         bool InTransaction();
-        uint32 GetTransactionSerialId();
+        uint64 GetTransactionSerialId();
         bool CommitTransaction(std::function<void(bool)>* callback = nullptr);
         bool RollbackTransaction();
         //for sync transaction execution
@@ -268,18 +290,28 @@ class Database
         //you should call it explicitly after your server successfully started up
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
-        inline void AddToDelayQueue(SqlOperation* op) { m_delayQueue->add(op); }
+        void AddToDelayQueue(SqlOperation* op);
         inline bool NextDelayedOperation(SqlOperation*& op) { return m_delayQueue->next(op); }
 
         inline void AddToSerialDelayQueue(int workerId, SqlOperation* op) { m_threadsBodies[workerId]->addSerialOperation(op); }
         bool NextSerialDelayedOperation(int workerId, SqlOperation*& op);
 
         bool HasAsyncQuery();
+        uint32 GetAsyncWorkerCount() const { return m_numAsyncWorkers; }
 
         void AddToSerialDelayQueue(SqlOperation *op);
 
+        // Serial write shards. When enabled, operations with a serial id are hashed onto
+        // dedicated connections which do not pick up from the shared delay queue, so
+        // per-key ordering is kept while unrelated keys are executed in parallel.
+        uint32 GetSerialShardCount() const { return m_serialShards.size(); }
+        void GetSerialShardStats(std::vector<SqlDelayThreadStats>& stats) const;
+
         // Frees data, cancels scheduled queries, closes connection
         void StopServer();
+
+        // Per statement latency, queue wait and row statistics
+        SqlStatsCollector& GetStatementStats() { return m_statementStats; }
     protected:
         Database() : m_nQueryConnPoolSize(1), m_delayQueue(new SqlQueue()), m_pAsyncConn(nullptr),
                      m_pResultQueue(nullptr), m_numAsyncWorkers(0),
@@ -298,7 +330,7 @@ class Database
                 ~TransHelper();
 
                 //initializes new SqlTransaction object
-                SqlTransaction * init(uint32 serialId);
+                SqlTransaction * init(uint64 serialId);
                 //gets pointer on current transaction object. Returns nullptr if transaction was not initiated
                 SqlTransaction * get() const { return m_pTrans; }
                 //detaches SqlTransaction object allocated by init() function
@@ -346,6 +378,9 @@ class Database
         std::vector<std::shared_ptr<SqlDelayThread>> m_threadsBodies;                  ///< Pointer to delay sql executer (owned by m_delayThread)
         std::vector<std::thread> m_delayThreads;                   ///< Pointer to executer thread
 
+        std::vector<std::shared_ptr<SqlDelayThread>> m_serialShards;   ///< Serial-only executers, indexed by serial id hash
+        std::vector<std::thread> m_serialShardThreads;
+
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
         //PREPARED STATEMENT REGISTRY
@@ -359,6 +394,8 @@ class Database
 
         int m_iStmtIndex;
 
+        SqlStatsCollector m_statementStats;
+
     private:
 
         bool m_logSQL;
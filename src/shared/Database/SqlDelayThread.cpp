@@ -22,9 +22,11 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
 
-SqlDelayThread::SqlDelayThread(const char* InName, Database* db, SqlConnection* conn)
-    : m_dbEngine(db), m_dbConnection(conn), m_running(true), Name(InName)
+SqlDelayThread::SqlDelayThread(const char* InName, Database* db, SqlConnection* conn, bool consumeDelayQueue)
+    : m_dbEngine(db), m_dbConnection(conn), m_running(true), Name(InName), m_consumeDelayQueue(consumeDelayQueue),
+      m_serialQueueDepth(0), m_maxSerialExecTime(0), m_serialExecuted(0)
 {
 }
 
@@ -37,6 +39,8 @@ SqlDelayThread::~SqlDelayThread()
 
 void SqlDelayThread::addSerialOperation(SqlOperation *op)
 {
+    op->SetQueuedTime(WorldTimer::getMSTime());
+    ++m_serialQueueDepth;
     m_serialDelayQueue.add(op);
 }
 
@@ -45,6 +49,23 @@ bool SqlDelayThread::HasAsyncQuery()
     return !m_serialDelayQueue.empty_unsafe();
 }
 
+SqlDelayThreadStats SqlDelayThread::GetStats()
+{
+    SqlDelayThreadStats stats;
+    stats.queueDepth = m_serialQueueDepth;
+    stats.oldestQueuedMs = 0;
+    stats.maxExecMs = m_maxSerialExecTime.exchange(0);
+    stats.executed = m_serialExecuted;
+
+    uint32 now = WorldTimer::getMSTime();
+    m_serialDelayQueue.visit_front([&stats, now](SqlOperation* op)
+    {
+        stats.oldestQueuedMs = WorldTimer::getMSTimeDiff(op->GetQueuedTime(), now);
+    });
+
+    return stats;
+}
+
 void SqlDelayThread::run()
 {
     #ifndef DO_POSTGRESQL
@@ -90,9 +111,11 @@ void SqlDelayThread::Stop()
 void SqlDelayThread::ProcessRequests()
 {
     SqlOperation* s = nullptr;
-    while (m_dbEngine->NextDelayedOperation(s))
+    while (m_consumeDelayQueue && m_dbEngine->NextDelayedOperation(s))
     {
+        SqlStatsCollector::SetQueueWait(WorldTimer::getMSTimeDiffToNow(s->GetQueuedTime()));
         bool result = s->Execute(m_dbConnection);
+        SqlStatsCollector::ClearQueueWait();
         const auto& callback = s->GetCallback();
         if (callback)
             (*callback)(result);
@@ -102,7 +125,17 @@ void SqlDelayThread::ProcessRequests()
     // Process any serial operations for this worker
     while (m_serialDelayQueue.next(s))
     {
+        uint32 startTime = WorldTimer::getMSTime();
+        SqlStatsCollector::SetQueueWait(WorldTimer::getMSTimeDiff(s->GetQueuedTime(), startTime));
         bool result = s->Execute(m_dbConnection);
+        SqlStatsCollector::ClearQueueWait();
+        uint32 execTime = WorldTimer::getMSTimeDiffToNow(startTime);
+
+        --m_serialQueueDepth;
+        ++m_serialExecuted;
+        uint32 prevMax = m_maxSerialExecTime;
+        while (execTime > prevMax && !m_maxSerialExecTime.compare_exchange_weak(prevMax, execTime));
+
         const auto& callback = s->GetCallback();
         if (callback)
             (*callback)(result);
@@ -22,12 +22,22 @@
 #ifndef __SQLDELAYTHREAD_H
 #define __SQLDELAYTHREAD_H
 
+#include "Common.h"
 #include "LockedQueue.h"
+#include <atomic>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+struct SqlDelayThreadStats
+{
+    uint32 queueDepth;                                      ///< Serial operations waiting
+    uint32 oldestQueuedMs;                                  ///< Age of the oldest waiting serial operation
+    uint32 maxExecMs;                                       ///< Slowest serial operation since the last read
+    uint64 executed;                                        ///< Serial operations executed so far
+};
+
 class SqlDelayThread
 {
     typedef LockedQueue<SqlOperation*, std::mutex> SqlQueue;
@@ -39,19 +49,25 @@ class SqlDelayThread
         SqlConnection *m_dbConnection;                     ///< Pointer to DB connection
         volatile bool m_running;
         const char* Name;
+        bool m_consumeDelayQueue;                           ///< False for write shards, which only run their serial queue
+
+        std::atomic<uint32> m_serialQueueDepth;
+        std::atomic<uint32> m_maxSerialExecTime;
+        std::atomic<uint64> m_serialExecuted;
 
 
         //process all enqueued requests
         void ProcessRequests();
 
     public:
-        SqlDelayThread(const char* InName, Database* db, SqlConnection* conn);
+        SqlDelayThread(const char* InName, Database* db, SqlConnection* conn, bool consumeDelayQueue = true);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
         bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
         void addSerialOperation(SqlOperation *op);
         bool HasAsyncQuery();
+        SqlDelayThreadStats GetStats();
 
         virtual void Stop();                                ///< Stop event
         void run();                                 ///< Main Thread loop
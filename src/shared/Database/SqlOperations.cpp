@@ -26,6 +26,8 @@
 #include "Timer.h"
 #include "ThreadPool.h"
 
+#include <condition_variable>
+
 #define LOCK_DB_CONN(conn) SqlConnection::Lock guard(conn)
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
@@ -34,7 +36,7 @@ bool SqlPlainRequest::Execute(SqlConnection *conn)
 {
     /// just do it
     LOCK_DB_CONN(conn);
-    return conn->Execute(m_sql);
+    return conn->ExecuteWithStats(m_sql);
 }
 
 bool SqlMultilineRequest::Execute(SqlConnection* conn)
@@ -100,7 +102,7 @@ bool SqlQuery::Execute(SqlConnection *conn)
 
     LOCK_DB_CONN(conn);
     /// execute the query and store the result in the callback
-    m_callback->SetResult(conn->Query(m_sql));
+    m_callback->SetResult(conn->QueryWithStats(m_sql));
     /// add the callback to the sql result queue of the thread it originated from
     m_queue->add(m_callback);
 
@@ -183,7 +185,7 @@ bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback * callback, Database *databa
 
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
-    SqlQueryHolderEx *holderEx = new SqlQueryHolderEx(this, callback, queue, serialId);
+    SqlQueryHolderEx *holderEx = new SqlQueryHolderEx(this, callback, queue, database, serialId);
 
     database->AddToSerialDelayQueue(holderEx);
     return true;
@@ -294,20 +296,95 @@ void SqlQueryHolder::SetSize(size_t size)
     m_queries.resize(size);
 }
 
+/// Queries of a parallel holder are claimed one at a time by the connection running
+/// the holder and by helper operations queued to the other workers. The holder's own
+/// connection never waits for a helper to be scheduled, it only waits for the queries
+/// already claimed by one to finish.
+class SqlQueryHolderFanout
+{
+    public:
+        explicit SqlQueryHolderFanout(SqlQueryHolder* holder)
+            : m_holder(holder), m_size(holder->m_queries.size()), m_next(0), m_done(0) {}
+
+        void Run(SqlConnection* conn)
+        {
+            for (size_t i = m_next++; i < m_size; i = m_next++)
+            {
+                /// the holder is alive as long as some query is not done
+                if (char const* sql = m_holder->m_queries[i].first)
+                    m_holder->SetResult(i, conn->QueryWithStats(sql));
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (++m_done == m_size)
+                    m_condition.notify_all();
+            }
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_condition.wait(guard, [this] { return m_done == m_size; });
+        }
+
+    private:
+        SqlQueryHolder* m_holder;
+        size_t const m_size;
+        std::atomic<size_t> m_next;
+        size_t m_done;
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+};
+
+namespace
+{
+    class SqlQueryHolderHelper : public SqlOperation
+    {
+        public:
+            explicit SqlQueryHolderHelper(std::shared_ptr<SqlQueryHolderFanout> fanout) : m_fanout(std::move(fanout)) {}
+
+            bool Execute(SqlConnection *conn) override
+            {
+                LOCK_DB_CONN(conn);
+                m_fanout->Run(conn);
+                return true;
+            }
+
+        private:
+            std::shared_ptr<SqlQueryHolderFanout> m_fanout;
+    };
+}
+
 bool SqlQueryHolderEx::Execute(SqlConnection *conn)
 {
     if(!m_holder || !m_callback || !m_queue)
         return false;
 
     LOCK_DB_CONN(conn);
-    /// we can do this, we are friends
-    std::vector<SqlQueryHolder::SqlResultPair> &queries = m_holder->m_queries;
-    for(size_t i = 0; i < queries.size(); i++)
+
+    size_t size = m_holder->GetSize();
+    if (m_holder->IsParallel() && m_db && m_db->GetAsyncWorkerCount() && size > 1)
     {
-        /// execute all queries in the holder and pass the results
-        char const *sql = queries[i].first;
-        if (sql)
-            m_holder->SetResult(i, conn->Query(sql));
+        std::shared_ptr<SqlQueryHolderFanout> fanout = std::make_shared<SqlQueryHolderFanout>(m_holder);
+
+        size_t helpers = std::min<size_t>(m_db->GetAsyncWorkerCount(), size - 1);
+        for (size_t i = 0; i < helpers; ++i)
+            m_db->AddToDelayQueue(new SqlQueryHolderHelper(fanout));
+
+        fanout->Run(conn);
+        /// keep the serial order, nothing else with our serial id may start before the holder is complete
+        fanout->Wait();
+    }
+    else
+    {
+        /// we can do this, we are friends
+        std::vector<SqlQueryHolder::SqlResultPair> &queries = m_holder->m_queries;
+        for(size_t i = 0; i < queries.size(); i++)
+        {
+            /// execute all queries in the holder and pass the results
+            char const *sql = queries[i].first;
+            if (sql)
+                m_holder->SetResult(i, conn->QueryWithStats(sql));
+        }
     }
 
     /// sync with the caller thread
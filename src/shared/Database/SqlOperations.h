@@ -41,9 +41,14 @@ class SqlStmtParameters;
 class SqlOperation
 {
     public:
-        SqlOperation(uint32 id) : serialId(id) {}
-        SqlOperation() : serialId(0) {}
-        uint32 GetSerialId() const { return serialId; }
+        SqlOperation(uint64 id) : serialId(id), queuedTime(0) {}
+        SqlOperation() : serialId(0), queuedTime(0) {}
+        uint64 GetSerialId() const { return serialId; }
+
+        // getMSTime() stamp of the moment the operation entered a delay queue
+        void SetQueuedTime(uint32 msTime) { queuedTime = msTime; }
+        uint32 GetQueuedTime() const { return queuedTime; }
+
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection *conn) = 0;
         virtual ~SqlOperation() {}
@@ -56,7 +61,8 @@ class SqlOperation
         }
 
     protected:
-        uint32 serialId;
+        uint64 serialId;
+        uint32 queuedTime;
         std::unique_ptr<std::function<void(bool)>> callback;
 };
 
@@ -88,7 +94,7 @@ class SqlTransaction : public SqlOperation
         std::vector<SqlOperation * > m_queue;
 
     public:
-        SqlTransaction(uint32 serialId) : SqlOperation(serialId) {}
+        SqlTransaction(uint64 serialId) : SqlOperation(serialId) {}
         ~SqlTransaction();
 
         void DelayExecute(SqlOperation * sql)   {   m_queue.push_back(sql); }
@@ -116,6 +122,7 @@ class QueryResult;                                          /// the result of on
 class SqlResultQueue;                                       /// queue for thread sync
 class SqlQueryHolder;                                       /// groups several async quries
 class SqlQueryHolderEx;                                     /// points to a holder, added to the delay thread
+class SqlQueryHolderFanout;                                 /// spreads a parallel holder over the worker connections
 
 class ThreadPool;
 
@@ -148,14 +155,16 @@ class SqlQuery : public SqlOperation
 class SqlQueryHolder
 {
     friend class SqlQueryHolderEx;
+    friend class SqlQueryHolderFanout;
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
 
-        uint32 serialId;
+        uint64 serialId;
+        bool m_parallel;
     public:
-        SqlQueryHolder(uint32 id) : serialId(id) {}
-        SqlQueryHolder() : serialId(0) {}
+        SqlQueryHolder(uint64 id) : serialId(id), m_parallel(false) {}
+        SqlQueryHolder() : serialId(0), m_parallel(false) {}
         virtual ~SqlQueryHolder();
         bool SetQuery(size_t index, const char *sql);
         bool SetPQuery(size_t index, const char *format, ...) ATTR_PRINTF(3,4);
@@ -165,7 +174,13 @@ class SqlQueryHolder
         void SetResult(size_t index, QueryResult *result);
         bool Execute(MaNGOS::IQueryCallback * callback, Database *db, SqlResultQueue *queue);
         void DeleteAllResults();
-        uint32 GetSerialId() const { return serialId; }
+        uint64 GetSerialId() const { return serialId; }
+
+        // Queries of a parallel holder do not depend on each other and may run on several
+        // worker connections at once. Ordering against other operations with the same
+        // serial id is kept, the holder still completes before the next one starts.
+        void SetParallel(bool parallel) { m_parallel = parallel; }
+        bool IsParallel() const { return m_parallel; }
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -174,9 +189,10 @@ class SqlQueryHolderEx : public SqlOperation
         SqlQueryHolder * m_holder;
         MaNGOS::IQueryCallback * m_callback;
         SqlResultQueue * m_queue;
+        Database * m_db;
     public:
-        SqlQueryHolderEx(SqlQueryHolder *holder, MaNGOS::IQueryCallback * callback, SqlResultQueue * queue, uint32 id)
-            : SqlOperation(id), m_holder(holder), m_callback(callback), m_queue(queue) {}
+        SqlQueryHolderEx(SqlQueryHolder *holder, MaNGOS::IQueryCallback * callback, SqlResultQueue * queue, Database * db, uint64 id)
+            : SqlOperation(id), m_holder(holder), m_callback(callback), m_queue(queue), m_db(db) {}
         bool Execute(SqlConnection *conn);
 };
 #endif                                                      //__SQLOPERATIONS_H
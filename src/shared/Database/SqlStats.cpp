@@ -0,0 +1,323 @@
+#include "DatabaseEnv.h"
+#include "Database/SqlStats.h"
+
+#include <algorithm>
+
+namespace
+{
+    thread_local uint32 t_queueWaitUs = 0;
+    thread_local bool t_queueWaitSet = false;
+
+    // false for synchronous statements and for the statements after the first one of a queued operation
+    inline bool TakeQueueWait(uint32& queueUs)
+    {
+        queueUs = t_queueWaitUs;
+        bool queued = t_queueWaitSet;
+        t_queueWaitUs = 0;
+        t_queueWaitSet = false;
+        return queued;
+    }
+
+    inline bool IsIdentifierChar(char c)
+    {
+        return isalnum(uint8(c)) || c == '_' || c == '$';
+    }
+
+    inline bool EndsWith(std::string const& str, const char* suffix)
+    {
+        size_t len = strlen(suffix);
+        return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+    }
+}
+
+void SqlStatementStats::Reset()
+{
+    count = 0;
+    rows = 0;
+    totalExecUs = 0;
+    totalQueueUs = 0;
+    maxExecUs = 0;
+    exec.Reset();
+    queueWait.Reset();
+}
+
+void SqlStatsCollector::Initialize(bool enabled, uint32 slowQueryMs)
+{
+    m_enabled = enabled;
+    m_slowQueryUs = uint64(slowQueryMs) * 1000;
+    m_rawOverflow = std::make_unique<SqlStatementStats>("<other queries>");
+}
+
+void SqlStatsCollector::SetQueueWait(uint32 ms)
+{
+    t_queueWaitUs = ms * 1000;
+    t_queueWaitSet = true;
+}
+
+void SqlStatsCollector::ClearQueueWait()
+{
+    t_queueWaitUs = 0;
+    t_queueWaitSet = false;
+}
+
+void SqlStatsCollector::Normalize(const char* sql, std::string& out)
+{
+    // long inserts only differ by their values, no need to look at all of them
+    static const size_t maxLength = 512;
+
+    out.clear();
+    for (const char* c = sql; *c && out.size() < maxLength; ++c)
+    {
+        if (*c == '\'' || *c == '"')
+        {
+            char quote = *c;
+            while (*(c + 1) && *(c + 1) != quote)
+            {
+                if (*(c + 1) == '\\' && *(c + 2))
+                    ++c;
+                ++c;
+            }
+            if (*(c + 1))
+                ++c;
+        }
+        else if (isdigit(uint8(*c)) && (out.empty() || !IsIdentifierChar(out.back())))
+        {
+            while (isdigit(uint8(*(c + 1))) || *(c + 1) == '.')
+                ++c;
+        }
+        else
+        {
+            out += *c;
+            continue;
+        }
+
+        out += '?';
+
+        // collapse value lists, IN (1,2,3) and IN (4,5) share one template
+        if (EndsWith(out, "?,?"))
+            out.resize(out.size() - 2);
+        else if (EndsWith(out, "?, ?"))
+            out.resize(out.size() - 3);
+    }
+}
+
+SqlStatementStats* SqlStatsCollector::GetRawStats(const char* sql)
+{
+    if (!m_enabled || !sql)
+        return nullptr;
+
+    thread_local std::string normalized;
+    Normalize(sql, normalized);
+
+    {
+        std::shared_lock<std::shared_mutex> guard(m_lock);
+        auto itr = m_raw.find(normalized);
+        if (itr != m_raw.end())
+            return itr->second.get();
+
+        if (m_raw.size() >= SQL_STATS_MAX_TEMPLATES)
+            return m_rawOverflow.get();
+    }
+
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    auto& stats = m_raw[normalized];
+    if (!stats)
+        stats = std::make_unique<SqlStatementStats>(normalized);
+
+    return stats.get();
+}
+
+SqlStatementStats* SqlStatsCollector::GetPreparedStats(int stmtId, Database& db)
+{
+    if (!m_enabled || stmtId < 0)
+        return nullptr;
+
+    {
+        std::shared_lock<std::shared_mutex> guard(m_lock);
+        if (size_t(stmtId) < m_prepared.size() && m_prepared[stmtId])
+            return m_prepared[stmtId].get();
+    }
+
+    std::string fmt = db.GetStmtString(stmtId);
+
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    if (m_prepared.size() <= size_t(stmtId))
+        m_prepared.resize(stmtId + 1);
+
+    if (!m_prepared[stmtId])
+        m_prepared[stmtId] = std::make_unique<SqlStatementStats>(fmt);
+
+    return m_prepared[stmtId].get();
+}
+
+uint32 SqlStatsCollector::Account(SqlStatementStats* stats, uint64 execUs, uint64 rows)
+{
+    uint32 queueUs;
+    bool queued = TakeQueueWait(queueUs);
+
+    stats->count.fetch_add(1, std::memory_order_relaxed);
+    stats->rows.fetch_add(rows, std::memory_order_relaxed);
+    stats->totalExecUs.fetch_add(execUs, std::memory_order_relaxed);
+    stats->exec.Add(execUs);
+
+    uint32 prevMax = stats->maxExecUs.load(std::memory_order_relaxed);
+    while (execUs > prevMax && !stats->maxExecUs.compare_exchange_weak(prevMax, uint32(execUs), std::memory_order_relaxed));
+
+    // zero waits included, the percentiles are over every queued execution
+    if (queued)
+    {
+        stats->totalQueueUs.fetch_add(queueUs, std::memory_order_relaxed);
+        stats->queueWait.Add(queueUs);
+    }
+
+    return queueUs;
+}
+
+void SqlStatsCollector::Record(SqlStatementStats* stats, uint64 execUs, uint64 rows, const char* sql)
+{
+    if (!stats)
+        return;
+
+    uint32 queueUs = Account(stats, execUs, rows);
+
+    if (IsSlow(execUs))
+        AddSlowSample(execUs, queueUs, std::string(sql));
+}
+
+void SqlStatsCollector::Record(SqlStatementStats* stats, uint64 execUs, uint64 rows, SqlStmtParameters const& params)
+{
+    if (!stats)
+        return;
+
+    uint32 queueUs = Account(stats, execUs, rows);
+
+    if (!IsSlow(execUs))
+        return;
+
+    std::ostringstream ss;
+    ss << stats->query << " -- [";
+    for (size_t i = 0; i < params.params().size(); ++i)
+    {
+        SqlStmtFieldData const& data = params.params()[i];
+        if (i)
+            ss << ", ";
+
+        switch (data.type())
+        {
+            case FIELD_BOOL:    ss << data.toBool(); break;
+            case FIELD_UI8:     ss << uint32(data.toUint8()); break;
+            case FIELD_UI16:    ss << data.toUint16(); break;
+            case FIELD_UI32:    ss << data.toUint32(); break;
+            case FIELD_UI64:    ss << data.toUint64(); break;
+            case FIELD_I8:      ss << int32(data.toInt8()); break;
+            case FIELD_I16:     ss << data.toInt16(); break;
+            case FIELD_I32:     ss << data.toInt32(); break;
+            case FIELD_I64:     ss << data.toInt64(); break;
+            case FIELD_FLOAT:   ss << data.toFloat(); break;
+            case FIELD_DOUBLE:  ss << data.toDouble(); break;
+            case FIELD_STRING:  ss << '\'' << data.toStr() << '\''; break;
+            case FIELD_NONE:    ss << "NULL"; break;
+        }
+    }
+    ss << "]";
+
+    AddSlowSample(execUs, queueUs, ss.str());
+}
+
+void SqlStatsCollector::AddSlowSample(uint64 execUs, uint32 queueUs, std::string&& sql)
+{
+    SqlSlowQuerySample sample;
+    sample.time = time(nullptr);
+    sample.execUs = uint32(std::min<uint64>(execUs, 0xFFFFFFFF));
+    sample.queueUs = queueUs;
+    sample.sql = std::move(sql);
+
+    std::lock_guard<std::mutex> guard(m_slowLock);
+    if (m_slowSamples.size() < SQL_STATS_SLOW_SAMPLES)
+        m_slowSamples.push_back(std::move(sample));
+    else
+        m_slowSamples[m_slowSampleIndex] = std::move(sample);
+
+    m_slowSampleIndex = (m_slowSampleIndex + 1) % SQL_STATS_SLOW_SAMPLES;
+}
+
+void SqlStatsCollector::GetReport(std::vector<SqlStatementReport>& report, SqlStatsSortBy sortBy, size_t limit) const
+{
+    report.clear();
+
+    auto addEntry = [&report](SqlStatementStats const* stats)
+    {
+        if (!stats || !stats->count)
+            return;
+
+        SqlStatementReport entry;
+        entry.query = stats->query;
+        entry.count = stats->count;
+        entry.rows = stats->rows;
+        entry.totalExecUs = stats->totalExecUs;
+        entry.totalQueueUs = stats->totalQueueUs;
+        entry.maxExecUs = stats->maxExecUs;
+        entry.p50ExecUs = stats->exec.Percentile(50.0f);
+        entry.p99ExecUs = stats->exec.Percentile(99.0f);
+        entry.p99QueueUs = stats->queueWait.Percentile(99.0f);
+        report.push_back(std::move(entry));
+    };
+
+    {
+        std::shared_lock<std::shared_mutex> guard(m_lock);
+        for (const auto& itr : m_raw)
+            addEntry(itr.second.get());
+        for (const auto& stats : m_prepared)
+            addEntry(stats.get());
+        addEntry(m_rawOverflow.get());
+    }
+
+    auto key = [sortBy](SqlStatementReport const& entry) -> uint64
+    {
+        switch (sortBy)
+        {
+            case SQL_STATS_SORT_COUNT:      return entry.count;
+            case SQL_STATS_SORT_MAX_TIME:   return entry.maxExecUs;
+            case SQL_STATS_SORT_QUEUE_WAIT: return entry.totalQueueUs;
+            default:                        return entry.totalExecUs;
+        }
+    };
+
+    std::sort(report.begin(), report.end(), [&key](SqlStatementReport const& a, SqlStatementReport const& b)
+    {
+        return key(a) > key(b);
+    });
+
+    if (limit && report.size() > limit)
+        report.resize(limit);
+}
+
+void SqlStatsCollector::GetSlowSamples(std::vector<SqlSlowQuerySample>& samples) const
+{
+    std::lock_guard<std::mutex> guard(m_slowLock);
+
+    // oldest first
+    samples.clear();
+    samples.reserve(m_slowSamples.size());
+    size_t start = m_slowSamples.size() < SQL_STATS_SLOW_SAMPLES ? 0 : m_slowSampleIndex;
+    for (size_t i = 0; i < m_slowSamples.size(); ++i)
+        samples.push_back(m_slowSamples[(start + i) % m_slowSamples.size()]);
+}
+
+void SqlStatsCollector::Reset()
+{
+    {
+        std::shared_lock<std::shared_mutex> guard(m_lock);
+        for (const auto& itr : m_raw)
+            itr.second->Reset();
+        for (const auto& stats : m_prepared)
+            if (stats)
+                stats->Reset();
+        if (m_rawOverflow)
+            m_rawOverflow->Reset();
+    }
+
+    std::lock_guard<std::mutex> guard(m_slowLock);
+    m_slowSamples.clear();
+    m_slowSampleIndex = 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Common.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+class Database;
+class SqlStmtParameters;
+
+// Distinct raw query templates tracked per database, the rest are accounted together
+#define SQL_STATS_MAX_TEMPLATES     2048
+#define SQL_STATS_SLOW_SAMPLES      64
+
+struct SqlStatementStats
+{
+    explicit SqlStatementStats(std::string const& q) : query(q) { Reset(); }
+
+    void Reset();
+
+    std::string const query;                                // prepared statement or normalized raw query
+    std::atomic<uint64> count;
+    std::atomic<uint64> rows;                               // rows returned, selects only
+    std::atomic<uint64> totalExecUs;
+    std::atomic<uint64> totalQueueUs;
+    std::atomic<uint32> maxExecUs;
+    LatencyHistogram exec;
+    LatencyHistogram queueWait;                             // enqueue to dequeue in SqlDelayThread, async only
+};
+
+struct SqlSlowQuerySample
+{
+    time_t time;
+    uint32 execUs;
+    uint32 queueUs;
+    std::string sql;                                        // with the actual values / bound parameters
+};
+
+struct SqlStatementReport
+{
+    std::string query;
+    uint64 count;
+    uint64 rows;
+    uint64 totalExecUs;
+    uint64 totalQueueUs;
+    uint32 maxExecUs;
+    uint64 p50ExecUs;
+    uint64 p99ExecUs;
+    uint64 p99QueueUs;
+};
+
+enum SqlStatsSortBy
+{
+    SQL_STATS_SORT_TOTAL_TIME,
+    SQL_STATS_SORT_COUNT,
+    SQL_STATS_SORT_MAX_TIME,
+    SQL_STATS_SORT_QUEUE_WAIT,
+};
+
+/// Per database statement instrumentation.
+/// Raw queries are normalized (literals replaced by '?') so that every query built
+/// from the same format shares an entry. Entries are looked up under a shared lock
+/// and never freed, counters are updated with relaxed atomics.
+class SqlStatsCollector
+{
+    public:
+        SqlStatsCollector() : m_enabled(false), m_slowQueryUs(0), m_slowSampleIndex(0) {}
+
+        void Initialize(bool enabled, uint32 slowQueryMs);
+        bool IsEnabled() const { return m_enabled; }
+
+        SqlStatementStats* GetRawStats(const char* sql);
+        SqlStatementStats* GetPreparedStats(int stmtId, Database& db);
+
+        // queue wait of the operation about to be executed by this thread, consumed by the next Record
+        static void SetQueueWait(uint32 ms);
+        static void ClearQueueWait();
+
+        void Record(SqlStatementStats* stats, uint64 execUs, uint64 rows, const char* sql);
+        void Record(SqlStatementStats* stats, uint64 execUs, uint64 rows, SqlStmtParameters const& params);
+
+        void GetReport(std::vector<SqlStatementReport>& report, SqlStatsSortBy sortBy, size_t limit) const;
+        void GetSlowSamples(std::vector<SqlSlowQuerySample>& samples) const;
+        void Reset();
+
+        static void Normalize(const char* sql, std::string& out);
+
+    private:
+        bool IsSlow(uint64 execUs) const { return m_slowQueryUs && execUs >= m_slowQueryUs; }
+        void AddSlowSample(uint64 execUs, uint32 queueUs, std::string&& sql);
+        uint32 Account(SqlStatementStats* stats, uint64 execUs, uint64 rows);
+
+        bool m_enabled;
+        uint64 m_slowQueryUs;
+
+        mutable std::shared_mutex m_lock;
+        std::unordered_map<std::string, std::unique_ptr<SqlStatementStats>> m_raw;
+        std::unique_ptr<SqlStatementStats> m_rawOverflow;
+
+        // indexed by prepared statement id
+        std::vector<std::unique_ptr<SqlStatementStats>> m_prepared;
+
+        mutable std::mutex m_slowLock;
+        std::vector<SqlSlowQuerySample> m_slowSamples;
+        size_t m_slowSampleIndex;
+};
@@ -0,0 +1,46 @@
+#include "LatencyHistogram.h"
+
+void LatencyHistogram::Add(uint64 us)
+{
+    uint32 bucket = 0;
+    while (us > 1 && bucket < LATENCY_HISTOGRAM_BUCKETS - 1)
+    {
+        us >>= 1;
+        ++bucket;
+    }
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64 LatencyHistogram::Count() const
+{
+    uint64 total = 0;
+    for (const auto& bucket : buckets)
+        total += bucket.load(std::memory_order_relaxed);
+
+    return total;
+}
+
+uint64 LatencyHistogram::Percentile(float pct) const
+{
+    uint64 total = Count();
+    if (!total)
+        return 0;
+
+    uint64 wanted = uint64(total * pct / 100.0f + 0.5f);
+    uint64 seen = 0;
+    for (uint32 i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= wanted)
+            return uint64(1) << (i + 1);
+    }
+
+    return uint64(1) << LATENCY_HISTOGRAM_BUCKETS;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
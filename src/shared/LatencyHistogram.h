@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+#include <chrono>
+
+// Bucket i counts samples in [2^i, 2^(i+1)) microseconds, the last one is open ended
+#define LATENCY_HISTOGRAM_BUCKETS   24
+
+/// Lock free latency histogram, counters are updated with relaxed atomics.
+struct LatencyHistogram
+{
+    LatencyHistogram() { Reset(); }
+
+    void Add(uint64 us);
+    uint64 Count() const;
+    // upper bound of the bucket holding the given percentile (0-100)
+    uint64 Percentile(float pct) const;
+    void Reset();
+
+    std::atomic<uint32> buckets[LATENCY_HISTOGRAM_BUCKETS];
+};
+
+// Times an operation, Stop() returns the elapsed microseconds
+class LatencyTimer
+{
+    public:
+        LatencyTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+        uint64 Stop() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+};
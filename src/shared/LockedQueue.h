@@ -89,6 +89,19 @@ template <class T, class LockType, typename StorageType=std::deque<T> >
             return true;
         }
 
+        //! Calls visitor on the front item with the lock held, if any.
+        template<class Visitor>
+        bool visit_front(Visitor&& visitor)
+        {
+            std::unique_lock<LockType> g(this->_lock);
+
+            if (_queue.empty())
+                return false;
+
+            visitor(_queue.front());
+            return true;
+        }
+
         //! Peeks at the top of the queue. Remember to unlock after use.
         T& peek()
         {
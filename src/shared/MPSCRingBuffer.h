@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/// Bounded lock-free queue for many producers and a single consumer.
+/// Each slot carries a sequence number telling whether it is free for the producer
+/// of a given position or holds a value for the consumer (Vyukov's bounded queue).
+/// Push fails instead of blocking when the ring is full.
+template <class T>
+class MPSCRingBuffer
+{
+    public:
+        // capacity is rounded up to a power of two
+        explicit MPSCRingBuffer(size_t capacity) : m_enqueuePos(0), m_dequeuePos(0)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+
+            m_mask = size - 1;
+            m_slots.reset(new Slot[size]);
+            for (size_t i = 0; i < size; ++i)
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MPSCRingBuffer(MPSCRingBuffer const&) = delete;
+        MPSCRingBuffer& operator=(MPSCRingBuffer const&) = delete;
+
+        bool Push(T&& value)
+        {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            Slot* slot;
+            for (;;)
+            {
+                slot = &m_slots[pos & m_mask];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;                           // full
+                else
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+
+            slot->value = std::move(value);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer thread only
+        bool Pop(T& value)
+        {
+            Slot& slot = m_slots[m_dequeuePos & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+                return false;
+
+            value = std::move(slot.value);
+            slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+            ++m_dequeuePos;
+            return true;
+        }
+
+        // approximate when called concurrently with Push
+        size_t Size() const
+        {
+            size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+            size_t dequeued = m_dequeuePosShared.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        size_t Capacity() const { return m_mask + 1; }
+
+        // publishes the consumer position for Size(), call after a batch of Pop
+        void UpdateSize() { m_dequeuePosShared.store(m_dequeuePos, std::memory_order_relaxed); }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask;
+        alignas(64) std::atomic<size_t> m_enqueuePos;
+        alignas(64) size_t m_dequeuePos;
+        std::atomic<size_t> m_dequeuePosShared{0};
+};